@@ -134,37 +134,37 @@ namespace boost
                 template<typename ExprDesc, typename Domain>
                     inline constexpr auto value(basic_expr<ExprDesc, Domain> &that)
                 BOOST_PROTO_AUTO_RETURN(
-                    (access::proto_args(that).proto_child0) // extra parens are significant!
+                    exprs::get<0>(access::proto_args(that))
                 )
 
                 template<typename ExprDesc, typename Domain>
                     inline constexpr auto value(basic_expr<ExprDesc, Domain> const &that)
                 BOOST_PROTO_AUTO_RETURN(
-                    (access::proto_args(that).proto_child0) // extra parens are significant!
+                    exprs::get<0>(access::proto_args(that))
                 )
 
                 template<typename ExprDesc, typename Domain>
                     inline constexpr auto value(basic_expr<ExprDesc, Domain> &&that)
                 BOOST_PROTO_AUTO_RETURN(
-                    (access::proto_args(static_cast<basic_expr<ExprDesc, Domain> &&>(that)).proto_child0) // extra parens are significant!
+                    exprs::get<0>(access::proto_args(static_cast<basic_expr<ExprDesc, Domain> &&>(that)))
                 )
 
                 ////////////////////////////////////////////////////////////////////////////////////
                 // tag_of
                 template<typename Tag, typename ...Children, typename Domain>
-                inline constexpr Tag &tag_of(basic_expr<Tag(Children...), Domain> &that) noexcept
+                inline constexpr detail::tag_ref_<Tag, Tag &> tag_of(basic_expr<Tag(Children...), Domain> &that) noexcept
                 {
                     return access::proto_tag(that);
                 }
 
                 template<typename Tag, typename ...Children, typename Domain>
-                inline constexpr Tag const &tag_of(basic_expr<Tag(Children...), Domain> const &that) noexcept
+                inline constexpr detail::tag_ref_<Tag, Tag const &> tag_of(basic_expr<Tag(Children...), Domain> const &that) noexcept
                 {
                     return access::proto_tag(that);
                 }
 
                 template<typename Tag, typename ...Children, typename Domain>
-                inline constexpr Tag &&tag_of(basic_expr<Tag(Children...), Domain> &&that) noexcept
+                inline constexpr detail::tag_ref_<Tag, Tag &&> tag_of(basic_expr<Tag(Children...), Domain> &&that) noexcept
                 {
                     return access::proto_tag(static_cast<basic_expr<Tag(Children...), Domain> &&>(that));
                 }
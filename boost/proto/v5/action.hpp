@@ -11,6 +11,7 @@
 
 #include <boost/proto/v5/action/basic_action.hpp>
 #include <boost/proto/v5/action/and.hpp>
+#include <boost/proto/v5/action/any_action.hpp>
 #include <boost/proto/v5/action/block.hpp>
 #include <boost/proto/v5/action/apply.hpp>
 #include <boost/proto/v5/action/call.hpp>
@@ -33,6 +34,7 @@
 #include <boost/proto/v5/action/placeholders.hpp>
 #include <boost/proto/v5/action/protect.hpp>
 #include <boost/proto/v5/action/recursive_fold.hpp>
+#include <boost/proto/v5/action/stats.hpp>
 #include <boost/proto/v5/action/string.hpp>
 #include <boost/proto/v5/action/switch.hpp>
 #include <boost/proto/v5/action/unpack.hpp>
@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// any_action.hpp
+// A type-erased action, for choosing among actions at runtime. An any_action holds a copy of an
+// action in a small buffer of its own, never on the heap, and calling it costs one indirect call.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_ACTION_ANY_ACTION_HPP_INCLUDED
+#define BOOST_PROTO_V5_ACTION_ANY_ACTION_HPP_INCLUDED
+
+#include <new>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/action/basic_action.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_action_vtable_
+                // How to call, copy and destroy the action held by an any_action. destroy is null
+                // for actions that are trivially destructible.
+                template<typename Signature>
+                struct any_action_vtable_;
+
+                template<typename Result, typename ...Args>
+                struct any_action_vtable_<Result(Args...)>
+                {
+                    Result (*call)(void const *, Args &&...);
+                    void (*copy)(void const *, void *);
+                    void (*destroy)(void *);
+                };
+
+                template<typename Action, typename Signature>
+                struct any_action_of_;
+
+                template<typename Action, typename Result, typename ...Args>
+                struct any_action_of_<Action, Result(Args...)>
+                {
+                    static Result call(void const *p, Args &&... args)
+                    {
+                        return (*static_cast<Action const *>(p))(static_cast<Args &&>(args)...);
+                    }
+
+                    static void copy(void const *from, void *to)
+                    {
+                        ::new(to) Action(*static_cast<Action const *>(from));
+                    }
+
+                    static void destroy(void *p)
+                    {
+                        static_cast<Action *>(p)->~Action();
+                    }
+
+                    static any_action_vtable_<Result(Args...)> const value;
+                };
+
+                template<typename Action, typename Result, typename ...Args>
+                any_action_vtable_<Result(Args...)> const any_action_of_<Action, Result(Args...)>::value =
+                {
+                    &any_action_of_<Action, Result(Args...)>::call
+                  , &any_action_of_<Action, Result(Args...)>::copy
+                  , std::is_trivially_destructible<Action>::value
+                        ? nullptr
+                        : &any_action_of_<Action, Result(Args...)>::destroy
+                };
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // any_action
+            // Holds any action, such as a basic_action or a def<>, that can be called with
+            // arguments of types Args... and returns something convertible to Result, usually
+            // as any_action<Result(Expr, Env)>. Actions bigger than BufferSize are rejected at
+            // compile time rather than allocated. Calling an empty any_action throws
+            // std::bad_function_call.
+            //
+            // An any_action is an object, so a grammar selects it at runtime through its
+            // environment: map a rule to the any_action there and handle the rule with
+            // case_(Rule, external). Map it by reference to avoid copying it on every call.
+            template<typename Signature, std::size_t BufferSize = 2 * sizeof(void *)>
+            struct any_action;
+
+            template<typename Result, typename ...Args, std::size_t BufferSize>
+            struct any_action<Result(Args...), BufferSize>
+              : basic_action<any_action<Result(Args...), BufferSize>>
+            {
+                using result_type = Result;
+
+                any_action() noexcept
+                  : vtable_(nullptr)
+                  , buffer_()
+                {}
+
+                template<typename Action
+                  , BOOST_PROTO_ENABLE_IF(!(utility::is_base_of<any_action, Action>::value))>
+                any_action(Action && action)
+                  : vtable_(&detail::any_action_of_<utility::uncvref<Action>, Result(Args...)>::value)
+                  , buffer_()
+                {
+                    using action_type = utility::uncvref<Action>;
+                    static_assert(
+                        sizeof(action_type) <= BufferSize && alignof(action_type) <= alignof(buffer_type_)
+                      , "This action doesn't fit in the buffer of any_action. Give the any_action "
+                        "a larger BufferSize."
+                    );
+                    ::new(static_cast<void *>(&buffer_)) action_type(static_cast<Action &&>(action));
+                }
+
+                any_action(any_action const &that)
+                  : vtable_(nullptr)
+                  , buffer_()
+                {
+                    this->assign_(that);
+                }
+
+                any_action &operator=(any_action const &that)
+                {
+                    if(this != &that)
+                    {
+                        this->reset();
+                        this->assign_(that);
+                    }
+                    return *this;
+                }
+
+                ~any_action()
+                {
+                    this->reset();
+                }
+
+                explicit operator bool() const noexcept
+                {
+                    return nullptr != vtable_;
+                }
+
+                void reset() noexcept
+                {
+                    if(vtable_ && vtable_->destroy)
+                        vtable_->destroy(&buffer_);
+                    vtable_ = nullptr;
+                }
+
+                Result operator()(Args... args) const
+                {
+                    if(!vtable_)
+                        throw std::bad_function_call();
+                    return vtable_->call(&buffer_, static_cast<Args &&>(args)...);
+                }
+
+            private:
+                using buffer_type_ = typename std::aligned_storage<BufferSize, alignof(void *)>::type;
+
+                void assign_(any_action const &that)
+                {
+                    if(that.vtable_)
+                    {
+                        that.vtable_->copy(&that.buffer_, &buffer_);
+                        vtable_ = that.vtable_;
+                    }
+                }
+
+                detail::any_action_vtable_<Result(Args...)> const *vtable_;
+                // Value-initialized, because the actions held here are often empty classes that
+                // don't write to it, and copying them would otherwise read uninitialized memory.
+                buffer_type_ buffer_;
+            };
+        }
+    }
+}
+
+#endif
@@ -27,6 +27,7 @@ namespace boost
                 using return_ = utility::identity;
 
                 ////////////////////////////////////////////////////////////////////////////////////
+            #ifndef BOOST_PROTO_SHALLOW_CALL_STACKS
                 template<typename Action>
                 struct call_action_
                 {
@@ -36,6 +37,14 @@ namespace boost
                         BOOST_PROTO_TRY_CALL(as_action_<A>())(static_cast<Args &&>(args)...)
                     )
                 };
+            #else
+                // Inherit the action's function call operators so that calling an action
+                // doesn't cost an extra stack frame.
+                template<typename Action>
+                struct call_action_
+                  : as_action_<Action>
+                {};
+            #endif
 
                 ////////////////////////////////////////////////////////////////////////////////////
                 struct not_an_action
@@ -16,12 +16,14 @@
 #include <boost/proto/v5/proto_fwd.hpp>
 #include <boost/proto/v5/children.hpp>
 #include <boost/proto/v5/matches.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
 #include <boost/proto/v5/utility.hpp>
 #include <boost/proto/v5/action/basic_action.hpp>
 #include <boost/proto/v5/action/case.hpp>
 #include <boost/proto/v5/grammar/switch.hpp>
 #include <boost/proto/v5/grammar/case.hpp>
 #include <boost/proto/v5/grammar/not.hpp>
+#include <boost/proto/v5/grammar/or.hpp>
 
 namespace boost
 {
@@ -81,6 +83,80 @@ namespace boost
                   : def<case_(terminal(_), _value)>
                 {};
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // nary_eval_
+                // Evaluates a runtime-arity expression as a left fold of its binary operator over
+                // its children, so plus(a, b, c) is (a + b) + c. An expression with no children
+                // evaluates to a value-initialized result.
+                template<typename Tag>
+                struct nary_eval_done_
+                {
+                    template<typename T>
+                    static constexpr bool call(T const &) noexcept
+                    {
+                        return false;
+                    }
+                };
+
+                // Must respect short-circuit evaluation
+                template<>
+                struct nary_eval_done_<logical_and>
+                {
+                    template<typename T>
+                    static constexpr bool call(T const &t) noexcept
+                    {
+                        return !t;
+                    }
+                };
+
+                // Must respect short-circuit evaluation
+                template<>
+                struct nary_eval_done_<logical_or>
+                {
+                    template<typename T>
+                    static constexpr bool call(T const &t) noexcept
+                    {
+                        return static_cast<bool>(t);
+                    }
+                };
+
+                template<typename Tag>
+                struct nary_eval_
+                {
+                    template<typename Fun, typename Expr, typename ...Rest
+                      , typename Value = decltype(
+                            std::declval<Fun const &>()(
+                                proto::v5::child(std::declval<Expr>(), 0)
+                              , std::declval<Rest>()...
+                            )
+                        )
+                      , typename Result = utility::uncvref<
+                            decltype(typename _op<Tag>::type()(std::declval<Value>(), std::declval<Value>()))
+                        >
+                    >
+                    static Result call(Fun const &fun, Expr && expr, Rest &&... rest)
+                    {
+                        std::size_t const size = proto::v5::children_of(expr).size();
+                        if(0 == size)
+                            return Result();
+                        Result result = fun(
+                            proto::v5::child(static_cast<Expr &&>(expr), 0)
+                          , static_cast<Rest &&>(rest)...
+                        );
+                        for(std::size_t i = 1; i != size && !nary_eval_done_<Tag>::call(result); ++i)
+                        {
+                            result = typename _op<Tag>::type()(
+                                static_cast<Result &&>(result)
+                              , fun(
+                                    proto::v5::child(static_cast<Expr &&>(expr), i)
+                                  , static_cast<Rest &&>(rest)...
+                                )
+                            );
+                        }
+                        return result;
+                    }
+                };
+
                 template<typename Tag, typename Action>
                 struct _op_unpack
                   : basic_action<_op_unpack<Tag, Action>>
@@ -96,7 +172,7 @@ namespace boost
                         )
                     )
 
-                    template<typename Expr, typename ...Rest>
+                    template<typename Expr, typename ...Rest, BOOST_PROTO_ENABLE_IF(!is_nary<Expr>::value)>
                     constexpr auto operator()(Expr && expr, Rest &&... rest) const
                     BOOST_PROTO_AUTO_RETURN(
                         this->impl(
@@ -105,6 +181,16 @@ namespace boost
                           , static_cast<Rest &&>(rest)...
                         )
                     )
+
+                    template<typename Expr, typename ...Rest, BOOST_PROTO_ENABLE_IF(is_nary<Expr>::value)>
+                    auto operator()(Expr && expr, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        nary_eval_<Tag>::call(
+                            call_action_<Action>()
+                          , static_cast<Expr &&>(expr)
+                          , static_cast<Rest &&>(rest)...
+                        )
+                    )
                 };
 
                 template<typename ActiveGrammar>
@@ -128,6 +214,16 @@ namespace boost
                           , static_cast<Rest &&>(rest)...
                         )
                     )
+
+                    template<typename Expr, typename ...Rest, BOOST_PROTO_ENABLE_IF(is_nary<Expr>::value)>
+                    auto operator()(Expr && expr, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        nary_eval_<typename result_of::tag_of<Expr>::type>::call(
+                            call_action_<ActiveGrammar>()
+                          , static_cast<Expr &&>(expr)
+                          , static_cast<Rest &&>(rest)...
+                        )
+                    )
                 };
 
                 // Must respect short-circuit evaluation
@@ -146,6 +242,16 @@ namespace boost
                           , static_cast<Rest &&>(rest)...
                         )
                     )
+
+                    template<typename Expr, typename ...Rest, BOOST_PROTO_ENABLE_IF(is_nary<Expr>::value)>
+                    auto operator()(Expr && expr, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        nary_eval_<typename result_of::tag_of<Expr>::type>::call(
+                            call_action_<ActiveGrammar>()
+                          , static_cast<Expr &&>(expr)
+                          , static_cast<Rest &&>(rest)...
+                        )
+                    )
                 };
 
                 // Must respect short-circuit evaluation
@@ -192,7 +298,13 @@ namespace boost
                                                                                                     \
                 template<typename ActiveGrammar>                                                    \
                 struct _eval_case<ActiveGrammar, TAG>                                               \
-                  : def<case_(TAG(ActiveGrammar, ActiveGrammar), _op_unpack<TAG, ActiveGrammar>)>   \
+                  : def<case_(                                                                      \
+                        proto::v5::or_(                                                             \
+                            matches_(TAG(ActiveGrammar, ActiveGrammar))                             \
+                          , matches_(TAG(ActiveGrammar...))                                         \
+                        )                                                                           \
+                      , _op_unpack<TAG, ActiveGrammar>                                              \
+                    )>                                                                              \
                 {};                                                                                 \
                 /**/
 
@@ -268,6 +380,133 @@ namespace boost
                   : def<case_(function(ActiveGrammar...), _op_unpack<function, ActiveGrammar>)>
                 {};
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // _shallow_eval_
+                // Evaluates an expression according to the rules of C++ by calling itself directly
+                // on the children, bypassing switch_, case_ and _op_unpack. In unoptimized builds,
+                // each unary or binary node costs a single stack frame.
+                struct _shallow_eval_
+                {
+                    template<typename Tag>
+                    using op_ = typename _op<Tag>::type;
+
+                    template<typename Expr, typename ...Rest
+                      , BOOST_PROTO_ENABLE_IF(!is_nary<Expr>::value)
+                      , BOOST_PROTO_ENABLE_IF(result_of::arity_of<Expr>::value == 0)>
+                    constexpr auto operator()(Expr && e, Rest &&...) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        proto::v5::value(static_cast<Expr &&>(e))
+                    )
+
+                    template<typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_
+                      , typename Tag = typename result_of::tag_of<Expr>::type
+                      , BOOST_PROTO_ENABLE_IF(!is_nary<Expr>::value)
+                      , BOOST_PROTO_ENABLE_IF(result_of::arity_of<Expr>::value == 1)>
+                    constexpr auto operator()(Expr && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        op_<Tag>()(
+                            Impl()(proto::v5::child<0>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                        )
+                    )
+
+                    template<typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_
+                      , typename Tag = typename result_of::tag_of<Expr>::type
+                      , BOOST_PROTO_ENABLE_IF(!is_nary<Expr>::value)
+                      , BOOST_PROTO_ENABLE_IF(result_of::arity_of<Expr>::value == 2)
+                      , BOOST_PROTO_ENABLE_IF(
+                            !std::is_same<Tag, logical_and>::value &&
+                            !std::is_same<Tag, logical_or>::value
+                        )>
+                    constexpr auto operator()(Expr && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        op_<Tag>()(
+                            Impl()(proto::v5::child<0>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                          , Impl()(proto::v5::child<1>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                        )
+                    )
+
+                    // Must respect short-circuit evaluation
+                    template<typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_
+                      , BOOST_PROTO_ENABLE_IF(
+                            std::is_same<typename result_of::tag_of<Expr>::type, logical_and>::value
+                        )>
+                    constexpr auto operator()(Expr && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        Impl()(proto::v5::child<0>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                     && Impl()(proto::v5::child<1>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                    )
+
+                    // Must respect short-circuit evaluation
+                    template<typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_
+                      , BOOST_PROTO_ENABLE_IF(
+                            std::is_same<typename result_of::tag_of<Expr>::type, logical_or>::value
+                        )>
+                    constexpr auto operator()(Expr && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        Impl()(proto::v5::child<0>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                     || Impl()(proto::v5::child<1>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                    )
+
+                    // Must respect short-circuit evaluation
+                    template<typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_
+                      , BOOST_PROTO_ENABLE_IF(
+                            std::is_same<typename result_of::tag_of<Expr>::type, if_else_>::value
+                        )>
+                    constexpr auto operator()(Expr && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        Impl()(proto::v5::child<0>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                      ? Impl()(proto::v5::child<1>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                      : Impl()(proto::v5::child<2>(static_cast<Expr &&>(e)), static_cast<Rest &&>(rest)...)
+                    )
+
+                    // Runtime-arity expressions
+                    template<typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_
+                      , BOOST_PROTO_ENABLE_IF(is_nary<Expr>::value)>
+                    auto operator()(Expr && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        nary_eval_<typename result_of::tag_of<Expr>::type>::call(
+                            Impl()
+                          , static_cast<Expr &&>(e)
+                          , static_cast<Rest &&>(rest)...
+                        )
+                    )
+
+                    // Function calls with two or more arguments
+                    template<typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_
+                      , BOOST_PROTO_ENABLE_IF(!is_nary<Expr>::value)
+                      , BOOST_PROTO_ENABLE_IF(
+                            result_of::arity_of<Expr>::value > 2 &&
+                            !std::is_same<typename result_of::tag_of<Expr>::type, if_else_>::value
+                        )>
+                    constexpr auto operator()(Expr && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        Impl::impl(
+                            utility::make_indices<result_of::arity_of<Expr>::value>()
+                          , static_cast<Expr &&>(e)
+                          , static_cast<Rest &&>(rest)...
+                        )
+                    )
+
+                    template<std::size_t ...I, typename Expr, typename ...Rest
+                      , typename Impl = _shallow_eval_>
+                    static constexpr auto impl(utility::indices<I...>, Expr && e, Rest &&... rest)
+                    BOOST_PROTO_AUTO_RETURN(
+                        op_<typename result_of::tag_of<Expr>::type>()(
+                            Impl()(
+                                proto::v5::child<I>(static_cast<Expr &&>(e))
+                              , static_cast<Rest &&>(rest)...
+                            )...
+                        )
+                    )
+                };
+
                 ////////////////////////////////////////////////////////////////////////////////////
                 // _eval_cases
                 template<typename ActiveGrammar>
@@ -297,6 +536,15 @@ namespace boost
               : detail::_eval_<>
             {};
 
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // _shallow_eval
+            // Evaluates an expression as _eval does, but by direct recursion rather than through
+            // _eval's switch_ of cases, so that in unoptimized builds each unary or binary node
+            // costs a single stack frame.
+            struct _shallow_eval
+              : detail::_shallow_eval_
+            {};
+
             ////////////////////////////////////////////////////////////////////////////////////////
             // eval_with
             struct eval_with
@@ -1,6 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // external.hpp
-// Contains definition of external actions.
+// Contains definition of external actions, and of action tables that map rules to actions
+// at compile time.
 //
 //  Copyright 2012 Eric Niebler. Distributed under the Boost
 //  Software License, Version 1.0. (See accompanying file
@@ -9,7 +10,9 @@
 #ifndef BOOST_PROTO_V5_ACTION_EXTERNAL_HPP_INCLUDED
 #define BOOST_PROTO_V5_ACTION_EXTERNAL_HPP_INCLUDED
 
+#include <type_traits>
 #include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/env.hpp>
 #include <boost/proto/v5/utility.hpp>
 #include <boost/proto/v5/action/basic_action.hpp>
 #include <boost/proto/v5/action/env.hpp>
@@ -22,6 +25,100 @@ namespace boost
         {
             namespace detail
             {
+                struct action_table_base_
+                {};
+
+                template<typename Rule, typename Case>
+                struct action_table_entry_
+                {};
+
+                template<typename Case>
+                struct action_table_entry_of_;
+
+                template<typename Rule, typename ...Actions>
+                struct action_table_entry_of_<case_(Rule, Actions...)>
+                {
+                    using type = action_table_entry_<Rule, case_(Rule, Actions...)>;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // action_table_lookup_
+                // Finds the case for Rule among the bases of an action table. This is a single
+                // overload resolution, however many rules the table maps.
+                template<typename Rule, typename Case>
+                Case *action_table_lookup_(action_table_entry_<Rule, Case> const *);
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // shadowed_keys_
+                // The keys bound over an action table, as bases, so that whether one of them
+                // shadows a table entry is a single is_base_of test.
+                template<typename Key>
+                struct shadowed_key_
+                {};
+
+                struct no_shadowed_keys_
+                {};
+
+                template<typename Key, typename Keys>
+                struct shadowed_keys_
+                  : shadowed_key_<Key>
+                  , Keys
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // action_table_of_
+                // The action table an environment was built on, or void, and the keys bound over
+                // it. These are worked out once for each environment type, as it is built up, so
+                // that looking up a rule doesn't walk the environment.
+                template<typename Env>
+                struct action_table_of_
+                {
+                    using type =
+                        typename std::conditional<
+                            std::is_base_of<action_table_base_, Env>::value
+                          , Env
+                          , void
+                        >::type;
+                    using shadowed_type = no_shadowed_keys_;
+                };
+
+                template<typename Key, typename Value, typename Base>
+                struct action_table_of_<env<Key, Value, Base>>
+                {
+                    using type = typename action_table_of_<Base>::type;
+                    using shadowed_type =
+                        typename std::conditional<
+                            std::is_base_of<shadowed_key_<Key>, typename action_table_of_<Base>::shadowed_type>::value
+                          , typename action_table_of_<Base>::shadowed_type
+                          , shadowed_keys_<Key, typename action_table_of_<Base>::shadowed_type>
+                        >::type;
+                };
+
+                template<typename Rule, typename Env>
+                using action_table_case_ =
+                    typename std::remove_pointer<
+                        decltype(detail::action_table_lookup_<Rule>(
+                            static_cast<typename action_table_of_<utility::uncvref<Env>>::type const *>(nullptr)
+                        ))
+                    >::type;
+
+                // The table's action is used only if the rule isn't also bound over the table,
+                // so that (my_actions(), rule() = other_action()) calls other_action.
+                template<typename Rule, typename Env, typename Case = action_table_case_<Rule, Env>
+                  , BOOST_PROTO_ENABLE_IF((
+                        !std::is_base_of<
+                            shadowed_key_<Rule>
+                          , typename action_table_of_<utility::uncvref<Env>>::shadowed_type
+                        >::value
+                    ))>
+                std::true_type has_table_action_(int);
+
+                template<typename Rule, typename Env>
+                std::false_type has_table_action_(long);
+
+                template<typename Rule, typename Env>
+                using has_table_action_t_ = decltype(detail::has_table_action_<Rule, Env>(1));
+
                 template<typename RuleName>
                 struct _external_
                   : basic_action<_external_<RuleName>>
@@ -37,7 +134,20 @@ namespace boost
                         return utility::any();
                     }
 
-                    template<typename Expr, typename Env, typename ...Rest, typename Rule = RuleName>
+                    // Rules in the environment's action table are resolved at compile time.
+                    template<typename Expr, typename Env, typename ...Rest, typename Rule = RuleName
+                      , BOOST_PROTO_ENABLE_IF(has_table_action_t_<Rule, Env>::value)>
+                    constexpr auto operator()(Expr &&e, Env &&env, Rest &&...rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        call_action_<action_table_case_<Rule, Env>>()(
+                            static_cast<Expr &&>(e)
+                          , static_cast<Env &&>(env)
+                          , static_cast<Rest &&>(rest)...
+                        )
+                    )
+
+                    template<typename Expr, typename Env, typename ...Rest, typename Rule = RuleName
+                      , BOOST_PROTO_ENABLE_IF(!has_table_action_t_<Rule, Env>::value)>
                     constexpr auto operator()(Expr &&e, Env &&env, Rest &&...rest) const
                     BOOST_PROTO_AUTO_RETURN(
                         BOOST_PROTO_TRY_CALL(static_cast<Env &&>(env)(Rule()))(
@@ -52,6 +162,32 @@ namespace boost
             struct external
             {};
 
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // action_table
+            // An empty environment that maps rules to actions at compile time, for grammars
+            // that handle rules with case_(Rule, external). Each of the Cases is written
+            // case_(Rule, Actions...), as in a grammar. Other variables are added to it as to
+            // any environment, as in (my_actions(), data = x). Rules the table doesn't map are
+            // looked up in the rest of the environment, and a rule added to it that way, as in
+            // (my_actions(), rule() = other_action()), takes precedence over the table.
+            template<typename ...Cases>
+            struct action_table
+              : empty_env
+              , detail::action_table_base_
+              , detail::action_table_entry_of_<Cases>::type...
+            {
+                BOOST_PROTO_REGULAR_TRIVIAL_CLASS(action_table);
+
+                template<typename T, typename V>
+                friend constexpr env<T, V, action_table> operator,(action_table tail, env<T, V> head)
+                {
+                    return env<T, V, action_table>(
+                        static_cast<env<T, V> &&>(head).value_
+                      , static_cast<action_table &&>(tail)
+                    );
+                }
+            };
+
             namespace extension
             {
                 template<typename RuleName>
@@ -16,6 +16,7 @@
 #include <boost/fusion/include/prior.hpp>
 #include <boost/proto/v5/proto_fwd.hpp>
 #include <boost/proto/v5/fusion.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
 #include <boost/proto/v5/action/basic_action.hpp>
 #include <boost/proto/v5/action/env.hpp>
 
@@ -65,7 +66,8 @@ namespace boost
                 template<typename Fun>
                 struct fold_1_
                 {
-                    template<typename Sequence, typename Env, typename State0, typename ...Rest>
+                    template<typename Sequence, typename Env, typename State0, typename ...Rest
+                      , BOOST_PROTO_ENABLE_IF(!is_nary<Sequence>::value)>
                     constexpr auto operator()(Sequence && seq, Env &&env, State0 const &state0, Rest &&... rest) const
                     BOOST_PROTO_AUTO_RETURN(
                         BOOST_PROTO_TRY_CALL(fold_2_<Fun>())(
@@ -76,6 +78,37 @@ namespace boost
                           , static_cast<Rest &&>(rest)...
                         )
                     )
+
+                    // The children of a runtime-arity expression are visited in a loop, so the
+                    // state must have the same type after each step.
+                    template<typename Sequence, typename Env, typename State0, typename ...Rest
+                      , BOOST_PROTO_ENABLE_IF(is_nary<Sequence>::value)
+                      , typename State = utility::uncvref<
+                            decltype(
+                                call_action_<Fun>()(
+                                    proto::v5::child(std::declval<Sequence>(), 0)
+                                  , std::declval<Env>()
+                                  , std::declval<State0 const &>()
+                                  , std::declval<Rest>()...
+                                )
+                            )
+                        >
+                    >
+                    State operator()(Sequence && seq, Env &&env, State0 const &state0, Rest &&... rest) const
+                    {
+                        std::size_t const size = proto::v5::children_of(seq).size();
+                        State state(state0);
+                        for(std::size_t i = 0; i != size; ++i)
+                        {
+                            state = call_action_<Fun>()(
+                                proto::v5::child(static_cast<Sequence &&>(seq), i)
+                              , static_cast<Env &&>(env)
+                              , static_cast<State const &>(state)
+                              , static_cast<Rest &&>(rest)...
+                            );
+                        }
+                        return state;
+                    }
                 };
 
                 ////////////////////////////////////////////////////////////////////////////////////
@@ -116,7 +149,8 @@ namespace boost
                 template<typename Fun>
                 struct reverse_fold_1_
                 {
-                    template<typename Sequence, typename Env, typename State0, typename ...Rest>
+                    template<typename Sequence, typename Env, typename State0, typename ...Rest
+                      , BOOST_PROTO_ENABLE_IF(!is_nary<Sequence>::value)>
                     constexpr auto operator()(Sequence && seq, Env &&env, State0 const &state0, Rest &&... rest) const
                     BOOST_PROTO_AUTO_RETURN(
                         BOOST_PROTO_TRY_CALL(reverse_fold_2_<Fun>())(
@@ -127,6 +161,37 @@ namespace boost
                           , static_cast<Rest &&>(rest)...
                         )
                     )
+
+                    // The children of a runtime-arity expression are visited in a loop, so the
+                    // state must have the same type after each step.
+                    template<typename Sequence, typename Env, typename State0, typename ...Rest
+                      , BOOST_PROTO_ENABLE_IF(is_nary<Sequence>::value)
+                      , typename State = utility::uncvref<
+                            decltype(
+                                call_action_<Fun>()(
+                                    proto::v5::child(std::declval<Sequence>(), 0)
+                                  , std::declval<Env>()
+                                  , std::declval<State0 const &>()
+                                  , std::declval<Rest>()...
+                                )
+                            )
+                        >
+                    >
+                    State operator()(Sequence && seq, Env &&env, State0 const &state0, Rest &&... rest) const
+                    {
+                        std::size_t const size = proto::v5::children_of(seq).size();
+                        State state(state0);
+                        for(std::size_t i = size; i-- != 0;)
+                        {
+                            state = call_action_<Fun>()(
+                                proto::v5::child(static_cast<Sequence &&>(seq), i)
+                              , static_cast<Env &&>(env)
+                              , static_cast<State const &>(state)
+                              , static_cast<Rest &&>(rest)...
+                            );
+                        }
+                        return state;
+                    }
                 };
 
                 ////////////////////////////////////////////////////////////////////////////////////
@@ -15,6 +15,7 @@
 #include <boost/proto/v5/proto_fwd.hpp>
 #include <boost/proto/v5/children.hpp>
 #include <boost/proto/v5/make_expr.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
 #include <boost/proto/v5/utility.hpp>
 #include <boost/proto/v5/action/basic_action.hpp>
 
@@ -66,7 +67,7 @@ namespace boost
                     BOOST_PROTO_AUTO_RETURN(
                         typename result_of::domain_of<E>::type::make_expr()(
                             proto::v5::tag_of(static_cast<E &&>(e))
-                          , utility::by_val()(
+                          , utility::by_val_arg()(
                                 proto::v5::as_expr<typename result_of::domain_of<E>::type>(
                                     as_passthru_action_<Actions>()(
                                         proto::v5::child<I>(static_cast<E &&>(e))
@@ -102,6 +103,60 @@ namespace boost
                     )
                 };
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // nary_passthru_
+                // Rebuilds a runtime-arity expression one child at a time. The children all have
+                // the same type, so they must all be transformed by the same action.
+                template<typename Pattern>
+                struct nary_passthru_
+                {
+                    template<typename ...Args>
+                    void operator()(Args &&...) const
+                    {
+                        static_assert(
+                            utility::never<Args...>::value
+                          , "a runtime-arity expression can only be passed through a pattern with "
+                            "a single repeated action, like passthru(X...)"
+                        );
+                    }
+                };
+
+                template<typename Tag, typename Action>
+                struct nary_passthru_<Tag(Action...)>
+                {
+                    template<typename E, typename ...Rest
+                      , typename Domain = typename result_of::domain_of<E>::type
+                      , typename Child = utility::uncvref<
+                            decltype(
+                                proto::v5::as_expr<Domain>(
+                                    as_passthru_action_<Action>()(
+                                        proto::v5::child(std::declval<E>(), 0)
+                                      , std::declval<Rest>()...
+                                    )
+                                )
+                            )
+                        >
+                      , typename Result = typename nary_rebind_<utility::uncvref<E>, Child>::type>
+                    Result operator()(E && e, Rest &&... rest) const
+                    {
+                        std::size_t const size = proto::v5::children_of(e).size();
+                        Result result(proto::v5::tag_of(static_cast<E &&>(e)));
+                        proto::v5::children_of(result).reserve(size);
+                        for(std::size_t i = 0; i != size; ++i)
+                        {
+                            proto::v5::children_of(result).push_back(
+                                proto::v5::as_expr<Domain>(
+                                    as_passthru_action_<Action>()(
+                                        proto::v5::child(static_cast<E &&>(e), i)
+                                      , static_cast<Rest &&>(rest)...
+                                    )
+                                )
+                            );
+                        }
+                        return result;
+                    }
+                };
+
                 ////////////////////////////////////////////////////////////////////////////////////
                 // _passthru_
                 template<typename Actions>
@@ -114,7 +169,8 @@ namespace boost
                         utility::by_val()(static_cast<E &&>(e))
                     )
 
-                    template<typename E, typename ...Rest, BOOST_PROTO_ENABLE_IF(!is_terminal<E>::value)>
+                    template<typename E, typename ...Rest
+                      , BOOST_PROTO_ENABLE_IF(!is_terminal<E>::value && !is_nary<E>::value)>
                     constexpr auto operator()(E && e, Rest &&... rest) const
                     BOOST_PROTO_AUTO_RETURN(
                         detail::passthru_0_<
@@ -122,6 +178,12 @@ namespace boost
                           , Actions
                         >()(static_cast<E &&>(e), static_cast<Rest &&>(rest)...)
                     )
+
+                    template<typename E, typename ...Rest, BOOST_PROTO_ENABLE_IF(is_nary<E>::value)>
+                    auto operator()(E && e, Rest &&... rest) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        detail::nary_passthru_<Actions>()(static_cast<E &&>(e), static_cast<Rest &&>(rest)...)
+                    )
                 };
             }
 
@@ -0,0 +1,238 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// stats.hpp
+// Contains definition of the _stats action, which reports the shape and storage footprint of an
+// expression tree.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_ACTION_STATS_HPP_INCLUDED
+#define BOOST_PROTO_V5_ACTION_STATS_HPP_INCLUDED
+
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/debug.hpp>
+#include <boost/proto/v5/action/basic_action.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // stats_count_
+                // How many times does T appear in Ts?
+                template<typename T, typename ...Ts>
+                struct stats_count_
+                  : std::integral_constant<
+                        std::size_t
+                      , utility::size_ops::sum(std::is_same<T, Ts>::value...)
+                    >
+                {};
+
+                template<typename T, typename ...Ts>
+                struct stats_count_<T, utility::list<Ts...>>
+                  : stats_count_<T, Ts...>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // stats_
+                template<
+                    typename Expr
+                  , typename ExprDesc = typename Expr::proto_expr_descriptor_type
+                  , bool IsTerminal = Expr::proto_is_terminal_type::value
+                >
+                struct stats_;
+
+                // Children that are not expressions (e.g., the virtual_<> placeholder of a
+                // virtual member) contribute nothing.
+                template<typename Child, bool IsExpr = is_expr<Child>::value>
+                struct stats_child_impl_
+                  : stats_<Child>
+                {};
+
+                template<typename Child>
+                struct stats_child_impl_<Child, false>
+                {
+                    using tags_type = utility::list<>;
+                    static constexpr std::size_t node_count = 0;
+                    static constexpr std::size_t max_depth = 0;
+                    static constexpr std::size_t terminals_by_ref = 0;
+                    static constexpr std::size_t terminals_by_value = 0;
+                    static constexpr std::size_t terminal_value_bytes = 0;
+                };
+
+                template<typename Child>
+                using stats_child_ = stats_child_impl_<utility::uncvref<Child>>;
+
+                template<typename Expr, typename Tag, typename Value>
+                struct stats_<Expr, Tag(Value), true>
+                {
+                    using tags_type = utility::list<Tag>;
+                    static constexpr std::size_t node_count = 1;
+                    static constexpr std::size_t max_depth = 1;
+                    static constexpr std::size_t terminals_by_ref = std::is_reference<Value>::value;
+                    static constexpr std::size_t terminals_by_value = !std::is_reference<Value>::value;
+                    static constexpr std::size_t terminal_value_bytes =
+                        std::is_reference<Value>::value ? 0 : sizeof(utility::uncvref<Value>);
+                };
+
+                template<typename Expr, typename Tag, typename ...Children>
+                struct stats_<Expr, Tag(Children...), false>
+                {
+                    using tags_type =
+                        typename utility::concat<
+                            utility::list<Tag>
+                          , typename stats_child_<Children>::tags_type...
+                        >::type;
+                    static constexpr std::size_t node_count =
+                        1 + utility::size_ops::sum(stats_child_<Children>::node_count...);
+                    static constexpr std::size_t max_depth =
+                        1 + utility::size_ops::max(stats_child_<Children>::max_depth...);
+                    static constexpr std::size_t terminals_by_ref =
+                        utility::size_ops::sum(stats_child_<Children>::terminals_by_ref...);
+                    static constexpr std::size_t terminals_by_value =
+                        utility::size_ops::sum(stats_child_<Children>::terminals_by_value...);
+                    static constexpr std::size_t terminal_value_bytes =
+                        utility::size_ops::sum(stats_child_<Children>::terminal_value_bytes...);
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // print_tag_histogram_
+                // Print each distinct tag once, in the order in which it is first encountered.
+                template<typename Tags, typename Seen = utility::list<>>
+                struct print_tag_histogram_;
+
+                template<typename ...Seen>
+                struct print_tag_histogram_<utility::list<>, utility::list<Seen...>>
+                {
+                    static void call(std::ostream &)
+                    {}
+                };
+
+                template<typename Head, typename ...Tail, typename ...Seen>
+                struct print_tag_histogram_<utility::list<Head, Tail...>, utility::list<Seen...>>
+                {
+                    static void call(std::ostream &sout)
+                    {
+                        if(0 == stats_count_<Head, Seen...>::value)
+                        {
+                            sout << "  " << detail::name_of<Head>() << ": "
+                                 << (1 + stats_count_<Head, Tail...>::value) << '\n';
+                        }
+                        print_tag_histogram_<utility::list<Tail...>, utility::list<Seen..., Head>>
+                            ::call(sout);
+                    }
+                };
+            }
+
+            namespace result_of
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // stats
+                // Statistics about an expression type. Everything is computed from the type of
+                // the expression, so all the values are integral constant expressions.
+                template<typename Expr>
+                struct stats
+                {
+                private:
+                    using expr_type = utility::uncvref<Expr>;
+                    using impl_type = detail::stats_<expr_type>;
+
+                public:
+                    /// The tag of every node in the tree, in preorder.
+                    using tags_type = typename impl_type::tags_type;
+
+                    /// The number of nodes, including terminals.
+                    static constexpr std::size_t node_count = impl_type::node_count;
+
+                    /// The number of nodes on the longest path from the root to a terminal.
+                    static constexpr std::size_t max_depth = impl_type::max_depth;
+
+                    /// The number of terminals that hold their values by reference.
+                    static constexpr std::size_t terminals_by_ref = impl_type::terminals_by_ref;
+
+                    /// The number of terminals that hold their values by value.
+                    static constexpr std::size_t terminals_by_value = impl_type::terminals_by_value;
+
+                    /// The total size of all the values held by value in terminals.
+                    static constexpr std::size_t terminal_value_bytes =
+                        impl_type::terminal_value_bytes;
+
+                    /// The size of the expression object itself.
+                    static constexpr std::size_t size = sizeof(expr_type);
+
+                    /// The number of nodes with tag \c Tag.
+                    template<typename Tag>
+                    static constexpr std::size_t tag_count()
+                    {
+                        return detail::stats_count_<Tag, tags_type>::value;
+                    }
+
+                    /// Writes a human-readable report of the statistics.
+                    friend std::ostream &operator<<(std::ostream &sout, stats const &)
+                    {
+                        sout << "nodes: " << node_count << '\n'
+                             << "max depth: " << max_depth << '\n'
+                             << "terminals by value: " << terminals_by_value << '\n'
+                             << "terminals by reference: " << terminals_by_ref << '\n'
+                             << "terminal value bytes: " << terminal_value_bytes << '\n'
+                             << "sizeof: " << size << '\n'
+                             << "tags:\n";
+                        detail::print_tag_histogram_<tags_type>::call(sout);
+                        return sout;
+                    }
+                };
+
+                template<typename Expr>
+                constexpr std::size_t stats<Expr>::node_count;
+
+                template<typename Expr>
+                constexpr std::size_t stats<Expr>::max_depth;
+
+                template<typename Expr>
+                constexpr std::size_t stats<Expr>::terminals_by_ref;
+
+                template<typename Expr>
+                constexpr std::size_t stats<Expr>::terminals_by_value;
+
+                template<typename Expr>
+                constexpr std::size_t stats<Expr>::terminal_value_bytes;
+
+                template<typename Expr>
+                constexpr std::size_t stats<Expr>::size;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // _stats
+            // An action that returns a result_of::stats object describing the expression.
+            struct _stats
+              : basic_action<_stats>
+            {
+                template<typename E, typename ...Rest>
+                constexpr result_of::stats<E> operator()(E &&, Rest &&...) const
+                {
+                    return result_of::stats<E>();
+                }
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // stats
+            template<typename E>
+            constexpr result_of::stats<E> stats(E &&)
+            {
+                return result_of::stats<E>();
+            }
+        }
+    }
+}
+
+#endif
@@ -8,9 +8,17 @@
 #ifndef BOOST_PROTO_V5_ACTION_SWITCH_HPP_INCLUDED
 #define BOOST_PROTO_V5_ACTION_SWITCH_HPP_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/repetition/repeat.hpp>
 #include <boost/proto/v5/proto_fwd.hpp>
 #include <boost/proto/v5/tags.hpp>
+#include <boost/proto/v5/utility.hpp>
 #include <boost/proto/v5/action/basic_action.hpp>
+#include <boost/proto/v5/action/case.hpp>
 
 namespace boost
 {
@@ -75,8 +83,251 @@ namespace boost
                 };
             }
 
+            /// \brief For selecting one of several actions by a value known only
+            /// at runtime, such as an opcode or an enumerator held in a terminal.
+            ///
+            /// In <tt>switch_on(Action, case_(Label, Actions...)..., default_(Actions...))</tt>,
+            /// \c Action computes an integral or enumeration value, and each \c Label
+            /// is a type with a static \c value, like \c std::integral_constant. The
+            /// actions of the case whose label equals the value are applied, or else
+            /// those of the \c default_, if there is one, or else the result is a
+            /// value-initialized object. All the cases must return the same type, or
+            /// types with a common type.
+            ///
+            /// The cases are found by a single \c switch statement with one label for
+            /// each value between the smallest and the largest label, so the labels
+            /// should be dense; they may be at most 1024 apart. Compilers turn such a
+            /// statement into a jump table, with the cases inlined, so that finding a
+            /// case costs a range check and one indirect jump rather than a branch per
+            /// case.
+            ///
+            /// \code
+            /// enum class opcode { add, sub, mul };
+            ///
+            /// struct Exec
+            ///   : def<
+            ///         switch_on(
+            ///             _value(_child0)
+            ///           , case_(std::integral_constant<opcode, opcode::add>, DoAdd)
+            ///           , case_(std::integral_constant<opcode, opcode::sub>, DoSub)
+            ///           , default_(DoMul)
+            ///         )
+            ///     >
+            /// {};
+            /// \endcode
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // switch_stmt_
+                // What switch_on needs to know about each of its case_ and default_ statements.
+                template<typename Stmt>
+                struct switch_stmt_
+                {
+                    static_assert(
+                        utility::never<Stmt>::value
+                      , "The statements of proto::switch_on must be case_(Label, Actions...) "
+                        "or default_(Actions...)."
+                    );
+                };
+
+                template<typename Label, typename ActionHead, typename ...ActionTail>
+                struct switch_stmt_<case_(*)(Label, ActionHead, ActionTail...)>
+                {
+                    static constexpr bool is_case = true;
+                    static constexpr std::intmax_t label = static_cast<std::intmax_t>(Label::value);
+                };
+
+                template<typename ActionHead, typename ...ActionTail>
+                struct switch_stmt_<default_(*)(ActionHead, ActionTail...)>
+                {
+                    static constexpr bool is_case = false;
+                    static constexpr std::intmax_t label = 0;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // switch_stmts_
+                // The labels of the statements, and where each value between the smallest and
+                // the largest of them goes. Position size means there is nowhere to go.
+                template<typename ...Stmts>
+                struct switch_stmts_
+                {
+                    static constexpr std::size_t size = sizeof...(Stmts);
+                    static constexpr bool is_case[size] = {switch_stmt_<Stmts>::is_case...};
+                    static constexpr std::intmax_t label[size] = {switch_stmt_<Stmts>::label...};
+
+                    static constexpr std::size_t find_default(std::size_t i = 0)
+                    {
+                        return i == size || !is_case[i] ? i : find_default(i + 1);
+                    }
+
+                    static constexpr std::size_t count_defaults(std::size_t i = 0)
+                    {
+                        return i == size ? 0 : (is_case[i] ? 0 : 1) + count_defaults(i + 1);
+                    }
+
+                    static constexpr std::size_t find(std::intmax_t value, std::size_t i = 0)
+                    {
+                        return i == size
+                          ? find_default()
+                          : is_case[i] && label[i] == value ? i : find(value, i + 1);
+                    }
+
+                    // Every case is the first with its label
+                    static constexpr bool unique(std::size_t i = 0)
+                    {
+                        return i == size || ((!is_case[i] || find(label[i]) == i) && unique(i + 1));
+                    }
+
+                    static constexpr bool any_case(std::size_t i = 0)
+                    {
+                        return i != size && (is_case[i] || any_case(i + 1));
+                    }
+
+                    static constexpr std::intmax_t min(std::size_t i = 0)
+                    {
+                        return i == size
+                          ? INTMAX_MAX
+                          : is_case[i] && label[i] < min(i + 1) ? label[i] : min(i + 1);
+                    }
+
+                    static constexpr std::intmax_t max(std::size_t i = 0)
+                    {
+                        return i == size
+                          ? INTMAX_MIN
+                          : is_case[i] && label[i] > max(i + 1) ? label[i] : max(i + 1);
+                    }
+                };
+
+                template<typename ...Stmts>
+                constexpr bool switch_stmts_<Stmts...>::is_case[switch_stmts_<Stmts...>::size];
+
+                template<typename ...Stmts>
+                constexpr std::intmax_t switch_stmts_<Stmts...>::label[switch_stmts_<Stmts...>::size];
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // switch_target_
+                // Applies one statement's actions and converts the result to Result. Stmt is
+                // void when there is no statement for a value.
+                template<typename Result, typename Stmt>
+                struct switch_target_
+                {
+                    template<typename Expr, typename ...Rest>
+                    static Result call(Expr &&e, Rest &&... rest)
+                    {
+                        return call_action_<Stmt>()(static_cast<Expr &&>(e), static_cast<Rest &&>(rest)...);
+                    }
+                };
+
+                template<typename Result>
+                struct switch_target_<Result, void>
+                {
+                    template<typename Expr, typename ...Rest>
+                    static Result call(Expr &&, Rest &&...)
+                    {
+                        return Result();
+                    }
+                };
+
+                template<typename Action, typename ...Stmts>
+                struct _switch_on_
+                  : basic_action<_switch_on_<Action, Stmts...>>
+                {
+                private:
+                    using stmts_ = switch_stmts_<Stmts...>;
+
+                    static_assert(stmts_::any_case(), "proto::switch_on needs at least one case_.");
+                    static_assert(stmts_::count_defaults() <= 1, "proto::switch_on takes at most one default_.");
+                    static_assert(stmts_::unique(), "The labels of proto::switch_on must be distinct.");
+
+                    static constexpr std::intmax_t min_ = stmts_::min();
+                    static constexpr std::uintmax_t size_ =
+                        static_cast<std::uintmax_t>(stmts_::max()) - static_cast<std::uintmax_t>(min_) + 1;
+
+                    static_assert(
+                        size_ <= 1024
+                      , "The labels of proto::switch_on are too far apart for a jump table."
+                    );
+
+                    // The number of labels in the switch statement: the smallest of 16, 64, 256
+                    // and 1024 that covers the labels of the cases
+                    static constexpr std::uintmax_t width_ =
+                        size_ <= 16 ? 16 : size_ <= 64 ? 64 : size_ <= 256 ? 256 : 1024;
+
+                    // The statement for the value min_ + I, or for values no case has
+                    template<std::size_t I
+                      , std::size_t Pos = I < size_
+                            ? stmts_::find(min_ + static_cast<std::intmax_t>(I))
+                            : stmts_::find_default()>
+                    using stmt_at_ = typename utility::result_of::get_nth<Pos, Stmts..., void>::type;
+
+                    #define BOOST_PROTO_SWITCH_ON_CASE(Z, N, BLOCK)                                 \
+                    case BLOCK * 16 + N:                                                            \
+                        return switch_target_<Result, stmt_at_<BLOCK * 16 + N>>::call(              \
+                            static_cast<Expr &&>(e)                                                 \
+                          , static_cast<Rest &&>(rest)...                                           \
+                        );                                                                          \
+                    /**/
+
+                    #define BOOST_PROTO_SWITCH_ON_BLOCK(Z, BLOCK, DATA)                             \
+                    BOOST_PP_CAT(BOOST_PP_REPEAT_, Z)(16, BOOST_PROTO_SWITCH_ON_CASE, BLOCK)        \
+                    /**/
+
+                    // A switch over BLOCKS * 16 values, which the compiler turns into a jump
+                    // table with the cases inlined
+                    #define BOOST_PROTO_SWITCH_ON_DISPATCH(BLOCKS)                                  \
+                    template<typename Result, std::uintmax_t Width = width_                         \
+                      , typename Expr, typename ...Rest                                             \
+                      , BOOST_PROTO_ENABLE_IF(Width == BLOCKS * 16)>                                \
+                    static Result dispatch_(std::uintmax_t index, Expr &&e, Rest &&... rest)        \
+                    {                                                                               \
+                        switch(index)                                                               \
+                        {                                                                           \
+                        BOOST_PP_REPEAT(BLOCKS, BOOST_PROTO_SWITCH_ON_BLOCK, ~)                     \
+                        default:                                                                    \
+                            return switch_target_<Result, stmt_at_<size_>>::call(                   \
+                                static_cast<Expr &&>(e)                                             \
+                              , static_cast<Rest &&>(rest)...                                       \
+                            );                                                                      \
+                        }                                                                           \
+                    }                                                                               \
+                    /**/
+
+                    BOOST_PROTO_SWITCH_ON_DISPATCH(1)
+                    BOOST_PROTO_SWITCH_ON_DISPATCH(4)
+                    BOOST_PROTO_SWITCH_ON_DISPATCH(16)
+                    BOOST_PROTO_SWITCH_ON_DISPATCH(64)
+
+                    #undef BOOST_PROTO_SWITCH_ON_DISPATCH
+                    #undef BOOST_PROTO_SWITCH_ON_BLOCK
+                    #undef BOOST_PROTO_SWITCH_ON_CASE
+
+                public:
+                    template<typename Expr, typename ...Rest
+                      , typename Result = typename std::common_type<
+                            decltype(call_action_<Stmts>()(std::declval<Expr>(), std::declval<Rest>()...))...
+                        >::type>
+                    Result operator()(Expr &&e, Rest &&... rest) const
+                    {
+                        std::uintmax_t const index =
+                            static_cast<std::uintmax_t>(
+                                static_cast<std::intmax_t>(call_action_<Action>()(e, rest...))
+                            ) - static_cast<std::uintmax_t>(min_);
+                        return _switch_on_::dispatch_<Result>(
+                            index
+                          , static_cast<Expr &&>(e)
+                          , static_cast<Rest &&>(rest)...
+                        );
+                    }
+                };
+            }
+
             namespace extension
             {
+                template<typename Action, typename ...Stmts>
+                struct action_impl<switch_on(Action, Stmts...)>
+                  : detail::_switch_on_<Action, Stmts...>
+                {};
+
                 template<typename Cases>
                 struct action_impl<switch_(Cases)>
                   : detail::_switch_<Cases, _tag_of>
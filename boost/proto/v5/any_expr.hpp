@@ -0,0 +1,1131 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// any_expr.hpp
+// A type-erased expression, for expressions whose shape is only known at runtime, such as rules
+// read from a configuration file. An any_expr is a small handle to an immutable node that lives in
+// an any_expr_pool, which carves its nodes out of an arena and frees them all at once. A node
+// records its tag by its tag_id and holds either pointers to its children or a copy of its
+// terminal's value. any_exprs can be copied from static expressions, built from a tag and
+// children, or built with Proto's usual operators. They are evaluated for a given value type
+// through a table of functions indexed by tag_id, which is built once per domain and value type.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_ANY_EXPR_HPP_INCLUDED
+#define BOOST_PROTO_V5_ANY_EXPR_HPP_INCLUDED
+
+#include <new>
+#include <cstddef>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <typeinfo>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+#include <boost/preprocessor/punctuation/comma.hpp>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/arena.hpp>
+#include <boost/proto/v5/debug.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
+#include <boost/proto/v5/tags.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/action/eval.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // any_expr_error
+            // Thrown when an any_expr can't be built or evaluated as asked.
+            struct any_expr_error
+              : std::runtime_error
+            {
+                explicit any_expr_error(char const *what)
+                  : std::runtime_error(what)
+                {}
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // any_arg
+            // The value of a terminal that evaluates to the index-th argument passed to
+            // any_expr::eval.
+            struct any_arg
+            {
+                std::size_t index;
+
+                friend std::ostream &operator<<(std::ostream &sout, any_arg arg)
+                {
+                    return sout << "arg" << arg.index;
+                }
+            };
+
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_tag_
+                // What a node knows about its tag.
+                struct any_tag_
+                {
+                    unsigned char id;
+                    bool associative;
+                    bool (*arity)(std::size_t);
+                    void (*write)(std::ostream &);
+                };
+
+                template<typename Tag>
+                struct any_tag_of_
+                {
+                    static void write(std::ostream &sout)
+                    {
+                        using namespace hidden_detail_;
+                        sout << Tag();
+                    }
+
+                    static any_tag_ const value;
+                };
+
+                template<typename Tag>
+                any_tag_ const any_tag_of_<Tag>::value =
+                {
+                    tag_id<Tag>::value
+                  , is_associative<Tag>::value
+                  , &Tag::proto_arity_type::equal_to
+                  , &any_tag_of_<Tag>::write
+                };
+
+                // Proto's tags but member, whose action builds an expression rather than a value.
+                using any_operator_tags_ =
+                    utility::list<
+                        terminal, unary_plus, negate, dereference, complement, address_of
+                      , logical_not, pre_inc, pre_dec, post_inc, post_dec, shift_left, shift_right
+                      , multiplies, divides, modulus, plus, minus, less, greater, less_equal
+                      , greater_equal, equal_to, not_equal_to, logical_or, logical_and, bitwise_and
+                      , bitwise_or, bitwise_xor, comma, mem_ptr, assign, shift_left_assign
+                      , shift_right_assign, multiplies_assign, divides_assign, modulus_assign
+                      , plus_assign, minus_assign, bitwise_and_assign, bitwise_or_assign
+                      , bitwise_xor_assign, subscript, if_else_, function
+                    >;
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_builtin_tag_
+                // Proto's own tags by their tag_id, for building nodes from a tag_id read at
+                // runtime. Returns null for an id that isn't one of Proto's tags.
+                struct any_builtin_tag_table_
+                {
+                    any_tag_ const *tags_[256];
+
+                    any_builtin_tag_table_() noexcept
+                      : tags_()
+                    {
+                        this->set_(static_cast<any_operator_tags_ *>(nullptr));
+                        this->set_(static_cast<utility::list<member> *>(nullptr));
+                    }
+
+                private:
+                    template<typename ...Tags>
+                    void set_(utility::list<Tags...> *) noexcept
+                    {
+                        using expand = int[];
+                        (void)expand{0, (tags_[tag_id<Tags>::value] = &any_tag_of_<Tags>::value, 0)...};
+                    }
+                };
+
+                inline any_tag_ const *any_builtin_tag_(unsigned char id) noexcept
+                {
+                    static any_builtin_tag_table_ const table;
+                    return table.tags_[id];
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_value_
+                // What a terminal knows about the type of its value.
+                struct any_value_
+                {
+                    std::type_info const &(*type)() noexcept;
+                    void (*destroy)(void *) noexcept;
+                    void (*display)(std::ostream &, void const *);
+                    long double (*arithmetic)(void const *) noexcept;
+                    bool (*equal)(void const *, void const *) noexcept;
+                };
+
+                template<typename T, bool IsArithmetic = std::is_arithmetic<T>::value>
+                struct any_arithmetic_
+                {
+                    static constexpr long double (*value)(void const *) noexcept = nullptr;
+                    static constexpr bool (*equal)(void const *, void const *) noexcept = nullptr;
+                };
+
+                template<typename T>
+                struct any_arithmetic_<T, true>
+                {
+                    static long double call(void const *p) noexcept
+                    {
+                        return static_cast<long double>(*static_cast<T const *>(p));
+                    }
+
+                    static bool equal_(void const *a, void const *b) noexcept
+                    {
+                        return *static_cast<T const *>(a) == *static_cast<T const *>(b);
+                    }
+
+                    static constexpr long double (*value)(void const *) noexcept = &any_arithmetic_::call;
+                    static constexpr bool (*equal)(void const *, void const *) noexcept = &any_arithmetic_::equal_;
+                };
+
+                template<typename T>
+                struct any_value_of_
+                {
+                    static std::type_info const &type() noexcept
+                    {
+                        return typeid(T);
+                    }
+
+                    static void destroy(void *p) noexcept
+                    {
+                        static_cast<T *>(p)->~T();
+                    }
+
+                    static void display(std::ostream &sout, void const *p)
+                    {
+                        using namespace hidden_detail_;
+                        sout << "(" << detail::name_of<T>() << ") " << *static_cast<T const *>(p);
+                    }
+
+                    static any_value_ const value;
+                };
+
+                template<typename T>
+                any_value_ const any_value_of_<T>::value =
+                {
+                    &any_value_of_<T>::type
+                  , std::is_trivially_destructible<T>::value ? nullptr : &any_value_of_<T>::destroy
+                  , &any_value_of_<T>::display
+                  , any_arithmetic_<T>::value
+                  , any_arithmetic_<T>::equal
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_node_
+                // A node of a type-erased expression. data_ points to the terminal's value, or to
+                // the array of pointers to the children. Either is kept in buffer_ when it fits.
+                struct any_node_
+                {
+                    any_tag_ const *tag_;
+                    any_value_ const *value_type_;
+                    any_node_ *next_;
+                    std::size_t size_;
+                    void *data_;
+                    typename std::aligned_storage<2 * sizeof(void *), alignof(void *)>::type buffer_;
+
+                    any_node_ const *const *children() const noexcept
+                    {
+                        return static_cast<any_node_ const *const *>(data_);
+                    }
+                };
+
+                template<typename Domain>
+                struct any_wrap_;
+
+                struct any_access_;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // any_expr_pool
+            // Owns the nodes of any_exprs. Nodes are carved out of an arena, so building one
+            // rarely allocates, and they are all freed together, along with the values of their
+            // terminals, when the pool is cleared or destroyed.
+            struct any_expr_pool
+            {
+                explicit any_expr_pool(std::size_t chunk_size = 4096) noexcept
+                  : arena_(chunk_size)
+                  , values_(nullptr)
+                  , size_(0)
+                {}
+
+                any_expr_pool(any_expr_pool const &) = delete;
+                any_expr_pool &operator=(any_expr_pool const &) = delete;
+
+                ~any_expr_pool()
+                {
+                    this->destroy_values_();
+                }
+
+                // The number of nodes built so far
+                std::size_t size() const noexcept
+                {
+                    return size_;
+                }
+
+                // Frees all the nodes at once. Every any_expr built in this pool is invalidated.
+                void clear() noexcept
+                {
+                    this->destroy_values_();
+                    arena_.clear();
+                    size_ = 0;
+                }
+
+            private:
+                template<typename Domain>
+                friend struct exprs::any_expr;
+
+                template<typename Domain>
+                friend struct detail::any_wrap_;
+
+                detail::any_node_ *new_node_(detail::any_tag_ const &tag, std::size_t size)
+                {
+                    using node_ptr = detail::any_node_ const *;
+                    detail::any_node_ *node =
+                        ::new(arena_.allocate(sizeof(detail::any_node_), alignof(detail::any_node_)))
+                            detail::any_node_();
+                    node->tag_ = &tag;
+                    node->size_ = size;
+                    node->data_ = size * sizeof(node_ptr) <= sizeof(node->buffer_)
+                      ? static_cast<void *>(&node->buffer_)
+                      : arena_.allocate(size * sizeof(node_ptr), alignof(node_ptr));
+                    ++size_;
+                    return node;
+                }
+
+                template<typename T, typename U>
+                detail::any_node_ *new_terminal_(U && u)
+                {
+                    detail::any_node_ *node = this->new_node_(detail::any_tag_of_<terminal>::value, 0);
+                    void *p = sizeof(T) <= sizeof(node->buffer_) && alignof(T) <= alignof(decltype(node->buffer_))
+                      ? static_cast<void *>(&node->buffer_)
+                      : arena_.allocate(sizeof(T), alignof(T));
+                    ::new(p) T(static_cast<U &&>(u));
+                    node->data_ = p;
+                    node->value_type_ = &detail::any_value_of_<T>::value;
+                    if(node->value_type_->destroy)
+                    {
+                        node->next_ = values_;
+                        values_ = node;
+                    }
+                    return node;
+                }
+
+                void destroy_values_() noexcept
+                {
+                    for(; values_; values_ = values_->next_)
+                        values_->value_type_->destroy(values_->data_);
+                }
+
+                arena arena_;
+                detail::any_node_ *values_;
+                std::size_t size_;
+            };
+
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_value_as_
+                // A terminal's value as a Value: the value itself if it has that type, an argument
+                // if it is an any_arg, or else a converted arithmetic value.
+                template<typename Value, bool IsArithmetic = std::is_arithmetic<Value>::value>
+                struct any_convert_
+                {
+                    static Value call(any_value_ const &, void const *)
+                    {
+                        throw any_expr_error("any_expr terminal doesn't hold a value of the requested type");
+                    }
+                };
+
+                template<typename Value>
+                struct any_convert_<Value, true>
+                {
+                    static Value call(any_value_ const &type, void const *data)
+                    {
+                        if(!type.arithmetic)
+                            return any_convert_<Value, false>::call(type, data);
+                        return static_cast<Value>(type.arithmetic(data));
+                    }
+                };
+
+                template<typename Value>
+                Value any_value_as_(
+                    any_value_ const &type
+                  , void const *data
+                  , Value const *args
+                  , std::size_t nargs
+                )
+                {
+                    if(&type == &any_value_of_<Value>::value || type.type() == typeid(Value))
+                        return *static_cast<Value const *>(data);
+                    if(&type == &any_value_of_<any_arg>::value)
+                    {
+                        std::size_t const index = static_cast<any_arg const *>(data)->index;
+                        if(index >= nargs)
+                            throw any_expr_error("too few arguments to evaluate any_expr");
+                        return args[index];
+                    }
+                    return any_convert_<Value>::call(type, data);
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_eval_op_
+                // Evaluates a node with tag Tag, as _eval would. Operators that can't be applied
+                // to Values throw. Context says how to get at a node's children and value; see
+                // any_eval_context_ below.
+                template<typename Context, typename Tag, typename Arity = typename Tag::proto_arity_type
+                  , typename Enable = void>
+                struct any_eval_op_
+                {
+                    using value_type = typename Context::value_type;
+                    using node_type = typename Context::node_type;
+
+                    static value_type call(Context const &, node_type)
+                    {
+                        throw any_expr_error("any_expr can't apply this operator to the requested type");
+                    }
+                };
+
+                template<typename Context, typename Tag, typename Arity>
+                struct any_eval_op_<Context, Tag, Arity, typename std::enable_if<Tag::proto_is_terminal_type::value>::type>
+                {
+                    using value_type = typename Context::value_type;
+                    using node_type = typename Context::node_type;
+
+                    static value_type call(Context const &ctx, node_type node)
+                    {
+                        return ctx.value(node);
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_eval_applies_
+                // Whether any_eval_op_ applies the operator Tag to Values. Some operators are
+                // skipped without being looked at, because applying them is a mistake or needs
+                // special handling: ~ on a bool is almost always a mistake, and the comma operator
+                // is handled below.
+                template<typename Tag, typename Value>
+                struct any_eval_skip_
+                  : std::false_type
+                {};
+
+                template<>
+                struct any_eval_skip_<complement, bool>
+                  : std::true_type
+                {};
+
+                template<typename Value>
+                struct any_eval_skip_<comma, Value>
+                  : std::true_type
+                {};
+
+                template<typename Tag, typename Value, typename Arity, typename Enable = void>
+                struct any_eval_compiles_
+                  : std::false_type
+                {};
+
+                template<typename Tag, typename Value>
+                struct any_eval_compiles_<
+                    Tag
+                  , Value
+                  , unary
+                  , typename std::enable_if<
+                        std::is_convertible<decltype(Tag()(std::declval<Value>())), Value>::value
+                    >::type
+                >
+                  : std::true_type
+                {};
+
+                template<typename Tag, typename Value>
+                struct any_eval_compiles_<
+                    Tag
+                  , Value
+                  , binary
+                  , typename std::enable_if<
+                        std::is_convertible<
+                            decltype(Tag()(std::declval<Value>(), std::declval<Value>()))
+                          , Value
+                        >::value
+                    >::type
+                >
+                  : std::true_type
+                {};
+
+                template<typename Tag, typename Value, typename Arity>
+                struct any_eval_applies_
+                  : utility::lazy_conditional<
+                        any_eval_skip_<Tag, Value>::value
+                      , std::false_type
+                      , any_eval_compiles_<Tag, Value, Arity>
+                    >
+                {};
+
+                template<typename Context, typename Tag>
+                struct any_eval_op_<
+                    Context
+                  , Tag
+                  , unary
+                  , typename std::enable_if<
+                        any_eval_applies_<Tag, typename Context::value_type, unary>::value
+                    >::type
+                >
+                {
+                    using value_type = typename Context::value_type;
+                    using node_type = typename Context::node_type;
+
+                    static value_type call(Context const &ctx, node_type node)
+                    {
+                        return Tag()(ctx.child(node, 0));
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_eval_result_
+                // Converts the result of a fold to what applying the operator would have given. &&
+                // and || yield a bool even when they stop at their first operand.
+                template<typename Tag>
+                struct any_eval_result_
+                {
+                    template<typename Value>
+                    static Value call(Value value)
+                    {
+                        return value;
+                    }
+                };
+
+                template<>
+                struct any_eval_result_<logical_and>
+                {
+                    template<typename Value>
+                    static Value call(Value const &value)
+                    {
+                        return Value(static_cast<bool>(value));
+                    }
+                };
+
+                template<>
+                struct any_eval_result_<logical_or>
+                  : any_eval_result_<logical_and>
+                {};
+
+                // Also evaluates runtime-arity nodes as a left fold, like nary_eval_.
+                template<typename Context, typename Tag>
+                struct any_eval_op_<
+                    Context
+                  , Tag
+                  , binary
+                  , typename std::enable_if<
+                        any_eval_applies_<Tag, typename Context::value_type, binary>::value
+                    >::type
+                >
+                {
+                    using value_type = typename Context::value_type;
+                    using node_type = typename Context::node_type;
+
+                    static value_type call(Context const &ctx, node_type node)
+                    {
+                        std::size_t const size = ctx.size(node);
+                        if(0 == size)
+                            return value_type();
+                        value_type result = ctx.child(node, 0);
+                        for(std::size_t i = 1; i != size; ++i)
+                        {
+                            if(nary_eval_done_<Tag>::call(result))
+                                break;
+                            result = Tag()(static_cast<value_type &&>(result), ctx.child(node, i));
+                        }
+                        return any_eval_result_<Tag>::call(static_cast<value_type &&>(result));
+                    }
+                };
+
+                // Evaluates and discards the left operand, without applying the comma operator
+                // to a Value with no side effects.
+                template<typename Context>
+                struct any_eval_op_<Context, comma, binary>
+                {
+                    using value_type = typename Context::value_type;
+                    using node_type = typename Context::node_type;
+
+                    static value_type call(Context const &ctx, node_type node)
+                    {
+                        ctx.child(node, 0);
+                        return ctx.child(node, 1);
+                    }
+                };
+
+                // Must respect short-circuit evaluation
+                template<typename Context>
+                struct any_eval_op_<
+                    Context
+                  , if_else_
+                  , ternary
+                  , typename std::enable_if<std::is_constructible<bool, typename Context::value_type>::value>::type
+                >
+                {
+                    using value_type = typename Context::value_type;
+                    using node_type = typename Context::node_type;
+
+                    static value_type call(Context const &ctx, node_type node)
+                    {
+                        return static_cast<bool>(ctx.child(node, 0))
+                          ? ctx.child(node, 1)
+                          : ctx.child(node, 2);
+                    }
+                };
+
+                template<typename Context>
+                typename Context::value_type any_eval_unknown_(Context const &, typename Context::node_type)
+                {
+                    throw any_expr_error("any_expr can't evaluate a node with this tag");
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_eval_table_
+                // The functions that evaluate each of Proto's tags, indexed by tag_id, for one
+                // domain and evaluation context. Built once, on first use.
+                template<typename Context>
+                using any_eval_fun_ =
+                    typename Context::value_type (*)(Context const &, typename Context::node_type);
+
+                template<typename Domain, typename Context>
+                struct any_eval_table_
+                {
+                    static any_eval_fun_<Context> const *get() noexcept
+                    {
+                        static any_eval_table_ const table;
+                        return table.funs_;
+                    }
+
+                private:
+                    any_eval_table_() noexcept
+                    {
+                        for(any_eval_fun_<Context> &fun : funs_)
+                            fun = &detail::any_eval_unknown_<Context>;
+                        this->set_(static_cast<any_operator_tags_ *>(nullptr));
+                    }
+
+                    template<typename ...Tags>
+                    void set_(utility::list<Tags...> *) noexcept
+                    {
+                        using expand = int[];
+                        (void)expand{0, (funs_[tag_id<Tags>::value] = &any_eval_op_<Context, Tags>::call, 0)...};
+                    }
+
+                    any_eval_fun_<Context> funs_[256];
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_eval_context_
+                template<typename Value>
+                struct any_eval_context_
+                {
+                    using value_type = Value;
+                    using node_type = any_node_ const *;
+
+                    any_eval_fun_<any_eval_context_> const *table_;
+                    Value const *args_;
+                    std::size_t nargs_;
+
+                    Value operator()(node_type node) const
+                    {
+                        return table_[node->tag_->id](*this, node);
+                    }
+
+                    std::size_t size(node_type node) const noexcept
+                    {
+                        return node->size_;
+                    }
+
+                    Value child(node_type node, std::size_t i) const
+                    {
+                        return (*this)(node->children()[i]);
+                    }
+
+                    Value value(node_type node) const
+                    {
+                        return detail::any_value_as_(*node->value_type_, node->data_, args_, nargs_);
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_display_
+                inline void any_display_(std::ostream &sout, any_node_ const &node, int depth, bool first)
+                {
+                    sout << std::setw(depth) << (first ? "" : ", ");
+                    node.tag_->write(sout);
+                    if(node.value_type_)
+                    {
+                        sout << "( ";
+                        node.value_type_->display(sout, node.data_);
+                        sout << " )\n";
+                    }
+                    else
+                    {
+                        sout << "(\n";
+                        for(std::size_t i = 0; i != node.size_; ++i)
+                            detail::any_display_(sout, *node.children()[i], depth + 4, 0 == i);
+                        sout << std::setw(depth) << "" << ")\n";
+                    }
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_wrap_
+                // Copies a static expression into a pool. A terminal that holds an any_expr
+                // becomes that any_expr's node.
+                template<typename Domain>
+                struct any_wrap_
+                {
+                    template<typename Expr, BOOST_PROTO_ENABLE_IF(is_terminal<Expr>::value)>
+                    static any_node_ const *call(any_expr_pool &pool, Expr const &e)
+                    {
+                        return any_wrap_::value_(pool, proto::v5::value(e));
+                    }
+
+                    template<typename Expr
+                      , BOOST_PROTO_ENABLE_IF(!is_terminal<Expr>::value && !is_nary<Expr>::value)>
+                    static any_node_ const *call(any_expr_pool &pool, Expr const &e)
+                    {
+                        return any_wrap_::children_(
+                            pool
+                          , e
+                          , utility::make_indices<result_of::arity_of<Expr>::value>()
+                        );
+                    }
+
+                    template<typename Expr, BOOST_PROTO_ENABLE_IF(is_nary<Expr>::value)>
+                    static any_node_ const *call(any_expr_pool &pool, Expr const &e)
+                    {
+                        using tag_type = typename result_of::tag_of<Expr>::type;
+                        std::size_t const size = proto::v5::children_of(e).size();
+                        any_node_ *node = pool.new_node_(any_tag_of_<tag_type>::value, size);
+                        any_node_ const **children = static_cast<any_node_ const **>(node->data_);
+                        for(std::size_t i = 0; i != size; ++i)
+                            children[i] = any_wrap_::call(pool, proto::v5::child(e, i));
+                        return node;
+                    }
+
+                private:
+                    template<typename Expr, std::size_t ...I>
+                    static any_node_ const *children_(any_expr_pool &pool, Expr const &e, utility::indices<I...>)
+                    {
+                        using tag_type = typename result_of::tag_of<Expr>::type;
+                        any_node_ *node = pool.new_node_(any_tag_of_<tag_type>::value, sizeof...(I));
+                        any_node_ const **children = static_cast<any_node_ const **>(node->data_);
+                        using expand = int[];
+                        (void)expand{0, (children[I] = any_wrap_::call(pool, proto::v5::child<I>(e)), 0)...};
+                        return node;
+                    }
+
+                    template<typename T>
+                    static any_node_ const *value_(any_expr_pool &pool, T const &t)
+                    {
+                        return pool.new_terminal_<typename std::decay<T>::type>(t);
+                    }
+
+                    static any_node_ const *value_(any_expr_pool &pool, exprs::any_expr<Domain> const &a)
+                    {
+                        if(a.pool_ != &pool)
+                            throw any_expr_error("any_expr belongs to a different pool");
+                        return a.node_;
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_result_
+                // The any_expr that an operator applied to these operands builds, if any. Static
+                // expressions have to be copied into a pool explicitly first.
+                template<typename T>
+                struct is_any_expr_
+                  : std::false_type
+                {};
+
+                template<typename Domain>
+                struct is_any_expr_<exprs::any_expr<Domain>>
+                  : std::true_type
+                {};
+
+                template<typename T>
+                struct is_any_operand_
+                  : std::integral_constant<bool, !std::is_void<T>::value && !is_any_expr_<T>::value && !is_expr<T>::value>
+                {};
+
+                template<typename A, typename B = void, typename Enable = void>
+                struct any_result_
+                {};
+
+                template<typename Domain>
+                struct any_result_<exprs::any_expr<Domain>, void>
+                {
+                    using type = exprs::any_expr<Domain>;
+                };
+
+                template<typename Domain>
+                struct any_result_<exprs::any_expr<Domain>, exprs::any_expr<Domain>>
+                {
+                    using type = exprs::any_expr<Domain>;
+                };
+
+                template<typename Domain, typename B>
+                struct any_result_<exprs::any_expr<Domain>, B, typename std::enable_if<is_any_operand_<B>::value>::type>
+                {
+                    using type = exprs::any_expr<Domain>;
+                };
+
+                template<typename A, typename Domain>
+                struct any_result_<A, exprs::any_expr<Domain>, typename std::enable_if<is_any_operand_<A>::value>::type>
+                {
+                    using type = exprs::any_expr<Domain>;
+                };
+
+                template<typename Domain, typename B>
+                any_expr_pool &any_pool_of_(exprs::any_expr<Domain> const &a, B const &)
+                {
+                    return a.pool();
+                }
+
+                template<typename A, typename Domain, BOOST_PROTO_ENABLE_IF(!is_any_expr_<A>::value)>
+                any_expr_pool &any_pool_of_(A const &, exprs::any_expr<Domain> const &b)
+                {
+                    return b.pool();
+                }
+            }
+
+            namespace exprs
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_expr
+                // A handle to a node in an any_expr_pool. It is cheap to copy, and is valid for as
+                // long as its pool is. Unlike a static expression, assigning to an any_expr
+                // rebinds the handle rather than building an assign node.
+                template<typename Domain>
+                struct any_expr
+                {
+                private:
+                    template<typename D>
+                    friend struct detail::any_wrap_;
+
+                    friend struct detail::any_access_;
+
+                    detail::any_node_ const *node_;
+                    any_expr_pool *pool_;
+
+                    any_expr(any_expr_pool &pool, detail::any_node_ const *node) noexcept
+                      : node_(node)
+                      , pool_(&pool)
+                    {}
+
+                    template<typename T, BOOST_PROTO_ENABLE_IF(detail::is_any_expr_<utility::uncvref<T>>::value)>
+                    static any_expr as_child_(any_expr_pool &, T && t)
+                    {
+                        return t;
+                    }
+
+                    template<typename T, BOOST_PROTO_ENABLE_IF(is_expr<T>::value)>
+                    static any_expr as_child_(any_expr_pool &pool, T && t)
+                    {
+                        return any_expr(pool, t);
+                    }
+
+                    template<typename T, BOOST_PROTO_ENABLE_IF(detail::is_any_operand_<utility::uncvref<T>>::value)>
+                    static any_expr as_child_(any_expr_pool &pool, T && t)
+                    {
+                        return any_expr::make_terminal(pool, static_cast<T &&>(t));
+                    }
+
+                    template<typename Iter>
+                    static any_expr make_(any_expr_pool &pool, detail::any_tag_ const &tag, Iter first, Iter last)
+                    {
+                        std::size_t const size = static_cast<std::size_t>(std::distance(first, last));
+                        if(!tag.arity(size) && !(tag.associative && size > 2))
+                            throw any_expr_error("wrong number of children for this tag");
+                        detail::any_node_ *node = pool.new_node_(tag, size);
+                        detail::any_node_ const **children = static_cast<detail::any_node_ const **>(node->data_);
+                        for(std::size_t i = 0; i != size; ++i, ++first)
+                        {
+                            any_expr const &child = *first;
+                            if(child.pool_ != &pool)
+                                throw any_expr_error("children of an any_expr must come from its pool");
+                            children[i] = child.node_;
+                        }
+                        return any_expr(pool, node);
+                    }
+
+                public:
+                    using domain_type = Domain;
+
+                    any_expr() noexcept
+                      : node_(nullptr)
+                      , pool_(nullptr)
+                    {}
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // Copies a static expression into pool.
+                    template<typename Expr, BOOST_PROTO_ENABLE_IF(is_expr<Expr>::value)>
+                    any_expr(any_expr_pool &pool, Expr const &e)
+                      : node_(detail::any_wrap_<Domain>::call(pool, e))
+                      , pool_(&pool)
+                    {}
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // make_terminal
+                    // A terminal holding a copy of t.
+                    template<typename T>
+                    static any_expr make_terminal(any_expr_pool &pool, T && t)
+                    {
+                        return any_expr(
+                            pool
+                          , pool.new_terminal_<typename std::decay<T>::type>(static_cast<T &&>(t))
+                        );
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // make_arg
+                    // A terminal that evaluates to the index-th argument of eval.
+                    static any_expr make_arg(any_expr_pool &pool, std::size_t index)
+                    {
+                        return any_expr::make_terminal(pool, any_arg{index});
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // make
+                    // A node with the given tag and children. Children that aren't any_exprs are
+                    // copied into pool first. Associative operators accept any number of
+                    // children greater than one.
+                    template<typename Tag, typename ...Children, BOOST_PROTO_ENABLE_IF(is_tag<Tag>::value)>
+                    static any_expr make(any_expr_pool &pool, Tag, Children &&... children)
+                    {
+                        static_assert(
+                            !Tag::proto_is_terminal_type::value
+                          , "Use any_expr::make_terminal to make terminals"
+                        );
+                        any_expr const tmp[] = {any_expr::as_child_(pool, static_cast<Children &&>(children))..., any_expr()};
+                        return any_expr::make_(pool, detail::any_tag_of_<Tag>::value, tmp, tmp + sizeof...(Children));
+                    }
+
+                    // With a tag given by its tag_id, e.g. one read from a configuration file.
+                    template<typename Iter>
+                    static any_expr make(any_expr_pool &pool, unsigned char id, Iter first, Iter last)
+                    {
+                        detail::any_tag_ const *tag = detail::any_builtin_tag_(id);
+                        if(!tag || v5::tag_id<v5::tags::terminal>::value == id)
+                            throw any_expr_error("not the tag_id of one of Proto's operators");
+                        return any_expr::make_(pool, *tag, first, last);
+                    }
+
+                    static any_expr make(any_expr_pool &pool, unsigned char id, std::initializer_list<any_expr> children)
+                    {
+                        return any_expr::make(pool, id, children.begin(), children.end());
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // accessors
+                    bool empty() const noexcept
+                    {
+                        return !node_;
+                    }
+
+                    any_expr_pool &pool() const noexcept
+                    {
+                        return *pool_;
+                    }
+
+                    unsigned char tag_id() const noexcept
+                    {
+                        return node_->tag_->id;
+                    }
+
+                    bool is_terminal() const noexcept
+                    {
+                        return nullptr != node_->value_type_;
+                    }
+
+                    // The number of children
+                    std::size_t size() const noexcept
+                    {
+                        return node_->size_;
+                    }
+
+                    any_expr child(std::size_t i) const noexcept
+                    {
+                        return any_expr(*pool_, node_->children()[i]);
+                    }
+
+                    // The type of a terminal's value
+                    std::type_info const &value_type() const noexcept
+                    {
+                        return node_->value_type_->type();
+                    }
+
+                    // A terminal's value, or null if it doesn't have type T
+                    template<typename T>
+                    T const *value_ptr() const noexcept
+                    {
+                        return node_->value_type_ && node_->value_type_->type() == typeid(T)
+                          ? static_cast<T const *>(node_->data_)
+                          : nullptr;
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // eval
+                    // Evaluates the expression as _eval would, with all values and
+                    // intermediate results of type Value. Terminals holding any_args evaluate
+                    // to the arguments.
+                    template<typename Value>
+                    Value eval_n(Value const *args, std::size_t nargs) const
+                    {
+                        using context_type = detail::any_eval_context_<Value>;
+                        context_type const ctx =
+                            {detail::any_eval_table_<Domain, context_type>::get(), args, nargs};
+                        return ctx(node_);
+                    }
+
+                    template<typename Value>
+                    Value eval() const
+                    {
+                        return this->eval_n<Value>(nullptr, 0);
+                    }
+
+                    template<typename Value, typename ...Args, BOOST_PROTO_ENABLE_IF(0 != sizeof...(Args))>
+                    Value eval(Args &&... args) const
+                    {
+                        Value const values[] = {static_cast<Value>(static_cast<Args &&>(args))...};
+                        return this->eval_n<Value>(values, sizeof...(Args));
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // operator[]
+                    template<typename U>
+                    any_expr operator[](U && u) const
+                    {
+                        return any_expr::make(*pool_, v5::tags::subscript(), *this, static_cast<U &&>(u));
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // operator()
+                    template<typename ...U>
+                    any_expr operator()(U &&... u) const
+                    {
+                        return any_expr::make(*pool_, v5::tags::function(), *this, static_cast<U &&>(u)...);
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // For display_expr
+                    friend void proto_display_expr(std::ostream &sout, any_expr const &e, int depth, bool first)
+                    {
+                        detail::any_display_(sout, *e.node_, depth, first);
+                    }
+                };
+
+            #define BOOST_PROTO_ANY_UNARY_OP(OP, TAG)                                               \
+                template<typename Arg                                                               \
+                  , typename Result = typename detail::any_result_<utility::uncvref<Arg>>::type>    \
+                inline Result operator OP(Arg &&arg)                                                \
+                {                                                                                   \
+                    return Result::make(arg.pool(), v5::tags::TAG(), static_cast<Arg &&>(arg)); \
+                }                                                                                   \
+                /**/
+
+            #define BOOST_PROTO_ANY_POSTFIX_OP(OP, TAG)                                             \
+                template<typename Arg                                                               \
+                  , typename Result = typename detail::any_result_<utility::uncvref<Arg>>::type>    \
+                inline Result operator OP(Arg &&arg, int)                                           \
+                {                                                                                   \
+                    return Result::make(arg.pool(), v5::tags::TAG(), static_cast<Arg &&>(arg)); \
+                }                                                                                   \
+                /**/
+
+            #define BOOST_PROTO_ANY_BINARY_OP(OP, TAG)                                              \
+                template<typename Left, typename Right                                              \
+                  , typename Result = typename detail::any_result_<                                 \
+                        utility::uncvref<Left>                                                      \
+                      , utility::uncvref<Right>                                                     \
+                    >::type>                                                                        \
+                inline Result operator OP(Left &&left, Right &&right)                               \
+                {                                                                                   \
+                    return Result::make(                                                            \
+                        detail::any_pool_of_(left, right)                                           \
+                      , v5::tags::TAG()                                                             \
+                      , static_cast<Left &&>(left)                                                  \
+                      , static_cast<Right &&>(right)                                                \
+                    );                                                                              \
+                }                                                                                   \
+                /**/
+
+                BOOST_PROTO_ANY_UNARY_OP(+, unary_plus)
+                BOOST_PROTO_ANY_UNARY_OP(-, negate)
+                BOOST_PROTO_ANY_UNARY_OP(*, dereference)
+                BOOST_PROTO_ANY_UNARY_OP(~, complement)
+                BOOST_PROTO_ANY_UNARY_OP(&, address_of)
+                BOOST_PROTO_ANY_UNARY_OP(!, logical_not)
+                BOOST_PROTO_ANY_UNARY_OP(++, pre_inc)
+                BOOST_PROTO_ANY_UNARY_OP(--, pre_dec)
+                BOOST_PROTO_ANY_POSTFIX_OP(++, post_inc)
+                BOOST_PROTO_ANY_POSTFIX_OP(--, post_dec)
+
+                BOOST_PROTO_ANY_BINARY_OP(<<, shift_left)
+                BOOST_PROTO_ANY_BINARY_OP(>>, shift_right)
+                BOOST_PROTO_ANY_BINARY_OP(*, multiplies)
+                BOOST_PROTO_ANY_BINARY_OP(/, divides)
+                BOOST_PROTO_ANY_BINARY_OP(%, modulus)
+                BOOST_PROTO_ANY_BINARY_OP(+, plus)
+                BOOST_PROTO_ANY_BINARY_OP(-, minus)
+                BOOST_PROTO_ANY_BINARY_OP(<, less)
+                BOOST_PROTO_ANY_BINARY_OP(>, greater)
+                BOOST_PROTO_ANY_BINARY_OP(<=, less_equal)
+                BOOST_PROTO_ANY_BINARY_OP(>=, greater_equal)
+                BOOST_PROTO_ANY_BINARY_OP(==, equal_to)
+                BOOST_PROTO_ANY_BINARY_OP(!=, not_equal_to)
+                BOOST_PROTO_ANY_BINARY_OP(||, logical_or)
+                BOOST_PROTO_ANY_BINARY_OP(&&, logical_and)
+                BOOST_PROTO_ANY_BINARY_OP(&, bitwise_and)
+                BOOST_PROTO_ANY_BINARY_OP(|, bitwise_or)
+                BOOST_PROTO_ANY_BINARY_OP(^, bitwise_xor)
+                BOOST_PROTO_ANY_BINARY_OP(BOOST_PP_COMMA(), comma)
+                BOOST_PROTO_ANY_BINARY_OP(->*, mem_ptr)
+                BOOST_PROTO_ANY_BINARY_OP(<<=, shift_left_assign)
+                BOOST_PROTO_ANY_BINARY_OP(>>=, shift_right_assign)
+                BOOST_PROTO_ANY_BINARY_OP(*=, multiplies_assign)
+                BOOST_PROTO_ANY_BINARY_OP(/=, divides_assign)
+                BOOST_PROTO_ANY_BINARY_OP(%=, modulus_assign)
+                BOOST_PROTO_ANY_BINARY_OP(+=, plus_assign)
+                BOOST_PROTO_ANY_BINARY_OP(-=, minus_assign)
+                BOOST_PROTO_ANY_BINARY_OP(&=, bitwise_and_assign)
+                BOOST_PROTO_ANY_BINARY_OP(|=, bitwise_or_assign)
+                BOOST_PROTO_ANY_BINARY_OP(^=, bitwise_xor_assign)
+
+            #undef BOOST_PROTO_ANY_UNARY_OP
+            #undef BOOST_PROTO_ANY_POSTFIX_OP
+            #undef BOOST_PROTO_ANY_BINARY_OP
+
+                // if_else, for the non-overloadable ternary conditional operator ?:
+                template<typename Domain, typename A1, typename A2>
+                inline any_expr<Domain> if_else(any_expr<Domain> const &a0, A1 &&a1, A2 &&a2)
+                {
+                    return any_expr<Domain>::make(
+                        a0.pool()
+                      , v5::tags::if_else_()
+                      , a0
+                      , static_cast<A1 &&>(a1)
+                      , static_cast<A2 &&>(a2)
+                    );
+                }
+            }
+
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // any_access_
+                // For other representations, like expr_dag, that walk any_exprs' nodes.
+                struct any_access_
+                {
+                    template<typename Domain>
+                    static any_node_ const *node(exprs::any_expr<Domain> const &e) noexcept
+                    {
+                        return e.node_;
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif
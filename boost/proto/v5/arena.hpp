@@ -0,0 +1,342 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// arena.hpp
+// A bump allocator that frees everything it has handed out in one go, and position-independent
+// arrays and strings that can live in it. See deep_copy_into in deep_copy.hpp.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_ARENA_HPP_INCLUDED
+#define BOOST_PROTO_V5_ARENA_HPP_INCLUDED
+
+#include <new>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // arena
+            // Hands out memory from large chunks by bumping a pointer. Nothing is freed until the
+            // arena is cleared or destroyed, and no destructors are run, so it should only hold
+            // trivially destructible objects.
+            struct arena
+            {
+            private:
+                struct chunk_
+                {
+                    chunk_ *next_;
+                    std::size_t size_;
+                };
+
+                chunk_ *head_;
+                char *pos_;
+                char *end_;
+                std::size_t chunk_size_;
+
+                void release_(chunk_ *chunk) noexcept
+                {
+                    while(chunk)
+                    {
+                        chunk_ *next = chunk->next_;
+                        ::operator delete(chunk);
+                        chunk = next;
+                    }
+                }
+
+                // The number of bytes from p to the next address aligned to align
+                static std::size_t padding_(char const *p, std::size_t align) noexcept
+                {
+                    std::uintptr_t const i = reinterpret_cast<std::uintptr_t>(p);
+                    return (align - i % align) % align;
+                }
+
+            public:
+                explicit arena(std::size_t chunk_size = 4096) noexcept
+                  : head_(nullptr)
+                  , pos_(nullptr)
+                  , end_(nullptr)
+                  , chunk_size_(chunk_size)
+                {}
+
+                arena(arena &&that) noexcept
+                  : head_(that.head_)
+                  , pos_(that.pos_)
+                  , end_(that.end_)
+                  , chunk_size_(that.chunk_size_)
+                {
+                    that.head_ = nullptr;
+                    that.pos_ = that.end_ = nullptr;
+                }
+
+                arena &operator=(arena &&that) noexcept
+                {
+                    if(this != &that)
+                    {
+                        this->release_(head_);
+                        head_ = that.head_;
+                        pos_ = that.pos_;
+                        end_ = that.end_;
+                        chunk_size_ = that.chunk_size_;
+                        that.head_ = nullptr;
+                        that.pos_ = that.end_ = nullptr;
+                    }
+                    return *this;
+                }
+
+                arena(arena const &) = delete;
+                arena &operator=(arena const &) = delete;
+
+                ~arena()
+                {
+                    this->release_(head_);
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////
+                // allocate
+                // Returns size contiguous bytes aligned to align, which must be a power of two.
+                void *allocate(std::size_t size, std::size_t align = alignof(std::max_align_t))
+                {
+                    // The padding can take pos_ past end_, so compare sizes rather than pointers
+                    std::size_t const room = pos_ ? static_cast<std::size_t>(end_ - pos_) : 0;
+                    std::size_t pad = pos_ ? arena::padding_(pos_, align) : 0;
+                    if(!pos_ || pad > room || size > room - pad)
+                    {
+                        std::size_t const header = sizeof(chunk_) + alignof(std::max_align_t);
+                        if(size > static_cast<std::size_t>(-1) - align - header)
+                            throw std::bad_alloc();
+                        std::size_t const bytes =
+                            (size + align > chunk_size_ ? size + align : chunk_size_) + header;
+                        chunk_ *chunk = static_cast<chunk_ *>(::operator new(bytes));
+                        chunk->next_ = head_;
+                        chunk->size_ = bytes;
+                        head_ = chunk;
+                        end_ = reinterpret_cast<char *>(chunk) + bytes;
+                        pos_ = reinterpret_cast<char *>(chunk + 1);
+                        pad = arena::padding_(pos_, align);
+                    }
+                    char *p = pos_ + pad;
+                    pos_ = p + size;
+                    return p;
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////
+                // clear
+                // Frees everything allocated so far at once. The most recent chunk is kept for
+                // reuse.
+                void clear() noexcept
+                {
+                    if(head_)
+                    {
+                        this->release_(head_->next_);
+                        head_->next_ = nullptr;
+                        pos_ = reinterpret_cast<char *>(head_ + 1);
+                    }
+                }
+            };
+
+            namespace detail
+            {
+                struct arena_array_access_;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // arena_array
+            // A read-only array that refers to its elements by their distance from the array
+            // object itself. An arena_array is trivially copyable, and a copy keeps that
+            // distance, so an object that contains both an arena_array and its elements can be
+            // moved to another address with memcpy and still be valid. A copy made anywhere else
+            // must be rebound to the elements.
+            template<typename T>
+            struct arena_array
+            {
+                static_assert(
+                    std::is_trivially_copyable<T>::value && alignof(T) <= alignof(std::max_align_t)
+                  , "arena_array can only hold trivially copyable objects with no special alignment"
+                );
+
+            private:
+                friend struct detail::arena_array_access_;
+
+                std::ptrdiff_t offset_;
+                std::size_t size_;
+
+                std::ptrdiff_t offset_to_(T const *data) const noexcept
+                {
+                    return data
+                      ? static_cast<std::ptrdiff_t>(
+                            reinterpret_cast<std::uintptr_t>(data) - reinterpret_cast<std::uintptr_t>(this)
+                        )
+                      : 0;
+                }
+
+            public:
+                using value_type        = T;
+                using size_type         = std::size_t;
+                using const_reference   = T const &;
+                using const_iterator    = T const *;
+
+                constexpr arena_array() noexcept
+                  : offset_(0)
+                  , size_(0)
+                {}
+
+                // data should point into storage that will be moved around along with *this.
+                arena_array(T const *data, std::size_t size) noexcept
+                  : offset_(this->offset_to_(data))
+                  , size_(size)
+                {}
+
+                ////////////////////////////////////////////////////////////////////////////////
+                // rebind
+                // Refers to the elements of that, wherever this array is.
+                void rebind(arena_array const &that) noexcept
+                {
+                    this->rebind(that.data(), that.size_);
+                }
+
+                void rebind(T const *data, std::size_t size) noexcept
+                {
+                    offset_ = this->offset_to_(data);
+                    size_ = size;
+                }
+
+                T const *data() const noexcept
+                {
+                    return offset_
+                      ? reinterpret_cast<T const *>(reinterpret_cast<std::uintptr_t>(this) + offset_)
+                      : nullptr;
+                }
+
+                std::size_t size() const noexcept
+                {
+                    return size_;
+                }
+
+                bool empty() const noexcept
+                {
+                    return 0 == size_;
+                }
+
+                T const *begin() const noexcept
+                {
+                    return this->data();
+                }
+
+                T const *end() const noexcept
+                {
+                    return this->data() + size_;
+                }
+
+                T const &operator[](std::size_t i) const noexcept
+                {
+                    return this->data()[i];
+                }
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // basic_arena_string
+            // An arena_array of characters followed by a null terminator.
+            template<typename Char, typename Traits = std::char_traits<Char>>
+            struct basic_arena_string
+              : arena_array<Char>
+            {
+                using traits_type = Traits;
+
+                constexpr basic_arena_string() noexcept
+                  : arena_array<Char>()
+                {}
+
+                basic_arena_string(Char const *data, std::size_t size) noexcept
+                  : arena_array<Char>(data, size)
+                {}
+
+                Char const *c_str() const noexcept
+                {
+                    static constexpr Char empty {};
+                    return this->data() ? this->data() : &empty;
+                }
+
+                template<typename Alloc = std::allocator<Char>>
+                std::basic_string<Char, Traits, Alloc> str() const
+                {
+                    return std::basic_string<Char, Traits, Alloc>(this->c_str(), this->size());
+                }
+
+                int compare(Char const *that, std::size_t size) const noexcept
+                {
+                    std::size_t const n = this->size() < size ? this->size() : size;
+                    int const result = Traits::compare(this->c_str(), that, n);
+                    return 0 != result ? result : this->size() < size ? -1 : this->size() > size;
+                }
+
+                friend bool operator==(basic_arena_string const &lhs, basic_arena_string const &rhs) noexcept
+                {
+                    return 0 == lhs.compare(rhs.c_str(), rhs.size());
+                }
+
+                friend bool operator!=(basic_arena_string const &lhs, basic_arena_string const &rhs) noexcept
+                {
+                    return !(lhs == rhs);
+                }
+
+                template<typename Alloc>
+                friend bool operator==(basic_arena_string const &lhs, std::basic_string<Char, Traits, Alloc> const &rhs) noexcept
+                {
+                    return 0 == lhs.compare(rhs.data(), rhs.size());
+                }
+
+                template<typename Alloc>
+                friend bool operator==(std::basic_string<Char, Traits, Alloc> const &lhs, basic_arena_string const &rhs) noexcept
+                {
+                    return rhs == lhs;
+                }
+
+                template<typename Alloc>
+                friend bool operator!=(basic_arena_string const &lhs, std::basic_string<Char, Traits, Alloc> const &rhs) noexcept
+                {
+                    return !(lhs == rhs);
+                }
+
+                template<typename Alloc>
+                friend bool operator!=(std::basic_string<Char, Traits, Alloc> const &lhs, basic_arena_string const &rhs) noexcept
+                {
+                    return !(rhs == lhs);
+                }
+
+                friend bool operator==(basic_arena_string const &lhs, Char const *rhs) noexcept
+                {
+                    return 0 == lhs.compare(rhs, Traits::length(rhs));
+                }
+
+                friend bool operator==(Char const *lhs, basic_arena_string const &rhs) noexcept
+                {
+                    return rhs == lhs;
+                }
+
+                friend bool operator!=(basic_arena_string const &lhs, Char const *rhs) noexcept
+                {
+                    return !(lhs == rhs);
+                }
+
+                friend bool operator!=(Char const *lhs, basic_arena_string const &rhs) noexcept
+                {
+                    return !(rhs == lhs);
+                }
+            };
+
+            using arena_string = basic_arena_string<char>;
+            using arena_wstring = basic_arena_string<wchar_t>;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,508 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// bytecode.hpp
+// A compiler from expressions to a register-based bytecode, and its interpreter, for expressions
+// that are built at runtime and evaluated many times, such as filters over a large number of
+// records. Programs compute values of a single type, Value, with the arithmetic, comparison,
+// bitwise and logical operators of tags.hpp and the conditional operator. Their inputs are the
+// terminals holding any_args; other terminals are copied into the program as constants when it is
+// compiled. Expressions are compiled by way of their expr_dag, so a subexpression that occurs
+// several times is computed once.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_BYTECODE_HPP_INCLUDED
+#define BOOST_PROTO_V5_BYTECODE_HPP_INCLUDED
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/any_expr.hpp>
+#include <boost/proto/v5/dag.hpp>
+#include <boost/proto/v5/tags.hpp>
+
+// The operators with an instruction of their own
+#define BOOST_PROTO_BYTECODE_UNARY_OPS(M)                                                           \
+    M(unary_plus) M(negate) M(complement) M(logical_not)                                            \
+    /**/
+
+#define BOOST_PROTO_BYTECODE_BINARY_OPS(M)                                                          \
+    M(shift_left) M(shift_right) M(multiplies) M(divides) M(modulus) M(plus) M(minus) M(less)      \
+    M(greater) M(less_equal) M(greater_equal) M(equal_to) M(not_equal_to) M(logical_or)            \
+    M(logical_and) M(bitwise_and) M(bitwise_or) M(bitwise_xor) M(comma)                             \
+    /**/
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // bytecode_instruction
+            // code is the tag_id of an operator, whose operands are in registers a and b, or one
+            // of the bytecode_code values below. The result goes in register dst.
+            struct bytecode_instruction
+            {
+                unsigned char code;
+                std::uint32_t dst;
+                std::uint32_t a;
+                std::uint32_t b;
+            };
+
+            enum bytecode_code : unsigned char
+            {
+                bytecode_const = 64,    // dst = constant a
+                bytecode_arg,           // dst = input a
+                bytecode_move,          // dst = a
+                bytecode_jump,          // go to instruction a
+                bytecode_jump_if,       // if a, go to instruction b
+                bytecode_jump_unless,   // unless a, go to instruction b
+                bytecode_return,        // return a
+                bytecode_bool           // dst = a, as a bool
+            };
+
+            namespace detail
+            {
+                template<typename Tag, typename Value, typename Enable = void>
+                struct bytecode_apply_
+                {
+                    static constexpr bool supported = false;
+
+                    template<typename ...Args>
+                    static Value call(Args const &...)
+                    {
+                        throw any_expr_error("bytecode can't apply this operator to the requested type");
+                    }
+                };
+
+                template<typename Tag, typename Value>
+                struct bytecode_apply_<
+                    Tag
+                  , Value
+                  , typename std::enable_if<
+                        any_eval_applies_<Tag, Value, v5::tags::unary>::value
+                    >::type
+                >
+                {
+                    static constexpr bool supported = true;
+
+                    static Value call(Value const &a)
+                    {
+                        return Tag()(a);
+                    }
+                };
+
+                template<typename Tag, typename Value>
+                struct bytecode_apply_<
+                    Tag
+                  , Value
+                  , typename std::enable_if<
+                        any_eval_applies_<Tag, Value, v5::tags::binary>::value
+                    >::type
+                >
+                {
+                    static constexpr bool supported = true;
+
+                    static Value call(Value const &a, Value const &b)
+                    {
+                        return Tag()(a, b);
+                    }
+                };
+
+                // Both operands are already in registers, so the comma operator only has to
+                // yield the right one.
+                template<typename Value>
+                struct bytecode_apply_<v5::tags::comma, Value>
+                {
+                    static constexpr bool supported = true;
+
+                    static Value call(Value const &, Value const &b)
+                    {
+                        return b;
+                    }
+                };
+
+                template<typename Value, BOOST_PROTO_ENABLE_IF(std::is_constructible<bool, Value>::value)>
+                inline bool bytecode_test_(Value const &value)
+                {
+                    return static_cast<bool>(value);
+                }
+
+                template<typename Value, BOOST_PROTO_ENABLE_IF(!std::is_constructible<bool, Value>::value)>
+                inline bool bytecode_test_(Value const &)
+                {
+                    throw any_expr_error("bytecode can't test a value of the requested type");
+                }
+
+                template<typename Value
+                  , BOOST_PROTO_ENABLE_IF(
+                        std::is_constructible<bool, Value>::value && std::is_constructible<Value, bool>::value
+                    )>
+                inline Value bytecode_bool_(Value const &value)
+                {
+                    return Value(static_cast<bool>(value));
+                }
+
+                template<typename Value
+                  , BOOST_PROTO_ENABLE_IF(
+                        !(std::is_constructible<bool, Value>::value && std::is_constructible<Value, bool>::value)
+                    )>
+                inline Value bytecode_bool_(Value const &)
+                {
+                    throw any_expr_error("bytecode can't convert a value of the requested type to bool");
+                }
+
+                template<typename Value>
+                struct bytecode_compiler_;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // bytecode
+            // A compiled program. It is immutable once compiled, and can be run by several threads
+            // at once, each with its own registers.
+            template<typename Value>
+            struct bytecode
+            {
+                bytecode() noexcept
+                  : arity_(0)
+                  , registers_(0)
+                {}
+
+                // The number of inputs of each run, that is, one more than the largest any_arg
+                // index in the expression
+                std::size_t arity() const noexcept
+                {
+                    return arity_;
+                }
+
+                // The number of registers a run needs
+                std::size_t registers() const noexcept
+                {
+                    return registers_;
+                }
+
+                std::vector<bytecode_instruction> const &code() const noexcept
+                {
+                    return code_;
+                }
+
+                std::vector<Value> const &constants() const noexcept
+                {
+                    return constants_;
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // run
+                // Runs the program on arity() inputs, using registers() registers as scratch.
+                Value run(Value const *args, Value *regs) const
+                {
+                    bytecode_instruction const *const code = code_.data();
+                    Value const *const constants = constants_.data();
+                    for(std::size_t ip = 0;;)
+                    {
+                        bytecode_instruction const &i = code[ip++];
+                        switch(i.code)
+                        {
+                        case bytecode_const:
+                            regs[i.dst] = constants[i.a];
+                            break;
+                        case bytecode_arg:
+                            regs[i.dst] = args[i.a];
+                            break;
+                        case bytecode_move:
+                            regs[i.dst] = regs[i.a];
+                            break;
+                        case bytecode_jump:
+                            ip = i.a;
+                            break;
+                        case bytecode_jump_if:
+                            if(detail::bytecode_test_(regs[i.a]))
+                                ip = i.b;
+                            break;
+                        case bytecode_jump_unless:
+                            if(!detail::bytecode_test_(regs[i.a]))
+                                ip = i.b;
+                            break;
+                        case bytecode_return:
+                            return regs[i.a];
+                        case bytecode_bool:
+                            regs[i.dst] = detail::bytecode_bool_(regs[i.a]);
+                            break;
+
+                    #define BOOST_PROTO_BYTECODE_UNARY_CASE(TAG)                                    \
+                        case v5::tag_id<v5::tags::TAG>::value:                                      \
+                            regs[i.dst] = detail::bytecode_apply_<v5::tags::TAG, Value>::call(      \
+                                regs[i.a]                                                           \
+                            );                                                                      \
+                            break;                                                                  \
+                        /**/
+
+                    #define BOOST_PROTO_BYTECODE_BINARY_CASE(TAG)                                   \
+                        case v5::tag_id<v5::tags::TAG>::value:                                      \
+                            regs[i.dst] = detail::bytecode_apply_<v5::tags::TAG, Value>::call(      \
+                                regs[i.a]                                                           \
+                              , regs[i.b]                                                           \
+                            );                                                                      \
+                            break;                                                                  \
+                        /**/
+
+                        BOOST_PROTO_BYTECODE_UNARY_OPS(BOOST_PROTO_BYTECODE_UNARY_CASE)
+                        BOOST_PROTO_BYTECODE_BINARY_OPS(BOOST_PROTO_BYTECODE_BINARY_CASE)
+
+                    #undef BOOST_PROTO_BYTECODE_UNARY_CASE
+                    #undef BOOST_PROTO_BYTECODE_BINARY_CASE
+
+                        default:
+                            throw any_expr_error("invalid bytecode instruction");
+                        }
+                    }
+                }
+
+                Value run(Value const *args) const
+                {
+                    std::vector<Value> regs(registers_);
+                    return this->run(args, regs.data());
+                }
+
+                template<typename ...Args>
+                Value operator()(Args const &... args) const
+                {
+                    Value const values[] = {static_cast<Value>(args)..., Value()};
+                    return this->run(values);
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // run_batch
+                // Runs the program once for each of count records of arity() consecutive inputs,
+                // and writes the results to out.
+                void run_batch(Value const *inputs, std::size_t count, Value *out) const
+                {
+                    std::vector<Value> regs(registers_);
+                    for(std::size_t n = 0; n != count; ++n, inputs += arity_)
+                        out[n] = this->run(inputs, regs.data());
+                }
+
+            private:
+                friend struct detail::bytecode_compiler_<Value>;
+
+                std::vector<bytecode_instruction> code_;
+                std::vector<Value> constants_;
+                std::size_t arity_;
+                std::size_t registers_;
+            };
+
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // bytecode_compiler_
+                // Compiles the nodes of an expr_dag depth first, once each. A node first computed
+                // in a branch of &&, || or ?: is forgotten when the branch is left, since it might
+                // not have been computed.
+                template<typename Value>
+                struct bytecode_compiler_
+                {
+                    using node_id = expr_dag::node_id;
+
+                    bytecode_compiler_(expr_dag const &dag, bytecode<Value> &prog)
+                      : dag_(dag)
+                      , prog_(prog)
+                      , regs_(dag.size(), node_id(expr_dag::npos))
+                      , unary_()
+                      , binary_()
+                    {
+                    #define BOOST_PROTO_BYTECODE_UNARY_SUPPORTED(TAG)                               \
+                        unary_[v5::tag_id<v5::tags::TAG>::value] =                                  \
+                            bytecode_apply_<v5::tags::TAG, Value>::supported;                       \
+                        /**/
+
+                    #define BOOST_PROTO_BYTECODE_BINARY_SUPPORTED(TAG)                              \
+                        binary_[v5::tag_id<v5::tags::TAG>::value] =                                 \
+                            bytecode_apply_<v5::tags::TAG, Value>::supported;                       \
+                        /**/
+
+                        BOOST_PROTO_BYTECODE_UNARY_OPS(BOOST_PROTO_BYTECODE_UNARY_SUPPORTED)
+                        BOOST_PROTO_BYTECODE_BINARY_OPS(BOOST_PROTO_BYTECODE_BINARY_SUPPORTED)
+
+                    #undef BOOST_PROTO_BYTECODE_UNARY_SUPPORTED
+                    #undef BOOST_PROTO_BYTECODE_BINARY_SUPPORTED
+                    }
+
+                    void compile(node_id root)
+                    {
+                        std::uint32_t const result = this->node_(root);
+                        this->emit_(bytecode_return, 0, result);
+                    }
+
+                private:
+                    std::uint32_t reg_() noexcept
+                    {
+                        return static_cast<std::uint32_t>(prog_.registers_++);
+                    }
+
+                    std::size_t emit_(unsigned char code, std::uint32_t dst, std::uint32_t a, std::uint32_t b = 0)
+                    {
+                        prog_.code_.push_back(bytecode_instruction{code, dst, a, b});
+                        return prog_.code_.size() - 1;
+                    }
+
+                    std::uint32_t here_() const noexcept
+                    {
+                        return static_cast<std::uint32_t>(prog_.code_.size());
+                    }
+
+                    // Compiles a node that might not be evaluated
+                    std::uint32_t branch_(node_id id)
+                    {
+                        std::size_t const mark = done_.size();
+                        std::uint32_t const result = this->node_(id);
+                        for(std::size_t i = mark; i != done_.size(); ++i)
+                            regs_[done_[i]] = expr_dag::npos;
+                        done_.resize(mark);
+                        return result;
+                    }
+
+                    std::uint32_t node_(node_id id)
+                    {
+                        if(expr_dag::npos != regs_[id])
+                            return regs_[id];
+                        std::uint32_t const result = this->compute_(id);
+                        regs_[id] = result;
+                        done_.push_back(id);
+                        return result;
+                    }
+
+                    std::uint32_t compute_(node_id id)
+                    {
+                        unsigned char const tag = dag_.tag_id(id);
+                        expr_dag_children const children = dag_.children(id);
+                        std::uint32_t const dst = this->reg_();
+
+                        if(dag_.is_terminal(id))
+                        {
+                            if(any_arg const *arg = dag_.value_ptr<any_arg>(id))
+                            {
+                                if(prog_.arity_ <= arg->index)
+                                    prog_.arity_ = arg->index + 1;
+                                this->emit_(bytecode_arg, dst, static_cast<std::uint32_t>(arg->index));
+                            }
+                            else
+                            {
+                                prog_.constants_.push_back(dag_.value_as<Value>(id));
+                                this->emit_(bytecode_const, dst, static_cast<std::uint32_t>(prog_.constants_.size() - 1));
+                            }
+                        }
+                        else if(tag_id<if_else_>::value == tag)
+                        {
+                            this->check_test_();
+                            std::uint32_t const cond = this->node_(children[0]);
+                            std::size_t const to_else = this->emit_(bytecode_jump_unless, 0, cond);
+                            this->emit_(bytecode_move, dst, this->branch_(children[1]));
+                            std::size_t const to_end = this->emit_(bytecode_jump, 0, 0);
+                            prog_.code_[to_else].b = this->here_();
+                            this->emit_(bytecode_move, dst, this->branch_(children[2]));
+                            prog_.code_[to_end].a = this->here_();
+                        }
+                        else if(0 == children.size() && binary_[tag])
+                        {
+                            prog_.constants_.push_back(Value());
+                            this->emit_(bytecode_const, dst, static_cast<std::uint32_t>(prog_.constants_.size() - 1));
+                        }
+                        else if(1 == children.size() && unary_[tag])
+                        {
+                            this->emit_(tag, dst, this->node_(children[0]));
+                        }
+                        else if(binary_[tag])
+                        {
+                            // A left fold, stopping early for && and ||, like nary_eval_
+                            bool const is_and = tag_id<logical_and>::value == tag;
+                            bool const is_or = tag_id<logical_or>::value == tag;
+                            std::vector<std::size_t> to_end;
+                            if(is_and || is_or)
+                                this->check_test_();
+                            std::uint32_t left = this->node_(children[0]);
+                            if(is_and || is_or || 1 == children.size())
+                            {
+                                // The result, if the rest is skipped. && and || yield a bool.
+                                this->emit_(is_and || is_or ? bytecode_bool : bytecode_move, dst, left);
+                                left = dst;
+                            }
+                            for(std::size_t i = 1; i != children.size(); ++i, left = dst)
+                            {
+                                if(is_and || is_or)
+                                {
+                                    to_end.push_back(this->emit_(is_and ? bytecode_jump_unless : bytecode_jump_if, 0, left));
+                                    this->emit_(tag, dst, left, this->branch_(children[i]));
+                                }
+                                else
+                                {
+                                    this->emit_(tag, dst, left, this->node_(children[i]));
+                                }
+                            }
+                            for(std::size_t jump : to_end)
+                                prog_.code_[jump].b = this->here_();
+                        }
+                        else
+                        {
+                            throw any_expr_error("bytecode can't apply this operator to the requested type");
+                        }
+                        return dst;
+                    }
+
+                    void check_test_() const
+                    {
+                        if(!std::is_constructible<bool, Value>::value)
+                            throw any_expr_error("bytecode can't test a value of the requested type");
+                    }
+
+                    expr_dag const &dag_;
+                    bytecode<Value> &prog_;
+                    std::vector<std::uint32_t> regs_;   // The register holding each node's value
+                    std::vector<node_id> done_;         // The nodes compiled so far, in order
+                    bool unary_[256];
+                    bool binary_[256];
+                };
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // compile
+            // Compiles the expression rooted at a node of an expr_dag, an any_expr or a static
+            // expression into a program computing a Value. Throws any_expr_error if one of the
+            // operators can't be applied to Values.
+            template<typename Value>
+            bytecode<Value> compile(expr_dag const &dag, expr_dag::node_id root)
+            {
+                bytecode<Value> prog;
+                detail::bytecode_compiler_<Value>(dag, prog).compile(root);
+                return prog;
+            }
+
+            template<typename Value>
+            bytecode<Value> compile(expr_dag const &dag)
+            {
+                return proto::v5::compile<Value>(dag, dag.root());
+            }
+
+            template<typename Value, typename Domain>
+            bytecode<Value> compile(any_expr<Domain> const &e)
+            {
+                return proto::v5::compile<Value>(proto::v5::lower(e));
+            }
+
+            template<typename Value, typename E, BOOST_PROTO_ENABLE_IF(is_expr<E>::value)>
+            bytecode<Value> compile(E const &e)
+            {
+                return proto::v5::compile<Value>(proto::v5::lower(e));
+            }
+        }
+    }
+}
+
+#undef BOOST_PROTO_BYTECODE_UNARY_OPS
+#undef BOOST_PROTO_BYTECODE_BINARY_OPS
+
+#endif
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// cache.hpp
+// A bounded cache of the results of evaluating expressions, for expressions that are evaluated
+// again and again with the same terminal values. Results are looked up by the structural hash of
+// the expression and the values of the extra arguments passed to the action, and the least
+// recently used result is forgotten when the cache is full. Only expressions from domains that
+// define cache_results as std::true_type are cached; others are simply evaluated.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_CACHE_HPP_INCLUDED
+#define BOOST_PROTO_V5_CACHE_HPP_INCLUDED
+
+#include <list>
+#include <iterator>
+#include <tuple>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/deep_copy.hpp>
+#include <boost/proto/v5/domain.hpp>
+#include <boost/proto/v5/hash.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/action/eval.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // caches_results
+            // Whether result_cache remembers the results of evaluating expressions of type Expr.
+            template<typename Expr>
+            struct caches_results
+              : std::integral_constant<
+                    bool
+                  , result_of::domain_of<Expr>::type::cache_results::value
+                >
+            {};
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // result_cache
+            // Evaluates expressions of type Expr, or of any type with the same shape, with Action
+            // and the extra arguments Args, and remembers up to capacity() results. Keys are
+            // copies of the expressions with all their terminals held by value, so a cached
+            // result is found again only while the values the expression refers to are unchanged.
+            // The arguments must be copyable, equality comparable and hashable with value_hash.
+            // A result_cache is not safe to use from several threads at once.
+            template<typename Expr, typename Result, typename Action = _eval, typename ...Args>
+            struct result_cache
+            {
+                using key_type = utility::uncvref<decltype(proto::v5::deep_copy(std::declval<Expr const &>()))>;
+                using result_type = Result;
+
+                explicit result_cache(std::size_t capacity = 1024)
+                  : capacity_(capacity)
+                  , hits_(0)
+                  , misses_(0)
+                {}
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // operator()
+                // The cached result of Action()(e, args...), computed on a miss.
+                template<typename E
+                  , BOOST_PROTO_ENABLE_IF(caches_results<E>::value)>
+                Result operator()(E const &e, Args const &... args)
+                {
+                    std::size_t const hash = result_cache::hash_(e, args...);
+                    auto const range = index_.equal_range(hash);
+                    for(auto it = range.first; it != range.second; ++it)
+                    {
+                        entry_ &entry = *it->second;
+                        if(expr_equal_to<>()(entry.expr, e) && std::tuple<Args const &...>(args...) == entry.args)
+                        {
+                            ++hits_;
+                            entries_.splice(entries_.begin(), entries_, it->second);
+                            return entry.result;
+                        }
+                    }
+
+                    ++misses_;
+                    Result result = Action()(e, args...);
+                    if(0 != capacity_)
+                    {
+                        entries_.push_front(entry_{hash, proto::v5::deep_copy(e), std::tuple<Args...>(args...), result});
+                        index_.emplace(hash, entries_.begin());
+                        this->shrink_(capacity_);
+                    }
+                    return result;
+                }
+
+                template<typename E
+                  , BOOST_PROTO_ENABLE_IF(!caches_results<E>::value)>
+                Result operator()(E const &e, Args const &... args) const
+                {
+                    return Action()(e, args...);
+                }
+
+                std::size_t size() const noexcept
+                {
+                    return entries_.size();
+                }
+
+                std::size_t capacity() const noexcept
+                {
+                    return capacity_;
+                }
+
+                // Forgets the least recently used results that no longer fit.
+                void capacity(std::size_t capacity)
+                {
+                    capacity_ = capacity;
+                    this->shrink_(capacity_);
+                }
+
+                // The number of evaluations answered from the cache, and of the others.
+                std::size_t hits() const noexcept
+                {
+                    return hits_;
+                }
+
+                std::size_t misses() const noexcept
+                {
+                    return misses_;
+                }
+
+                void reset_counters() noexcept
+                {
+                    hits_ = 0;
+                    misses_ = 0;
+                }
+
+                void clear() noexcept
+                {
+                    index_.clear();
+                    entries_.clear();
+                }
+
+            private:
+                struct entry_
+                {
+                    std::size_t hash;
+                    key_type expr;
+                    std::tuple<Args...> args;
+                    Result result;
+                };
+
+                using iterator_ = typename std::list<entry_>::iterator;
+
+                template<typename E>
+                static std::size_t hash_(E const &e, Args const &... args)
+                {
+                    std::size_t const hashes[] = {proto::v5::hash_value(e), value_hash<Args>()(args)...};
+                    std::size_t seed = 0;
+                    for(std::size_t h : hashes)
+                        seed = detail::hash_combine_(seed, h);
+                    return seed;
+                }
+
+                void shrink_(std::size_t size)
+                {
+                    while(entries_.size() > size)
+                    {
+                        iterator_ const last = std::prev(entries_.end());
+                        auto const range = index_.equal_range(last->hash);
+                        for(auto it = range.first; it != range.second; ++it)
+                        {
+                            if(it->second == last)
+                            {
+                                index_.erase(it);
+                                break;
+                            }
+                        }
+                        entries_.erase(last);
+                    }
+                }
+
+                std::list<entry_> entries_;     // Most recently used first
+                std::unordered_multimap<std::size_t, iterator_> index_;
+                std::size_t capacity_;
+                std::size_t hits_;
+                std::size_t misses_;
+            };
+        }
+    }
+}
+
+#endif
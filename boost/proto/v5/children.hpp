@@ -67,6 +67,359 @@ namespace boost
                         )
                     )
                 };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // is_packable_child_
+                // Empty children that are trivial and can be derived from take up no storage;
+                // they are stored as (empty) base classes rather than as data members.
+                template<typename T>
+                struct is_packable_child_
+                  : std::integral_constant<
+                        bool
+                      , std::is_empty<T>::value &&
+                        std::is_trivial<T>::value &&
+                        !std::is_const<T>::value &&
+                        !std::is_volatile<T>::value &&
+                        !__is_final(T)
+                    >
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // packed_child_
+                // An empty child stored as a base. The index keeps two children of the same type
+                // from being the same base class.
+                template<std::size_t I, typename T>
+                struct packed_child_
+                  : private T
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(packed_child_);
+
+                    template<typename U>
+                    explicit constexpr packed_child_(U && u) noexcept(noexcept(T(static_cast<U &&>(u))))
+                      : T(static_cast<U &&>(u))
+                    {}
+
+                    T & get() & noexcept
+                    {
+                        return *this;
+                    }
+
+                    constexpr T const & get() const & noexcept
+                    {
+                        return *this;
+                    }
+
+                    constexpr T && get() const && noexcept
+                    {
+                        return const_cast<packed_child_ &&>(*this);
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // packed_children_
+                // Storage for children in which the empty ones take no space. The children are
+                // laid out as a chain in which each link either stores its child as a base
+                // (packable children), or as a data member. The rest of the chain is a base when
+                // it has no data members, so all the data live in a single class whenever
+                // possible, and as a data member otherwise.
+                enum packed_children_kind_
+                {
+                    packed_end_
+                  , packed_head_base_
+                  , packed_head_member_tail_base_
+                  , packed_head_member_tail_member_
+                };
+
+                template<typename ...T>
+                struct packed_children_kind_of_
+                  : std::integral_constant<packed_children_kind_, packed_end_>
+                {};
+
+                template<typename Head, typename ...Tail>
+                struct packed_children_kind_of_<Head, Tail...>
+                  : std::integral_constant<
+                        packed_children_kind_
+                      , is_packable_child_<Head>::value
+                          ? packed_head_base_
+                          : utility::and_<is_packable_child_<Tail>...>::value
+                          ? packed_head_member_tail_base_
+                          : packed_head_member_tail_member_
+                    >
+                {};
+
+                template<std::size_t I, packed_children_kind_ Kind, typename ...T>
+                struct packed_children_impl_;
+
+                template<std::size_t I, typename ...T>
+                using packed_children_ =
+                    packed_children_impl_<I, packed_children_kind_of_<T...>::value, T...>;
+
+                template<std::size_t I>
+                struct packed_children_impl_<I, packed_end_>
+                {};
+
+                template<std::size_t I, typename Head, typename ...Tail>
+                struct packed_children_impl_<I, packed_head_base_, Head, Tail...>
+                  : packed_child_<I, Head>
+                  , packed_children_<I + 1, Tail...>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(packed_children_impl_);
+
+                    template<typename U, typename ...Us>
+                    explicit constexpr packed_children_impl_(U && u, Us &&... us)
+                        noexcept(
+                            noexcept(packed_child_<I, Head>(static_cast<U &&>(u))) &&
+                            noexcept(packed_children_<I + 1, Tail...>(static_cast<Us &&>(us)...))
+                        )
+                      : packed_child_<I, Head>(static_cast<U &&>(u))
+                      , packed_children_<I + 1, Tail...>(static_cast<Us &&>(us)...)
+                    {}
+
+                    static Head & head(packed_children_impl_ & that) noexcept
+                    {
+                        return static_cast<packed_child_<I, Head> &>(that).get();
+                    }
+
+                    static constexpr Head const & head(packed_children_impl_ const & that) noexcept
+                    {
+                        return static_cast<packed_child_<I, Head> const &>(that).get();
+                    }
+
+                    static constexpr Head && head(packed_children_impl_ && that) noexcept
+                    {
+                        return static_cast<packed_child_<I, Head> &&>(that).get();
+                    }
+
+                    static packed_children_<I + 1, Tail...> & tail(packed_children_impl_ & that) noexcept
+                    {
+                        return that;
+                    }
+
+                    static constexpr packed_children_<I + 1, Tail...> const & tail(packed_children_impl_ const & that) noexcept
+                    {
+                        return that;
+                    }
+
+                    static constexpr packed_children_<I + 1, Tail...> && tail(packed_children_impl_ && that) noexcept
+                    {
+                        return static_cast<packed_children_<I + 1, Tail...> &&>(that);
+                    }
+                };
+
+                // The last link has no tail at all. An empty base to end the chain would be the
+                // same type in every chain of the same length, and so could not share an address
+                // with the end of a nested chain.
+                template<std::size_t I, typename Head>
+                struct packed_children_impl_<I, packed_head_base_, Head>
+                  : packed_child_<I, Head>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(packed_children_impl_);
+
+                    template<typename U>
+                    explicit constexpr packed_children_impl_(U && u)
+                        noexcept(noexcept(packed_child_<I, Head>(static_cast<U &&>(u))))
+                      : packed_child_<I, Head>(static_cast<U &&>(u))
+                    {}
+
+                    static Head & head(packed_children_impl_ & that) noexcept
+                    {
+                        return static_cast<packed_child_<I, Head> &>(that).get();
+                    }
+
+                    static constexpr Head const & head(packed_children_impl_ const & that) noexcept
+                    {
+                        return static_cast<packed_child_<I, Head> const &>(that).get();
+                    }
+
+                    static constexpr Head && head(packed_children_impl_ && that) noexcept
+                    {
+                        return static_cast<packed_child_<I, Head> &&>(that).get();
+                    }
+                };
+
+                template<std::size_t I, typename Head>
+                struct packed_children_impl_<I, packed_head_member_tail_base_, Head>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(packed_children_impl_);
+                    Head proto_head_;
+
+                    template<typename U>
+                    explicit constexpr packed_children_impl_(U && u)
+                        noexcept(noexcept(Head(static_cast<U &&>(u))))
+                      : proto_head_(static_cast<U &&>(u))
+                    {}
+
+                    template<typename This>
+                    static constexpr auto head(This && that)
+                    BOOST_PROTO_AUTO_RETURN(
+                        /*extra parens are significant!*/
+                        (static_cast<This &&>(that).proto_head_)
+                    )
+                };
+
+                template<std::size_t I, typename Head, typename ...Tail>
+                struct packed_children_impl_<I, packed_head_member_tail_base_, Head, Tail...>
+                  : packed_children_<I + 1, Tail...>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(packed_children_impl_);
+                    Head proto_head_;
+
+                    template<typename U, typename ...Us>
+                    explicit constexpr packed_children_impl_(U && u, Us &&... us)
+                        noexcept(
+                            noexcept(Head(static_cast<U &&>(u))) &&
+                            noexcept(packed_children_<I + 1, Tail...>(static_cast<Us &&>(us)...))
+                        )
+                      : packed_children_<I + 1, Tail...>(static_cast<Us &&>(us)...)
+                      , proto_head_(static_cast<U &&>(u))
+                    {}
+
+                    template<typename This>
+                    static constexpr auto head(This && that)
+                    BOOST_PROTO_AUTO_RETURN(
+                        /*extra parens are significant!*/
+                        (static_cast<This &&>(that).proto_head_)
+                    )
+
+                    static packed_children_<I + 1, Tail...> & tail(packed_children_impl_ & that) noexcept
+                    {
+                        return that;
+                    }
+
+                    static constexpr packed_children_<I + 1, Tail...> const & tail(packed_children_impl_ const & that) noexcept
+                    {
+                        return that;
+                    }
+
+                    static constexpr packed_children_<I + 1, Tail...> && tail(packed_children_impl_ && that) noexcept
+                    {
+                        return static_cast<packed_children_<I + 1, Tail...> &&>(that);
+                    }
+                };
+
+                template<std::size_t I, typename Head, typename ...Tail>
+                struct packed_children_impl_<I, packed_head_member_tail_member_, Head, Tail...>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(packed_children_impl_);
+                    Head proto_head_;
+                    packed_children_<I + 1, Tail...> proto_tail_;
+
+                    template<typename U, typename ...Us>
+                    explicit constexpr packed_children_impl_(U && u, Us &&... us)
+                        noexcept(
+                            noexcept(Head(static_cast<U &&>(u))) &&
+                            noexcept(packed_children_<I + 1, Tail...>(static_cast<Us &&>(us)...))
+                        )
+                      : proto_head_(static_cast<U &&>(u))
+                      , proto_tail_(static_cast<Us &&>(us)...)
+                    {}
+
+                    template<typename This>
+                    static constexpr auto head(This && that)
+                    BOOST_PROTO_AUTO_RETURN(
+                        /*extra parens are significant!*/
+                        (static_cast<This &&>(that).proto_head_)
+                    )
+
+                    template<typename This>
+                    static constexpr auto tail(This && that)
+                    BOOST_PROTO_AUTO_RETURN(
+                        (static_cast<This &&>(that).proto_tail_)
+                    )
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // packed_child_impl_
+                // Like child_impl_, but for children held in packed_children_ storage.
+                struct packed_child_impl_
+                {
+                    template<typename Packed>
+                    static inline constexpr auto child(
+                        Packed &&that
+                      , std::integral_constant<std::size_t, 0>
+                    )
+                    BOOST_PROTO_AUTO_RETURN(
+                        utility::uncvref<Packed>::head(static_cast<Packed &&>(that))
+                    )
+
+                    template<typename Packed, std::size_t I, typename Impl = packed_child_impl_
+                      , BOOST_PROTO_ENABLE_IF(I != 0)>
+                    static inline constexpr auto child(
+                        Packed &&that
+                      , std::integral_constant<std::size_t, I>
+                    )
+                    BOOST_PROTO_AUTO_RETURN(
+                        Impl::child(
+                            utility::uncvref<Packed>::tail(static_cast<Packed &&>(that))
+                          , std::integral_constant<std::size_t, I - 1>()
+                        )
+                    )
+                };
+
+                template<packed_children_kind_ Kind, typename ...T>
+                std::true_type is_packed_children_test_(packed_children_impl_<0, Kind, T...> const *);
+
+                std::false_type is_packed_children_test_(void const *);
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // child_access_
+                // Picks the right way to get at the children of a children<> object, depending on
+                // how they are stored.
+                template<typename Children>
+                using child_access_ =
+                    typename std::conditional<
+                        decltype(detail::is_packed_children_test_(
+                            static_cast<utility::uncvref<Children> const *>(nullptr)
+                        ))::value
+                      , packed_child_impl_
+                      , child_impl_
+                    >::type;
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // children_members_
+                // Storage for children in which every child is a named data member.
+                template<typename ...T>
+                struct children_members_;
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // children_storage_
+                // Use packed storage only when it pays off, and only when it doesn't cost the
+                // children their standard layout-ness.
+                // An empty class takes up no space when it is used as a base.
+                template<typename Storage>
+                struct children_footprint_
+                  : std::integral_constant<
+                        std::size_t
+                      , std::is_empty<Storage>::value ? 0 : sizeof(Storage)
+                    >
+                {};
+
+                template<bool Packable, typename ...T>
+                struct children_storage_impl_
+                {
+                    using type = children_members_<T...>;
+                };
+
+                template<typename ...T>
+                struct children_storage_impl_<true, T...>
+                {
+                    using members_type = children_members_<T...>;
+                    using packed_type = packed_children_<0, T...>;
+
+                    using type =
+                        typename std::conditional<
+                            children_footprint_<packed_type>::value <
+                                children_footprint_<members_type>::value &&
+                            (std::is_standard_layout<packed_type>::value ||
+                             !std::is_standard_layout<members_type>::value)
+                          , packed_type
+                          , members_type
+                        >::type;
+                };
+
+                template<typename ...T>
+                using children_storage_ =
+                    typename children_storage_impl_<utility::or_<is_packable_child_<T>...>::value, T...>::type;
             }
 
             namespace exprs
@@ -96,26 +449,80 @@ namespace boost
                 };
 
                 #define INIT(Z, N, D) proto_child ## N(static_cast< U ## N && >( u ## N ))
-                #define MEMBERS(Z, N, D) using proto_child_type ## N = T ## N; T ## N proto_child ## N;
+                #define FORWARD(Z, N, D) static_cast< U ## N && >( u ## N )
+                #define TYPES(Z, N, D) using proto_child_type ## N = T ## N;
+                #define MEMBERS(Z, N, D) T ## N proto_child ## N;
                 #define NOEXCEPT(Z, N, D) noexcept(T ## N(static_cast< U ## N && >( u ## N ))) &&
-                #define EQUAL_TO(Z, N, D) static_cast<bool>(proto_child ## N == that. proto_child ## N) &&
-                #define INVOKE(Z, N, D) f(D.proto_child ## N);
+                #define EQUAL_TO(Z, N, D) static_cast<bool>(exprs::get<N>(static_cast<This const &>(*this)) == exprs::get<N>(that)) &&
+                #define INVOKE(Z, N, D) f(exprs::get<N>(D));
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // get
+                template<std::size_t I, typename ...T>
+                inline constexpr auto get(children<T...> &a)
+                BOOST_PROTO_AUTO_RETURN(
+                    detail::child_access_<children<T...>>::child(a, std::integral_constant<std::size_t, I>())
+                )
+
+                template<std::size_t I, typename ...T>
+                inline constexpr auto get(children<T...> const &a)
+                BOOST_PROTO_AUTO_RETURN(
+                    detail::child_access_<children<T...>>::child(a, std::integral_constant<std::size_t, I>())
+                )
+
+                template<std::size_t I, typename ...T>
+                inline constexpr auto get(children<T...> &&a)
+                BOOST_PROTO_AUTO_RETURN(
+                    detail::child_access_<children<T...>>::child(
+                        static_cast<children<T...> &&>(a)
+                      , std::integral_constant<std::size_t, I>()
+                    )
+                )
+            }
+
+            namespace detail
+            {
+                #define BOOST_PP_LOCAL_MACRO(N)                                                     \
+                template<BOOST_PP_ENUM_PARAMS(N, typename T)>                                       \
+                struct children_members_<BOOST_PP_ENUM_PARAMS(N, T)>                                \
+                {                                                                                   \
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(children_members_);                           \
+                    BOOST_PP_REPEAT(N, MEMBERS, ~)                                                  \
+                                                                                                    \
+                    template<BOOST_PP_ENUM_PARAMS(N, typename U)>                                   \
+                    explicit constexpr children_members_(BOOST_PP_ENUM_BINARY_PARAMS(N, U, &&u))    \
+                        noexcept(BOOST_PP_REPEAT(N, NOEXCEPT, ~) true)                              \
+                      : BOOST_PP_ENUM(N, INIT, ~)                                                   \
+                    {}                                                                              \
+                };                                                                                  \
+                /**/
+
+                #define BOOST_PP_LOCAL_LIMITS (1, BOOST_PROTO_ARGS_UNROLL_MAX)
+                #include BOOST_PP_LOCAL_ITERATE()
+            }
 
+            namespace exprs
+            {
+                // Empty children are packed away so that they take up no space. See
+                // detail::children_storage_.
                 #define BOOST_PP_LOCAL_MACRO(N)                                                     \
                 template<BOOST_PP_ENUM_PARAMS(N, typename T)>                                       \
                 struct children<BOOST_PP_ENUM_PARAMS(N, T)>                                         \
+                  : detail::children_storage_<BOOST_PP_ENUM_PARAMS(N, T)>                           \
                 {                                                                                   \
                     BOOST_PROTO_REGULAR_TRIVIAL_CLASS(children);                                    \
                     using proto_size = std::integral_constant<std::size_t, N>;                      \
-                    BOOST_PP_REPEAT(N, MEMBERS, ~)                                                  \
+                    BOOST_PP_REPEAT(N, TYPES, ~)                                                    \
                                                                                                     \
                     template<BOOST_PP_ENUM_PARAMS(N, typename U) DISABLE_COPY_IF(children, N, U0)>  \
                     explicit constexpr children(BOOST_PP_ENUM_BINARY_PARAMS(N, U, &&u))             \
                         noexcept(BOOST_PP_REPEAT(N, NOEXCEPT, ~) true)                              \
-                      : BOOST_PP_ENUM(N, INIT, ~)                                                   \
+                      : detail::children_storage_<BOOST_PP_ENUM_PARAMS(N, T)>(                      \
+                            BOOST_PP_ENUM(N, FORWARD, ~)                                            \
+                        )                                                                           \
                     {}                                                                              \
                                                                                                     \
-                    template<BOOST_PP_ENUM_PARAMS(N, typename U)>                                   \
+                    template<BOOST_PP_ENUM_PARAMS(N, typename U), typename This = children>         \
                     inline auto operator==(children<BOOST_PP_ENUM_PARAMS(N, U)> const &that) const  \
                     BOOST_PROTO_AUTO_RETURN(                                                        \
                         BOOST_PP_REPEAT(N, EQUAL_TO, ~) true                                        \
@@ -165,6 +572,7 @@ namespace boost
                 {
                     BOOST_PROTO_REGULAR_TRIVIAL_CLASS(children);
                     using proto_size = std::integral_constant<std::size_t, BOOST_PROTO_ARGS_UNROLL_MAX + sizeof...(Tail)>;
+                    BOOST_PP_REPEAT(BOOST_PROTO_ARGS_UNROLL_MAX, TYPES, ~)
                     BOOST_PP_REPEAT(BOOST_PROTO_ARGS_UNROLL_MAX, MEMBERS, ~)
                     using proto_children_tail_type = children<Tail...>;
                     children<Tail...> proto_children_tail;
@@ -182,7 +590,7 @@ namespace boost
                       , proto_children_tail(static_cast<Rest &&>(rest)...) // std::forward is NOT constexpr!
                     {}
 
-                    template<BOOST_PP_ENUM_PARAMS(BOOST_PROTO_ARGS_UNROLL_MAX, typename U), typename ...Rest>
+                    template<BOOST_PP_ENUM_PARAMS(BOOST_PROTO_ARGS_UNROLL_MAX, typename U), typename ...Rest, typename This = children>
                     inline auto operator==(children<BOOST_PP_ENUM_PARAMS(BOOST_PROTO_ARGS_UNROLL_MAX, U), Rest...> const &that) const
                     BOOST_PROTO_AUTO_RETURN(
                         BOOST_PP_REPEAT(BOOST_PROTO_ARGS_UNROLL_MAX, EQUAL_TO, ~) proto_children_tail == that.proto_children_tail
@@ -266,35 +674,14 @@ namespace boost
                 }
 
                 #undef INIT
+                #undef FORWARD
+                #undef TYPES
                 #undef MEMBERS
                 #undef NOEXCEPT
                 #undef EQUAL_TO
                 #undef INVOKE
                 #undef DISABLE_COPY_IF
 
-                ////////////////////////////////////////////////////////////////////////////////////
-                // get
-                template<std::size_t I, typename ...T>
-                inline constexpr auto get(children<T...> &a)
-                BOOST_PROTO_AUTO_RETURN(
-                    detail::child_impl_::child(a, std::integral_constant<std::size_t, I>())
-                )
-
-                template<std::size_t I, typename ...T>
-                inline constexpr auto get(children<T...> const &a)
-                BOOST_PROTO_AUTO_RETURN(
-                    detail::child_impl_::child(a, std::integral_constant<std::size_t, I>())
-                )
-
-                template<std::size_t I, typename ...T>
-                inline constexpr auto get(children<T...> &&a)
-                BOOST_PROTO_AUTO_RETURN(
-                    detail::child_impl_::child(
-                        static_cast<children<T...> &&>(a)
-                      , std::integral_constant<std::size_t, I>()
-                    )
-                )
-
                 ////////////////////////////////////////////////////////////////////////////////////
                 // make_args
                 template<typename ...T>
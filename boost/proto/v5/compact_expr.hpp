@@ -0,0 +1,463 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// compact_expr.hpp
+// An alternate representation of an expression in which the shape of the tree lives only in its
+// type, and the values of all its terminals are stored side by side in a single children<>
+// object.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_COMPACT_EXPR_HPP_INCLUDED
+#define BOOST_PROTO_V5_COMPACT_EXPR_HPP_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/children.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/accessors.hpp>
+#include <boost/proto/v5/utility.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact_shape_
+                // What the type of an expression says about its terminals: how many there are
+                // and the types of their values, in preorder. Since a compact expression keeps
+                // nothing but the terminals' values, all the tags must be stateless.
+                template<
+                    typename Expr
+                  , typename ExprDesc = typename Expr::proto_expr_descriptor_type
+                  , bool IsTerminal = Expr::proto_is_terminal_type::value
+                >
+                struct compact_shape_;
+
+                template<typename Expr, typename Tag, typename Value>
+                struct compact_shape_<Expr, Tag(Value), true>
+                {
+                    static_assert(
+                        is_stateless_<Tag>::value
+                      , "compact_expr requires the tags of all nodes to be empty and trivial"
+                    );
+                    using values_type = utility::list<Value>;
+                    static constexpr std::size_t size = 1;
+                };
+
+                template<typename Expr, typename Tag, typename ...Children>
+                struct compact_shape_<Expr, Tag(Children...), false>
+                {
+                    static_assert(
+                        is_stateless_<Tag>::value
+                      , "compact_expr requires the tags of all nodes to be empty and trivial"
+                    );
+                    using values_type =
+                        typename utility::concat<
+                            typename compact_shape_<utility::uncvref<Children>>::values_type...
+                        >::type;
+                    static constexpr std::size_t size =
+                        utility::size_ops::sum(compact_shape_<utility::uncvref<Children>>::size...);
+                };
+
+                template<typename Values>
+                struct compact_values_;
+
+                template<typename ...Values>
+                struct compact_values_<utility::list<Values...>>
+                {
+                    using type = exprs::children<Values...>;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact_child_
+                // The type of the Ith child of Expr, and the position of its first terminal among
+                // the terminals of Expr.
+                template<typename Expr, std::size_t I>
+                using compact_child_ =
+                    utility::uncvref<
+                        typename exprs::children_element<I, typename Expr::proto_children_type>::type
+                    >;
+
+                template<typename Expr, std::size_t I>
+                struct compact_child_offset_
+                  : std::integral_constant<
+                        std::size_t
+                      , compact_child_offset_<Expr, I - 1>::value +
+                        compact_shape_<compact_child_<Expr, I - 1>>::size
+                    >
+                {};
+
+                template<typename Expr>
+                struct compact_child_offset_<Expr, 0>
+                  : std::integral_constant<std::size_t, 0>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact_find_
+                // Which child holds the Kth terminal, and where is it among that child's
+                // terminals?
+                template<typename Expr, std::size_t K, std::size_t I = 0
+                  , bool Found = (K < compact_child_offset_<Expr, I + 1>::value)>
+                struct compact_find_
+                  : compact_find_<Expr, K, I + 1>
+                {};
+
+                template<typename Expr, std::size_t K, std::size_t I>
+                struct compact_find_<Expr, K, I, true>
+                {
+                    static constexpr std::size_t index = I;
+                    static constexpr std::size_t offset = K - compact_child_offset_<Expr, I>::value;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact_value_
+                // Fetch the value of the Kth terminal of an expression.
+                struct compact_value_
+                {
+                    template<std::size_t K, typename E
+                      , BOOST_PROTO_ENABLE_IF(utility::uncvref<E>::proto_is_terminal_type::value)>
+                    static constexpr auto get(E && e)
+                    BOOST_PROTO_AUTO_RETURN(
+                        proto::v5::value(static_cast<E &&>(e))
+                    )
+
+                    template<std::size_t K, typename E
+                      , BOOST_PROTO_ENABLE_IF(!utility::uncvref<E>::proto_is_terminal_type::value)
+                      , typename Find = compact_find_<utility::uncvref<E>, K>
+                      , typename Impl = compact_value_>
+                    static constexpr auto get(E && e)
+                    BOOST_PROTO_AUTO_RETURN(
+                        Impl::template get<Find::offset>(
+                            proto::v5::child<Find::index>(static_cast<E &&>(e))
+                        )
+                    )
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact_expand_
+                // Rebuild a tree of Expr's shape whose terminals refer to the values stored in a
+                // compact expression.
+                struct compact_expand_
+                {
+                    template<typename Expr, std::size_t Offset, typename Values
+                      , BOOST_PROTO_ENABLE_IF(Expr::proto_is_terminal_type::value)>
+                    static constexpr auto call(Values &values)
+                    BOOST_PROTO_AUTO_RETURN(
+                        typename Expr::proto_domain_type::make_expr()(
+                            typename Expr::proto_tag_type()
+                          , exprs::get<Offset>(values)
+                        )
+                    )
+
+                    template<typename Expr, std::size_t Offset, typename Values, std::size_t ...I
+                      , typename Impl = compact_expand_>
+                    static constexpr auto call_(Values &values, utility::indices<I...>)
+                    BOOST_PROTO_AUTO_RETURN(
+                        typename Expr::proto_domain_type::make_expr()(
+                            typename Expr::proto_tag_type()
+                          , Impl::template call<
+                                compact_child_<Expr, I>
+                              , Offset + compact_child_offset_<Expr, I>::value
+                            >(values)...
+                        )
+                    )
+
+                    template<typename Expr, std::size_t Offset, typename Values
+                      , BOOST_PROTO_ENABLE_IF(!Expr::proto_is_terminal_type::value)
+                      , typename Impl = compact_expand_>
+                    static constexpr auto call(Values &values)
+                    BOOST_PROTO_AUTO_RETURN(
+                        Impl::template call_<Expr, Offset>(
+                            values
+                          , utility::make_indices<Expr::proto_size::value>()
+                        )
+                    )
+                };
+            }
+
+            namespace exprs
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact_expr
+                // Holds the values of all the terminals of an expression of type Expr, in
+                // preorder, in one children<> object. The tags and the shape of the tree are
+                // not stored at all; they are recovered from Expr. That makes copying and
+                // comparing the expression as cheap as copying and comparing its terminals.
+                template<typename Expr>
+                struct compact_expr
+                {
+                    static_assert(is_expr<Expr>::value, "compact_expr requires an expression type");
+                    static_assert(
+                        std::is_same<Expr, utility::uncvref<Expr>>::value
+                      , "compact_expr requires an unqualified expression type"
+                    );
+
+                    using proto_expr_type       = Expr;
+                    using proto_tag_type        = typename Expr::proto_tag_type;
+                    using proto_domain_type     = typename Expr::proto_domain_type;
+                    using proto_values_type     =
+                        typename detail::compact_values_<
+                            typename detail::compact_shape_<Expr>::values_type
+                        >::type;
+
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(compact_expr);
+
+                    explicit constexpr compact_expr(proto_values_type values)
+                        noexcept(noexcept(proto_values_type(static_cast<proto_values_type &&>(values))))
+                      : proto_values_(static_cast<proto_values_type &&>(values))
+                    {}
+
+                    proto_values_type proto_values_;
+                };
+
+                template<typename A, typename B>
+                inline constexpr auto operator==(compact_expr<A> const &a, compact_expr<B> const &b)
+                BOOST_PROTO_AUTO_RETURN(
+                    a.proto_values_ == b.proto_values_
+                )
+
+                template<typename A, typename B>
+                inline constexpr auto operator!=(compact_expr<A> const &a, compact_expr<B> const &b)
+                BOOST_PROTO_AUTO_RETURN(
+                    a.proto_values_ != b.proto_values_
+                )
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact_ref
+                // A reference to the subtree of shape Expr whose terminals start at position
+                // Offset in a compact expression's values.
+                template<typename Expr, std::size_t Offset, typename Values>
+                struct compact_ref
+                {
+                    using proto_expr_type       = Expr;
+                    using proto_tag_type        = typename Expr::proto_tag_type;
+                    using proto_domain_type     = typename Expr::proto_domain_type;
+                    using proto_offset          = std::integral_constant<std::size_t, Offset>;
+
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(compact_ref);
+
+                    explicit constexpr compact_ref(Values &values) noexcept
+                      : proto_values_(std::addressof(values))
+                    {}
+
+                    Values *proto_values_;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // child
+                template<std::size_t I, typename Expr, std::size_t Offset, typename Values>
+                inline constexpr auto child(compact_ref<Expr, Offset, Values> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    compact_ref<
+                        detail::compact_child_<Expr, I>
+                      , Offset + detail::compact_child_offset_<Expr, I>::value
+                      , Values
+                    >(*e.proto_values_)
+                )
+
+                template<std::size_t I, typename Expr>
+                inline constexpr auto child(compact_expr<Expr> &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<I>(
+                        compact_ref<Expr, 0, typename compact_expr<Expr>::proto_values_type>(
+                            e.proto_values_
+                        )
+                    )
+                )
+
+                template<std::size_t I, typename Expr>
+                inline constexpr auto child(compact_expr<Expr> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<I>(
+                        compact_ref<Expr, 0, typename compact_expr<Expr>::proto_values_type const>(
+                            e.proto_values_
+                        )
+                    )
+                )
+
+                // A compact_ref into a temporary would dangle.
+                template<std::size_t I, typename Expr>
+                void child(compact_expr<Expr> &&e) = delete;
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // left
+                template<typename Expr, std::size_t Offset, typename Values>
+                inline constexpr auto left(compact_ref<Expr, Offset, Values> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<0>(e)
+                )
+
+                template<typename Expr>
+                inline constexpr auto left(compact_expr<Expr> &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<0>(e)
+                )
+
+                template<typename Expr>
+                inline constexpr auto left(compact_expr<Expr> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<0>(e)
+                )
+
+                template<typename Expr>
+                void left(compact_expr<Expr> &&e) = delete;
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // right
+                template<typename Expr, std::size_t Offset, typename Values>
+                inline constexpr auto right(compact_ref<Expr, Offset, Values> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<1>(e)
+                )
+
+                template<typename Expr>
+                inline constexpr auto right(compact_expr<Expr> &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<1>(e)
+                )
+
+                template<typename Expr>
+                inline constexpr auto right(compact_expr<Expr> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<1>(e)
+                )
+
+                template<typename Expr>
+                void right(compact_expr<Expr> &&e) = delete;
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // value
+                template<typename Expr, std::size_t Offset, typename Values
+                  , BOOST_PROTO_ENABLE_IF(Expr::proto_is_terminal_type::value)>
+                inline constexpr auto value(compact_ref<Expr, Offset, Values> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::get<Offset>(*e.proto_values_)
+                )
+
+                template<typename Expr, BOOST_PROTO_ENABLE_IF(Expr::proto_is_terminal_type::value)>
+                inline constexpr auto value(compact_expr<Expr> &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::get<0>(e.proto_values_)
+                )
+
+                template<typename Expr, BOOST_PROTO_ENABLE_IF(Expr::proto_is_terminal_type::value)>
+                inline constexpr auto value(compact_expr<Expr> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::get<0>(e.proto_values_)
+                )
+
+                template<typename Expr, BOOST_PROTO_ENABLE_IF(Expr::proto_is_terminal_type::value)>
+                inline constexpr auto value(compact_expr<Expr> &&e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::get<0>(static_cast<compact_expr<Expr> &&>(e).proto_values_)
+                )
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // tag_of
+                // Tags aren't stored, so they are returned by value.
+                template<typename Expr, std::size_t Offset, typename Values>
+                inline constexpr typename Expr::proto_tag_type tag_of(compact_ref<Expr, Offset, Values> const &)
+                {
+                    return typename Expr::proto_tag_type();
+                }
+
+                template<typename Expr>
+                inline constexpr typename Expr::proto_tag_type tag_of(compact_expr<Expr> const &)
+                {
+                    return typename Expr::proto_tag_type();
+                }
+            }
+
+            using exprs::compact_expr;
+            using exprs::child;
+            using exprs::left;
+            using exprs::right;
+            using exprs::value;
+            using exprs::tag_of;
+
+            namespace detail
+            {
+                template<typename Expr, typename E, std::size_t ...K>
+                constexpr auto compact_(E && e, utility::indices<K...>)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::compact_expr<Expr>(
+                        typename exprs::compact_expr<Expr>::proto_values_type(
+                            compact_value_::get<K>(static_cast<E &&>(e))...
+                        )
+                    )
+                )
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // compact
+            // Gathers the values of all the terminals of an expression into a compact_expr.
+            // Terminals that hold references still hold references.
+            template<typename E, BOOST_PROTO_ENABLE_IF(is_expr<E>::value)>
+            constexpr auto compact(E && e)
+            BOOST_PROTO_AUTO_RETURN(
+                detail::compact_<utility::uncvref<E>>(
+                    static_cast<E &&>(e)
+                  , utility::make_indices<detail::compact_shape_<utility::uncvref<E>>::size>()
+                )
+            )
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // expand
+            // Builds an ordinary expression of the same shape as a compact_expr, whose terminals
+            // refer to the values stored in the compact_expr. Any action can then be applied to
+            // the result, so long as the compact_expr outlives it.
+            template<typename Expr>
+            constexpr auto expand(compact_expr<Expr> &e)
+            BOOST_PROTO_AUTO_RETURN(
+                detail::compact_expand_::call<Expr, 0>(e.proto_values_)
+            )
+
+            template<typename Expr>
+            constexpr auto expand(compact_expr<Expr> const &e)
+            BOOST_PROTO_AUTO_RETURN(
+                detail::compact_expand_::call<Expr, 0>(e.proto_values_)
+            )
+
+            template<typename Expr>
+            void expand(compact_expr<Expr> &&e) = delete;
+
+            namespace functional
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // compact
+                // A UnaryPolymorphicFunction that gathers the values of all the terminals of an
+                // expression into a compact_expr.
+                struct compact
+                {
+                    template<typename E>
+                    constexpr auto operator()(E && e) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        proto::v5::compact(static_cast<E &&>(e))
+                    )
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // expand
+                // A UnaryPolymorphicFunction that turns a compact_expr back into an ordinary
+                // expression that refers to the compact_expr's values.
+                struct expand
+                {
+                    template<typename E>
+                    constexpr auto operator()(E && e) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        proto::v5::expand(static_cast<E &&>(e))
+                    )
+                };
+            }
+        }
+    }
+}
+
+#endif
@@ -11,7 +11,9 @@
 #define BOOST_PROTO_V5_CORE_HPP_INCLUDED
 
 #include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/arena.hpp>
 #include <boost/proto/v5/children.hpp>
+#include <boost/proto/v5/compact_expr.hpp>
 #include <boost/proto/v5/custom.hpp>
 #include <boost/proto/v5/def.hpp>
 #include <boost/proto/v5/domain.hpp>
@@ -22,9 +24,12 @@
 #include <boost/proto/v5/literals.hpp>
 #include <boost/proto/v5/make_expr.hpp>
 #include <boost/proto/v5/matches.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
+#include <boost/proto/v5/serialize.hpp>
 #include <boost/proto/v5/operators.hpp>
 #include <boost/proto/v5/placeholders.hpp>
 #include <boost/proto/v5/tags.hpp>
+#include <boost/proto/v5/tuple.hpp>
 #include <boost/proto/v5/unpack_expr.hpp>
 #include <boost/proto/v5/utility.hpp>
 #include <boost/proto/v5/virtual_member.hpp>
@@ -0,0 +1,598 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// dag.hpp
+// Contains definition of the _lower action, which turns an expression into an expr_dag: a flat
+// runtime representation that ordinary algorithms can walk, for cost estimation, common
+// subexpression detection and the like. Nodes are numbered, and record their tag by its tag_id and
+// their children as a span of node ids. Identical subtrees share one node. Terminals refer to the
+// values in the lowered expression, which must outlive the expr_dag.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_DAG_HPP_INCLUDED
+#define BOOST_PROTO_V5_DAG_HPP_INCLUDED
+
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <functional>
+#include <typeinfo>
+#include <type_traits>
+#include <unordered_map>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/any_expr.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
+#include <boost/proto/v5/tags.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/action/basic_action.hpp>
+#include <boost/proto/v5/action/switch.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // expr_dag_node
+            struct expr_dag_node
+            {
+                unsigned char tag;      // The tag's tag_id
+                std::uint32_t first;    // The index of the first child, or the terminal's slot
+                std::uint32_t size;     // The number of children; 0 for terminals
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // expr_dag_children
+            // The ids of a node's children.
+            struct expr_dag_children
+            {
+                std::uint32_t const *begin_;
+                std::uint32_t const *end_;
+
+                std::uint32_t const *begin() const noexcept
+                {
+                    return begin_;
+                }
+
+                std::uint32_t const *end() const noexcept
+                {
+                    return end_;
+                }
+
+                std::size_t size() const noexcept
+                {
+                    return static_cast<std::size_t>(end_ - begin_);
+                }
+
+                std::uint32_t operator[](std::size_t i) const noexcept
+                {
+                    return begin_[i];
+                }
+            };
+
+            namespace detail
+            {
+                inline std::size_t dag_hash_combine_(std::size_t seed, std::size_t value) noexcept
+                {
+                    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // dag_slot_
+                // A terminal's value. Scalars held by value are compared by value, so equal
+                // constants share a node; everything else is compared by address.
+                struct dag_slot_
+                {
+                    void const *value;
+                    any_value_ const *type;
+                    bool (*equal)(void const *, void const *);
+                    std::size_t hash;
+                };
+
+                template<typename T, bool ByValue = std::is_scalar<T>::value>
+                struct dag_constant_
+                {
+                    static constexpr bool (*equal)(void const *, void const *) = nullptr;
+
+                    static std::size_t hash(T const &t) noexcept
+                    {
+                        return std::hash<void const *>()(std::addressof(t));
+                    }
+                };
+
+                template<typename T>
+                struct dag_constant_<T, true>
+                {
+                    static bool equal_(void const *a, void const *b)
+                    {
+                        return *static_cast<T const *>(a) == *static_cast<T const *>(b);
+                    }
+
+                    static constexpr bool (*equal)(void const *, void const *) = &dag_constant_::equal_;
+
+                    static std::size_t hash(T const &t) noexcept
+                    {
+                        unsigned char const *p = reinterpret_cast<unsigned char const *>(&t);
+                        std::size_t seed = 0;
+                        for(std::size_t i = 0; i != sizeof(T); ++i)
+                            seed = detail::dag_hash_combine_(seed, p[i]);
+                        return seed;
+                    }
+                };
+
+                template<typename Value>
+                struct dag_eval_context_;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // expr_dag
+            // Nodes are numbered in the order they are added, so children always come before
+            // their parents.
+            struct expr_dag
+            {
+                using node_id = std::uint32_t;
+
+                static constexpr node_id npos = std::numeric_limits<node_id>::max();
+
+                expr_dag() noexcept
+                  : root_(npos)
+                {}
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // accessors
+                // The number of distinct nodes
+                std::size_t size() const noexcept
+                {
+                    return nodes_.size();
+                }
+
+                bool empty() const noexcept
+                {
+                    return nodes_.empty();
+                }
+
+                // The node for the whole of the last expression lowered, or npos
+                node_id root() const noexcept
+                {
+                    return root_;
+                }
+
+                void root(node_id id) noexcept
+                {
+                    root_ = id;
+                }
+
+                expr_dag_node const &node(node_id id) const noexcept
+                {
+                    return nodes_[id];
+                }
+
+                unsigned char tag_id(node_id id) const noexcept
+                {
+                    return nodes_[id].tag;
+                }
+
+                bool is_terminal(node_id id) const noexcept
+                {
+                    return v5::tag_id<v5::tags::terminal>::value == nodes_[id].tag;
+                }
+
+                expr_dag_children children(node_id id) const noexcept
+                {
+                    std::uint32_t const *first = children_.data() + nodes_[id].first;
+                    return expr_dag_children{first, first + nodes_[id].size};
+                }
+
+                // The number of distinct terminals
+                std::size_t terminal_count() const noexcept
+                {
+                    return slots_.size();
+                }
+
+                // The type of a terminal's value
+                std::type_info const &value_type(node_id id) const noexcept
+                {
+                    return slots_[nodes_[id].first].type->type();
+                }
+
+                // A terminal's value, or null if it doesn't have type T
+                template<typename T>
+                T const *value_ptr(node_id id) const noexcept
+                {
+                    return this->is_terminal(id) && this->value_type(id) == typeid(T)
+                      ? static_cast<T const *>(slots_[nodes_[id].first].value)
+                      : nullptr;
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // add_terminal
+                // A terminal referring to t, which must outlive the expr_dag. If ByValue is
+                // true and T is a scalar, terminals with equal values share a node; otherwise,
+                // only terminals referring to the same object do.
+                template<bool ByValue = false, typename T>
+                node_id add_terminal(T const &t)
+                {
+                    using value_type = utility::uncvref<T>;
+                    using constant = detail::dag_constant_<value_type, ByValue && std::is_scalar<value_type>::value>;
+                    detail::dag_slot_ const slot = {
+                        static_cast<void const *>(std::addressof(t))
+                      , &detail::any_value_of_<value_type>::value
+                      , constant::equal
+                      , constant::hash(t)
+                    };
+                    return this->add_slot_(slot);
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // add_node
+                // A node with the given tag and children, or the existing node that has them.
+                node_id add_node(unsigned char tag, node_id const *first, std::size_t size)
+                {
+                    std::size_t hash = detail::dag_hash_combine_(tag, size);
+                    for(std::size_t i = 0; i != size; ++i)
+                        hash = detail::dag_hash_combine_(hash, first[i]);
+                    node_id *bucket = this->find_(hash, [&](expr_dag_node const &node)
+                    {
+                        if(node.tag != tag || node.size != size || this->is_terminal_node_(node))
+                            return false;
+                        for(std::size_t i = 0; i != size; ++i)
+                            if(children_[node.first + i] != first[i])
+                                return false;
+                        return true;
+                    });
+                    if(npos != *bucket)
+                        return *bucket;
+                    std::uint32_t const begin = static_cast<std::uint32_t>(children_.size());
+                    children_.insert(children_.end(), first, first + size);
+                    return this->insert_(bucket, hash, expr_dag_node{
+                        tag
+                      , begin
+                      , static_cast<std::uint32_t>(size)
+                    });
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // add_expr
+                // Adds an any_expr. Its terminals refer to the values in its pool, and share a
+                // node only with terminals referring to the same value.
+                template<typename Domain>
+                node_id add_expr(any_expr<Domain> const &e)
+                {
+                    any_nodes_ lowered;
+                    return this->add_any_node_(detail::any_access_::node(e), lowered);
+                }
+
+                void clear() noexcept
+                {
+                    nodes_.clear();
+                    children_.clear();
+                    slots_.clear();
+                    hashes_.clear();
+                    table_.clear();
+                    root_ = npos;
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // eval
+                // Evaluates the node as _eval would, through the references to the terminals'
+                // values, with all values and intermediate results of type Value. A node shared
+                // by several parents is evaluated only once. Operators that can't be applied to
+                // Values throw any_expr_error.
+                template<typename Value, typename Domain = default_domain>
+                Value eval(node_id id) const
+                {
+                    using context_type = detail::dag_eval_context_<Value>;
+                    std::vector<Value> values(nodes_.size());
+                    std::vector<bool> done(nodes_.size());
+                    context_type const ctx = {
+                        detail::any_eval_table_<Domain, context_type>::get()
+                      , this
+                      , values.data()
+                      , &done
+                    };
+                    return ctx(id);
+                }
+
+                // A terminal's value as a Value, converted as eval would convert it
+                template<typename Value>
+                Value value_as(node_id id) const
+                {
+                    detail::dag_slot_ const &slot = slots_[nodes_[id].first];
+                    return detail::any_value_as_<Value>(*slot.type, slot.value, nullptr, 0);
+                }
+
+                template<typename Value, typename Domain = default_domain>
+                Value eval() const
+                {
+                    return this->eval<Value, Domain>(root_);
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // operator<<
+                // One line per node, e.g. "%2 = plus(%0, %1)".
+                friend std::ostream &operator<<(std::ostream &sout, expr_dag const &dag)
+                {
+                    for(node_id id = 0; id != dag.nodes_.size(); ++id)
+                    {
+                        sout << '%' << id << " = ";
+                        detail::any_tag_ const *tag = detail::any_builtin_tag_(dag.tag_id(id));
+                        if(tag)
+                            tag->write(sout);
+                        else
+                            sout << "tag" << static_cast<int>(dag.tag_id(id));
+                        sout << '(';
+                        if(dag.is_terminal(id))
+                        {
+                            detail::dag_slot_ const &slot = dag.slots_[dag.nodes_[id].first];
+                            slot.type->display(sout, slot.value);
+                        }
+                        else
+                        {
+                            char const *sep = "";
+                            for(node_id child : dag.children(id))
+                            {
+                                sout << sep << '%' << child;
+                                sep = ", ";
+                            }
+                        }
+                        sout << ")\n";
+                    }
+                    return sout;
+                }
+
+            private:
+                template<typename Value>
+                friend struct detail::dag_eval_context_;
+
+                node_id add_slot_(detail::dag_slot_ const &slot)
+                {
+                    std::size_t const hash = detail::dag_hash_combine_(slot.hash, std::hash<void const *>()(slot.type));
+                    node_id *bucket = this->find_(hash, [&](expr_dag_node const &node)
+                    {
+                        if(!this->is_terminal_node_(node))
+                            return false;
+                        detail::dag_slot_ const &that = slots_[node.first];
+                        return that.type == slot.type && that.equal == slot.equal &&
+                            (that.value == slot.value || (slot.equal && slot.equal(that.value, slot.value)));
+                    });
+                    if(npos != *bucket)
+                        return *bucket;
+                    slots_.push_back(slot);
+                    return this->insert_(bucket, hash, expr_dag_node{
+                        v5::tag_id<v5::tags::terminal>::value
+                      , static_cast<std::uint32_t>(slots_.size() - 1)
+                      , 0
+                    });
+                }
+
+                // The nodes of an any_expr already added, because a pool's nodes can share children
+                using any_nodes_ = std::unordered_map<detail::any_node_ const *, node_id>;
+
+                node_id add_any_node_(detail::any_node_ const *node, any_nodes_ &lowered)
+                {
+                    auto const found = lowered.find(node);
+                    if(lowered.end() != found)
+                        return found->second;
+                    node_id const id = this->lower_any_node_(node, lowered);
+                    lowered.emplace(node, id);
+                    return id;
+                }
+
+                node_id lower_any_node_(detail::any_node_ const *node, any_nodes_ &lowered)
+                {
+                    if(detail::any_value_ const *type = node->value_type_)
+                    {
+                        // The pool owns the terminals' values, so numbers are compared by value
+                        detail::dag_slot_ const slot = {
+                            node->data_
+                          , type
+                          , type->equal
+                          , type->equal
+                              ? std::hash<long double>()(type->arithmetic(node->data_))
+                              : std::hash<void const *>()(node->data_)
+                        };
+                        return this->add_slot_(slot);
+                    }
+                    std::vector<node_id> ids;
+                    ids.reserve(node->size_);
+                    for(std::size_t i = 0; i != node->size_; ++i)
+                        ids.push_back(this->add_any_node_(node->children()[i], lowered));
+                    return this->add_node(node->tag_->id, ids.data(), ids.size());
+                }
+
+                bool is_terminal_node_(expr_dag_node const &node) const noexcept
+                {
+                    return v5::tag_id<v5::tags::terminal>::value == node.tag;
+                }
+
+                // The bucket holding the node that satisfies equal, or the empty bucket where it
+                // would go. The table is open-addressed and at most half full.
+                template<typename Equal>
+                node_id *find_(std::size_t hash, Equal equal)
+                {
+                    if(table_.size() < 2 * (nodes_.size() + 1))
+                        this->rehash_(table_.empty() ? 16 : 2 * table_.size());
+                    std::size_t const mask = table_.size() - 1;
+                    for(std::size_t i = hash & mask;; i = (i + 1) & mask)
+                    {
+                        node_id const id = table_[i];
+                        if(npos == id || (hashes_[id] == hash && equal(nodes_[id])))
+                            return &table_[i];
+                    }
+                }
+
+                node_id insert_(node_id *bucket, std::size_t hash, expr_dag_node const &node)
+                {
+                    node_id const id = static_cast<node_id>(nodes_.size());
+                    nodes_.push_back(node);
+                    hashes_.push_back(hash);
+                    *bucket = id;
+                    return id;
+                }
+
+                void rehash_(std::size_t size)
+                {
+                    table_.assign(size, node_id(npos));
+                    for(node_id id = 0; id != nodes_.size(); ++id)
+                    {
+                        std::size_t i = hashes_[id] & (size - 1);
+                        while(npos != table_[i])
+                            i = (i + 1) & (size - 1);
+                        table_[i] = id;
+                    }
+                }
+
+                std::vector<expr_dag_node> nodes_;
+                std::vector<node_id> children_;
+                std::vector<detail::dag_slot_> slots_;
+                std::vector<std::size_t> hashes_;
+                std::vector<node_id> table_;
+                node_id root_;
+            };
+
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // dag_eval_context_
+                // For any_eval_op_. Remembers the value of each node it evaluates.
+                template<typename Value>
+                struct dag_eval_context_
+                {
+                    using value_type = Value;
+                    using node_type = expr_dag::node_id;
+
+                    any_eval_fun_<dag_eval_context_> const *table_;
+                    expr_dag const *dag_;
+                    Value *values_;
+                    std::vector<bool> *done_;
+
+                    Value operator()(node_type id) const
+                    {
+                        if(!(*done_)[id])
+                        {
+                            values_[id] = table_[dag_->nodes_[id].tag](*this, id);
+                            (*done_)[id] = true;
+                        }
+                        return values_[id];
+                    }
+
+                    std::size_t size(node_type id) const noexcept
+                    {
+                        return dag_->nodes_[id].size;
+                    }
+
+                    Value child(node_type id, std::size_t i) const
+                    {
+                        return (*this)(dag_->children_[dag_->nodes_[id].first + i]);
+                    }
+
+                    Value value(node_type id) const
+                    {
+                        dag_slot_ const &slot = dag_->slots_[dag_->nodes_[id].first];
+                        return detail::any_value_as_<Value>(*slot.type, slot.value, nullptr, 0);
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // dag_holds_by_value_
+                template<typename ExprDesc>
+                struct dag_holds_by_value_;
+
+                template<typename Tag, typename Value>
+                struct dag_holds_by_value_<Tag(Value)>
+                  : std::integral_constant<bool, !std::is_reference<Value>::value>
+                {};
+
+                struct _lower_cases
+                {
+                    template<typename Tag, bool IsTerminal = Tag::proto_is_terminal_type::value>
+                    struct case_
+                      : proto::v5::basic_action<case_<Tag, IsTerminal>>
+                    {
+                        template<typename E, typename Lower = proto::v5::_lower
+                          , BOOST_PROTO_ENABLE_IF(!is_nary<E>::value)>
+                        expr_dag::node_id operator()(E && e, expr_dag &dag) const
+                        {
+                            return case_::impl<Lower>(
+                                utility::make_indices<result_of::arity_of<E>::value>()
+                              , e
+                              , dag
+                            );
+                        }
+
+                        template<typename E, typename Lower = proto::v5::_lower
+                          , BOOST_PROTO_ENABLE_IF(is_nary<E>::value)>
+                        expr_dag::node_id operator()(E && e, expr_dag &dag) const
+                        {
+                            std::vector<expr_dag::node_id> ids;
+                            ids.reserve(proto::v5::children_of(e).size());
+                            for(auto const &child : proto::v5::children_of(e))
+                                ids.push_back(Lower()(child, dag));
+                            return dag.add_node(tag_id<Tag>::value, ids.data(), ids.size());
+                        }
+
+                    private:
+                        template<typename Lower, std::size_t ...I, typename E>
+                        static expr_dag::node_id impl(utility::indices<I...>, E const &e, expr_dag &dag)
+                        {
+                            // The elements of a braced-init-list are evaluated in order
+                            expr_dag::node_id const ids[] = {Lower()(proto::v5::child<I>(e), dag)...};
+                            return dag.add_node(tag_id<Tag>::value, ids, sizeof...(I));
+                        }
+                    };
+
+                    template<typename Tag>
+                    struct case_<Tag, true>
+                      : proto::v5::basic_action<case_<Tag, true>>
+                    {
+                        template<typename E>
+                        expr_dag::node_id operator()(E && e, expr_dag &dag) const
+                        {
+                            using expr_type = utility::uncvref<E>;
+                            return dag.add_terminal<
+                                dag_holds_by_value_<typename expr_type::proto_expr_descriptor_type>::value
+                            >(proto::v5::value(e));
+                        }
+                    };
+                };
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // _lower
+            // An action that adds an expression to an expr_dag, and returns the id of its node.
+            // Terminals holding scalars by value are merged with equal constants; terminals
+            // holding their values by reference only with terminals referring to the same object.
+            struct _lower
+              : detail::as_action_<switch_(detail::_lower_cases)>
+            {};
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // lower
+            // The expr_dag of an expression. It refers to the expression's terminals, so it must
+            // not outlive it.
+            template<typename E>
+            expr_dag lower(E const &e)
+            {
+                expr_dag dag;
+                dag.root(proto::v5::_lower()(e, dag));
+                return dag;
+            }
+
+            template<typename Domain>
+            expr_dag lower(any_expr<Domain> const &e)
+            {
+                expr_dag dag;
+                dag.root(dag.add_expr(e));
+                return dag;
+            }
+        }
+    }
+}
+
+#endif
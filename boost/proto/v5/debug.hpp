@@ -320,6 +320,18 @@ namespace boost
                     using tag = fusion::fusion_sequence_tag;
                 };
 
+                // 0 for things that aren't Proto expressions but know how to display themselves
+                // with proto_display_expr, such as any_expr; 1 for terminals; 2 for the rest.
+                template<typename E, bool IsExpr = is_expr<E>::value>
+                struct display_kind_
+                  : std::integral_constant<int, 0>
+                {};
+
+                template<typename E>
+                struct display_kind_<E, true>
+                  : std::integral_constant<int, is_terminal<E>::value ? 1 : 2>
+                {};
+
                 struct display_expr_
                 {
                     display_expr_(std::ostream &sout, int depth, char const **names, ::std::size_t &index)
@@ -329,7 +341,7 @@ namespace boost
                       , sout_(sout)
                     {}
 
-                    template<typename E, BOOST_PROTO_ENABLE_IF(is_terminal<E>::value)>
+                    template<typename E, BOOST_PROTO_ENABLE_IF(1 == display_kind_<E>::value)>
                     void operator()(E &&e) const
                     {
                         using namespace hidden_detail_;
@@ -351,7 +363,7 @@ namespace boost
                         ++this->index_;
                     }
 
-                    template<typename E, BOOST_PROTO_ENABLE_IF(!is_terminal<E>::value)>
+                    template<typename E, BOOST_PROTO_ENABLE_IF(2 == display_kind_<E>::value)>
                     void operator()(E &&e) const
                     {
                         using namespace hidden_detail_;
@@ -376,6 +388,13 @@ namespace boost
                         ++this->index_;
                     }
 
+                    template<typename E, BOOST_PROTO_ENABLE_IF(0 == display_kind_<E>::value)>
+                    void operator()(E &&e) const
+                    {
+                        proto_display_expr(this->sout_, e, this->depth_, 0 == this->index_);
+                        ++this->index_;
+                    }
+
                 private:
                     int depth_;
                     char const **names_;
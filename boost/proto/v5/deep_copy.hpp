@@ -1,6 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // deep_copy.hpp
-// Replace all nodes stored by reference with nodes stored by value.
+// Replace all nodes stored by reference with nodes stored by value, either on the stack or in an
+// arena.
 //
 //  Copyright 2012 Eric Niebler. Distributed under the Boost
 //  Software License, Version 1.0. (See accompanying file
@@ -9,7 +10,15 @@
 #ifndef BOOST_PROTO_V5_DEEP_COPY_HPP_INCLUDED
 #define BOOST_PROTO_V5_DEEP_COPY_HPP_INCLUDED
 
+#include <new>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 #include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/arena.hpp>
 #include <boost/proto/v5/matches.hpp>
 #include <boost/proto/v5/make_expr.hpp>
 #include <boost/proto/v5/action/basic_action.hpp>
@@ -40,13 +49,244 @@ namespace boost
                         BOOST_PROTO_AUTO_RETURN(
                             typename result_of::domain_of<E>::type::make_expr()(
                                 proto::v5::tag_of(static_cast<E &&>(e))
-                              , utility::by_val()(proto::v5::value(static_cast<E &&>(e)))
+                              , utility::by_val_arg()(proto::v5::value(static_cast<E &&>(e)))
                             )
                         )
                     };
                 };
             }
 
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // arena_cursor_
+                // Lays out the data of one deep_copy_into region. With no base, it only measures.
+                struct arena_cursor_
+                {
+                    char *base_;
+                    std::size_t offset_;
+
+                    void *allocate(std::size_t size, std::size_t align) noexcept
+                    {
+                        offset_ = (offset_ + align - 1) / align * align;
+                        void *p = base_ ? base_ + offset_ : nullptr;
+                        offset_ += size;
+                        return p;
+                    }
+
+                    template<typename T>
+                    T const *copy(T const *data, std::size_t size, std::size_t extra = 0) noexcept
+                    {
+                        T *p = static_cast<T *>(this->allocate((size + extra) * sizeof(T), alignof(T)));
+                        if(p)
+                        {
+                            for(std::size_t i = 0; i != size; ++i)
+                                p[i] = data[i];
+                            for(std::size_t i = size; i != size + extra; ++i)
+                                p[i] = T();
+                        }
+                        return p;
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // arena_array_access_
+                // While deep_copy_into builds a copy, its arena_arrays are moved around and hold
+                // the address of their elements. Once the copy is in place, bind turns the
+                // addresses into offsets.
+                struct arena_array_access_
+                {
+                    template<typename Array, typename T>
+                    static Array unbound(T const *data, std::size_t size) noexcept
+                    {
+                        Array a;
+                        static_cast<arena_array<T> &>(a).offset_ = reinterpret_cast<std::intptr_t>(data);
+                        static_cast<arena_array<T> &>(a).size_ = size;
+                        return a;
+                    }
+
+                    template<typename T>
+                    static void bind(arena_array<T> &a) noexcept
+                    {
+                        a.rebind(reinterpret_cast<T const *>(a.offset_), a.size_);
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // arena_value_
+                // What deep_copy_into stores in place of a terminal's value of type T.
+                template<typename T, bool IsTriviallyCopyable = std::is_trivially_copyable<T>::value>
+                struct arena_value_
+                {
+                    static_assert(
+                        utility::never<T>::value
+                      , "deep_copy_into can only relocate trivially copyable values, arrays, strings "
+                        "and vectors of trivially copyable values"
+                    );
+                };
+
+                template<typename T>
+                struct arena_value_<T, true>
+                {
+                    static T make(arena_cursor_ &, T const &t) noexcept
+                    {
+                        return t;
+                    }
+                };
+
+                // Pointers to functions are kept; pointers to objects would point out of the
+                // region.
+                template<typename T>
+                struct arena_value_<T *, true>
+                {
+                    static_assert(
+                        !std::is_object<T>::value
+                      , "deep_copy_into can't relocate terminals holding pointers to objects. Hold "
+                        "a string, an array or a vector instead."
+                    );
+
+                    static T *make(arena_cursor_ &, T *t) noexcept
+                    {
+                        return t;
+                    }
+                };
+
+                template<typename T, std::size_t N>
+                struct arena_value_<T[N], true>
+                {
+                    static arena_array<T> make(arena_cursor_ &cursor, T const (&t)[N]) noexcept
+                    {
+                        return arena_array_access_::unbound<arena_array<T>>(cursor.copy(t, N), N);
+                    }
+                };
+
+                template<typename Char, std::size_t N>
+                struct arena_char_array_
+                {
+                    static basic_arena_string<Char> make(arena_cursor_ &cursor, Char const (&t)[N]) noexcept
+                    {
+                        std::size_t const size = (N != 0 && Char() == t[N - 1]) ? N - 1 : N;
+                        return arena_array_access_::unbound<basic_arena_string<Char>>(cursor.copy(t, size, 1), size);
+                    }
+                };
+
+                template<std::size_t N>
+                struct arena_value_<char[N], true>
+                  : arena_char_array_<char, N>
+                {};
+
+                template<std::size_t N>
+                struct arena_value_<wchar_t[N], true>
+                  : arena_char_array_<wchar_t, N>
+                {};
+
+                template<typename Char, typename Traits, typename Alloc>
+                struct arena_value_<std::basic_string<Char, Traits, Alloc>, false>
+                {
+                    static basic_arena_string<Char, Traits> make(
+                        arena_cursor_ &cursor
+                      , std::basic_string<Char, Traits, Alloc> const &t
+                    ) noexcept
+                    {
+                        return arena_array_access_::unbound<basic_arena_string<Char, Traits>>(
+                            cursor.copy(t.data(), t.size(), 1)
+                          , t.size()
+                        );
+                    }
+                };
+
+                template<typename T, typename Alloc>
+                struct arena_value_<std::vector<T, Alloc>, false>
+                {
+                    static arena_array<T> make(arena_cursor_ &cursor, std::vector<T, Alloc> const &t) noexcept
+                    {
+                        return arena_array_access_::unbound<arena_array<T>>(cursor.copy(t.data(), t.size()), t.size());
+                    }
+                };
+
+                template<typename Ret, typename ...Args>
+                struct arena_value_<Ret(Args...), false>
+                {
+                    static Ret (*make(arena_cursor_ &, Ret (&t)(Args...)) noexcept)(Args...)
+                    {
+                        return &t;
+                    }
+                };
+
+                struct _deep_copy_into_;
+
+                struct _deep_copy_into_cases
+                {
+                    template<typename Tag, bool IsTerminal = Tag::proto_is_terminal_type::value>
+                    struct case_
+                      : as_action_<proto::v5::passthru(_deep_copy_into_...)>
+                    {};
+
+                    template<typename Tag>
+                    struct case_<Tag, true>
+                      : proto::v5::basic_action<case_<Tag, true>>
+                    {
+                        template<typename E
+                          , typename Value = utility::uncvref<decltype(proto::v5::value(std::declval<E>()))>>
+                        auto operator()(E && e, arena_cursor_ &cursor) const
+                        BOOST_PROTO_AUTO_RETURN(
+                            typename result_of::domain_of<E>::type::make_expr()(
+                                proto::v5::tag_of(static_cast<E &&>(e))
+                              , arena_value_<Value>::make(cursor, proto::v5::value(e))
+                            )
+                        )
+                    };
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // _deep_copy_into_
+                struct _deep_copy_into_
+                  : detail::as_action_<switch_(detail::_deep_copy_into_cases)>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // arena_bind_
+                // Binds the arena_arrays in the terminals of a copy made by _deep_copy_into_ to
+                // their elements, once the copy is at its final address.
+                struct arena_bind_
+                {
+                    template<typename E>
+                    static void expr(E &e) noexcept
+                    {
+                        arena_bind_::expr_(e, is_terminal<E>());
+                    }
+
+                private:
+                    template<typename T>
+                    static void value_(arena_array<T> *a) noexcept
+                    {
+                        arena_array_access_::bind(*a);
+                    }
+
+                    static void value_(void const volatile *) noexcept
+                    {}
+
+                    template<typename E>
+                    static void expr_(E &e, std::true_type) noexcept
+                    {
+                        arena_bind_::value_(std::addressof(proto::v5::value(e)));
+                    }
+
+                    template<typename E>
+                    static void expr_(E &e, std::false_type) noexcept
+                    {
+                        arena_bind_::children_(e, utility::make_indices<E::proto_size::value>());
+                    }
+
+                    template<typename E, std::size_t ...I>
+                    static void children_(E &e, utility::indices<I...>) noexcept
+                    {
+                        using expand = int[];
+                        (void)expand{0, (arena_bind_::expr(proto::v5::child<I>(e)), 0)...};
+                    }
+                };
+            }
+
             ////////////////////////////////////////////////////////////////////////////////////////
             // _deep_copy
             // A BasicAction that replaces all nodes stored by reference with
@@ -64,6 +304,56 @@ namespace boost
                 proto::v5::_deep_copy()(static_cast<E &&>(e))
             )
 
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // deep_copy_size
+            // The number of bytes deep_copy_into takes from an arena to copy e.
+            template<typename E>
+            std::size_t deep_copy_size(E const &e)
+            {
+                using result_type =
+                    utility::uncvref<
+                        decltype(detail::_deep_copy_into_()(e, std::declval<detail::arena_cursor_ &>()))
+                    >;
+                detail::arena_cursor_ sizer {nullptr, sizeof(result_type)};
+                detail::_deep_copy_into_()(e, sizer);
+                return sizer.offset_;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // deep_copy_into
+            // Like deep_copy, but places the copy, along with the contents of any strings, vectors
+            // and arrays held in its terminals, in one contiguous region of deep_copy_size(e) bytes
+            // taken from the arena. Those contents are referred to by their distance from the
+            // referring object and the copy is trivially copyable, so the whole region can be
+            // copied elsewhere with memcpy. A copy of the expression alone, made the usual way,
+            // needs its arena_arrays rebound. Terminals may not hold pointers to objects. The
+            // copy lives until the arena is cleared or destroyed; its destructor need not be run.
+            template<typename E
+              , typename Result = utility::uncvref<
+                    decltype(detail::_deep_copy_into_()(std::declval<E>(), std::declval<detail::arena_cursor_ &>()))
+                >>
+            Result & deep_copy_into(arena &a, E && e)
+            {
+                static_assert(
+                    std::is_trivially_destructible<Result>::value
+                  , "deep_copy_into can't relocate runtime-arity expressions or other nodes that "
+                    "own memory outside the arena"
+                );
+                static_assert(
+                    alignof(Result) <= alignof(std::max_align_t)
+                  , "deep_copy_into can't relocate over-aligned expressions"
+                );
+                static_assert(
+                    std::is_trivially_copyable<Result>::value
+                  , "deep_copy_into can only relocate expressions that are trivially copyable"
+                );
+                char *region = static_cast<char *>(a.allocate(proto::v5::deep_copy_size(e)));
+                detail::arena_cursor_ cursor {region, sizeof(Result)};
+                Result &result = *::new(region) Result(detail::_deep_copy_into_()(static_cast<E &&>(e), cursor));
+                detail::arena_bind_::expr(result);
+                return result;
+            }
+
             namespace functional
             {
                 ////////////////////////////////////////////////////////////////////////////////////
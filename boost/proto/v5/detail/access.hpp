@@ -24,39 +24,100 @@ namespace boost
                     ////////////////////////////////////////////////////////////////////////////////
                     // basic_expr accessors
                     template<typename Tag, typename ...Children, typename Domain>
-                    static Tag & proto_tag(basic_expr<Tag(Children...), Domain> &e) noexcept
+                    static detail::tag_ref_<Tag, Tag &> proto_tag(basic_expr<Tag(Children...), Domain> &e) noexcept
                     {
-                        return e.tag_and_children_.first();
+                        return e.proto_tag();
                     }
 
                     template<typename Tag, typename ...Children, typename Domain>
-                    static constexpr Tag const & proto_tag(basic_expr<Tag(Children...), Domain> const &e) noexcept
+                    static constexpr detail::tag_ref_<Tag, Tag const &> proto_tag(basic_expr<Tag(Children...), Domain> const &e) noexcept
                     {
-                        return e.tag_and_children_.first();
+                        return e.proto_tag();
                     }
 
                     template<typename Tag, typename ...Children, typename Domain>
-                    static constexpr Tag && proto_tag(basic_expr<Tag(Children...), Domain> &&e) noexcept
+                    static constexpr detail::tag_ref_<Tag, Tag &&> proto_tag(basic_expr<Tag(Children...), Domain> &&e) noexcept
                     {
-                        return static_cast<detail::compressed_pair<Tag, exprs::children<Children...>> &&>(e.tag_and_children_).first();
+                        return static_cast<basic_expr<Tag(Children...), Domain> &&>(e).proto_tag();
                     }
 
                     template<typename Tag, typename ...Children, typename Domain>
                     static children<Children...> & proto_args(basic_expr<Tag(Children...), Domain> &e) noexcept
                     {
-                        return e.tag_and_children_.second();
+                        return e.proto_children();
                     }
 
                     template<typename Tag, typename ...Children, typename Domain>
                     static constexpr children<Children...> const & proto_args(basic_expr<Tag(Children...), Domain> const &e) noexcept
                     {
-                        return e.tag_and_children_.second();
+                        return e.proto_children();
                     }
 
                     template<typename Tag, typename ...Children, typename Domain>
                     static constexpr children<Children...> && proto_args(basic_expr<Tag(Children...), Domain> &&e) noexcept
                     {
-                        return static_cast<detail::compressed_pair<Tag, exprs::children<Children...>> &&>(e.tag_and_children_).second();
+                        return static_cast<basic_expr<Tag(Children...), Domain> &&>(e).proto_children();
+                    }
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // runtime-arity basic_expr accessors. These deduce the whole descriptor rather
+                    // than Tag(Child...) so that overload resolution on a fixed-arity expression
+                    // never instantiates a bogus runtime-arity basic_expr.
+                    template<typename ExprDesc, typename Domain
+                      , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                    static detail::tag_ref_<
+                        typename basic_expr<ExprDesc, Domain>::proto_tag_type
+                      , typename basic_expr<ExprDesc, Domain>::proto_tag_type &
+                    >
+                    proto_tag(basic_expr<ExprDesc, Domain> &e) noexcept
+                    {
+                        return e.proto_tag();
+                    }
+
+                    template<typename ExprDesc, typename Domain
+                      , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                    static detail::tag_ref_<
+                        typename basic_expr<ExprDesc, Domain>::proto_tag_type
+                      , typename basic_expr<ExprDesc, Domain>::proto_tag_type const &
+                    >
+                    proto_tag(basic_expr<ExprDesc, Domain> const &e) noexcept
+                    {
+                        return e.proto_tag();
+                    }
+
+                    template<typename ExprDesc, typename Domain
+                      , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                    static detail::tag_ref_<
+                        typename basic_expr<ExprDesc, Domain>::proto_tag_type
+                      , typename basic_expr<ExprDesc, Domain>::proto_tag_type &&
+                    >
+                    proto_tag(basic_expr<ExprDesc, Domain> &&e) noexcept
+                    {
+                        return static_cast<basic_expr<ExprDesc, Domain> &&>(e).proto_tag();
+                    }
+
+                    template<typename ExprDesc, typename Domain
+                      , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                    static typename basic_expr<ExprDesc, Domain>::proto_children_type &
+                    proto_args(basic_expr<ExprDesc, Domain> &e) noexcept
+                    {
+                        return e.proto_children();
+                    }
+
+                    template<typename ExprDesc, typename Domain
+                      , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                    static typename basic_expr<ExprDesc, Domain>::proto_children_type const &
+                    proto_args(basic_expr<ExprDesc, Domain> const &e) noexcept
+                    {
+                        return e.proto_children();
+                    }
+
+                    template<typename ExprDesc, typename Domain
+                      , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                    static typename basic_expr<ExprDesc, Domain>::proto_children_type &&
+                    proto_args(basic_expr<ExprDesc, Domain> &&e) noexcept
+                    {
+                        return static_cast<basic_expr<ExprDesc, Domain> &&>(e).proto_children();
                     }
 
                     template<typename Tag, typename ...A, typename ...B, typename Domain>
@@ -36,6 +36,7 @@ namespace boost
                     using proto_grammar_type = default_grammar; ///< INTERNAL ONLY
                     using store_value = utility::identity;      ///< INTERNAL ONLY
                     using store_child = utility::identity;      ///< INTERNAL ONLY
+                    using cache_results = std::false_type;      ///< INTERNAL ONLY
                 };
 
                 ////////////////////////////////////////////////////////////////////////////////////
@@ -112,6 +113,10 @@ namespace boost
                     // nodes are stored within your expressions.
                     using store_child = typename SuperDomain::store_child;
 
+                    // Define this as std::true_type in your derived domain class to let
+                    // result_cache remember the results of evaluating your expressions.
+                    using cache_results = typename SuperDomain::cache_results;
+
                     // Define this in your derived domain class to control how expressions are
                     // assembled or leave it as-is to let proto figure it out.
                     using make_expr = default_make_expr;
@@ -189,6 +194,7 @@ namespace boost
                     using store_value = void;           ///< INTERNAL ONLY
                     using store_child = void;           ///< INTERNAL ONLY
                     using make_expr = void;             ///< INTERNAL ONLY
+                    using cache_results = void;         ///< INTERNAL ONLY
                 };
             }
 
@@ -43,6 +43,152 @@ namespace boost
                 template<typename L, typename R>
                 using are_equality_comparible = decltype(detail::are_equality_comparible_<L, R>(1));
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // struct expr_storage_
+                //  Holds an expression's tag and children. Objects of an empty, trivial type are
+                //  all interchangeable, so such a tag or children object is not stored at all;
+                //  accessing it yields a single shared instance, which is const for a tag. Not
+                //  storing them means that nested expressions never have empty subobjects of the
+                //  same type that must be given distinct addresses, and that an expression with
+                //  nothing to store (e.g., a terminal holding a placeholder) is itself an empty
+                //  class that its parent's children can pack away. The children are constructed
+                //  in place from the constructor's arguments so that rebuilding a tree doesn't
+                //  move every child twice.
+                ////////////////////////////////////////////////////////////////////////////////////
+                template<typename T>
+                struct stateless_instance_
+                {
+                    static T value;
+                };
+
+                template<typename T>
+                T stateless_instance_<T>::value{};
+
+                template<
+                    typename Tag
+                  , typename Children
+                  , bool StatelessTag = is_stateless_<Tag>::value
+                  , bool StatelessChildren = is_stateless_<Children>::value
+                >
+                struct expr_storage_
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(expr_storage_);
+
+                    template<typename ...A>
+                    constexpr expr_storage_(Tag && tag, A &&... a)
+                        noexcept(
+                            noexcept(
+                                compressed_pair<Tag, Children>(
+                                    static_cast<Tag &&>(tag)
+                                  , Children(static_cast<A &&>(a)...)
+                                )
+                            )
+                        )
+                      : proto_tag_and_children_(
+                            static_cast<Tag &&>(tag)
+                          , Children(static_cast<A &&>(a)...)
+                        )
+                    {}
+
+                    Tag & proto_tag() & noexcept
+                    {
+                        return proto_tag_and_children_.first();
+                    }
+
+                    constexpr Tag const & proto_tag() const & noexcept
+                    {
+                        return proto_tag_and_children_.first();
+                    }
+
+                    constexpr Tag && proto_tag() const && noexcept
+                    {
+                        return const_cast<compressed_pair<Tag, Children> &&>(proto_tag_and_children_).first();
+                    }
+
+                    Children & proto_children() & noexcept
+                    {
+                        return proto_tag_and_children_.second();
+                    }
+
+                    constexpr Children const & proto_children() const & noexcept
+                    {
+                        return proto_tag_and_children_.second();
+                    }
+
+                    constexpr Children && proto_children() const && noexcept
+                    {
+                        return const_cast<compressed_pair<Tag, Children> &&>(proto_tag_and_children_).second();
+                    }
+
+                private:
+                    compressed_pair<Tag, Children> proto_tag_and_children_;
+                };
+
+                template<typename Tag, typename Children>
+                struct expr_storage_<Tag, Children, true, false>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(expr_storage_);
+
+                    template<typename ...A>
+                    constexpr expr_storage_(Tag &&, A &&... a)
+                        noexcept(noexcept(Children(static_cast<A &&>(a)...)))
+                      : proto_children_(static_cast<A &&>(a)...)
+                    {}
+
+                    constexpr Tag const & proto_tag() const noexcept
+                    {
+                        return stateless_instance_<Tag const>::value;
+                    }
+
+                    Children & proto_children() & noexcept
+                    {
+                        return proto_children_;
+                    }
+
+                    constexpr Children const & proto_children() const & noexcept
+                    {
+                        return proto_children_;
+                    }
+
+                    constexpr Children && proto_children() const && noexcept
+                    {
+                        return const_cast<Children &&>(proto_children_);
+                    }
+
+                private:
+                    Children proto_children_;
+                };
+
+                template<typename Tag, typename Children>
+                struct expr_storage_<Tag, Children, true, true>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(expr_storage_);
+
+                    template<typename ...A>
+                    constexpr expr_storage_(Tag &&, A &&...) noexcept
+                    {}
+
+                    constexpr Tag const & proto_tag() const noexcept
+                    {
+                        return stateless_instance_<Tag const>::value;
+                    }
+
+                    Children & proto_children() & noexcept
+                    {
+                        return stateless_instance_<Children>::value;
+                    }
+
+                    constexpr Children const & proto_children() const & noexcept
+                    {
+                        return stateless_instance_<Children>::value;
+                    }
+
+                    constexpr Children && proto_children() const && noexcept
+                    {
+                        return static_cast<Children &&>(stateless_instance_<Children>::value);
+                    }
+                };
+
                 ////////////////////////////////////////////////////////////////////////////////////
                 // struct expr_boolean_convertible
                 //  expr_boolean_convertible and friends are very carefully crafted, along with
@@ -438,6 +584,9 @@ namespace boost
 
                 ////////////////////////////////////////////////////////////////////////////////////
                 // struct expr_base
+                //  Deprecated. Expressions no longer derive from it, because nested expressions
+                //  would then have empty subobjects of the same type that can't share an address.
+                //  Use is_expr to tell whether a type is an expression.
                 struct expr_base
                 {};
 
@@ -445,18 +594,13 @@ namespace boost
                 // struct basic_expr
                 template<typename Tag, typename ...Children, typename Domain>
                 struct basic_expr<Tag(Children...), Domain>
-                  : expr_base
-                  , detail::expr_boolean_convertible<basic_expr<Tag(Children...), Domain>>
+                  : detail::expr_boolean_convertible<basic_expr<Tag(Children...), Domain>>
+                  , private detail::expr_storage_<Tag, exprs::children<Children...>>
                 {
                 private:
                     friend struct access;
 
-                    using tag_and_children_type =
-                        detail::compressed_pair<
-                            Tag
-                          , exprs::children<Children...>
-                        >;
-                    tag_and_children_type tag_and_children_;
+                    using storage_type = detail::expr_storage_<Tag, exprs::children<Children...>>;
 
                 public:
                     BOOST_PROTO_REGULAR_TRIVIAL_CLASS(basic_expr);
@@ -496,13 +640,13 @@ namespace boost
                     constexpr basic_expr(Tag tag, proto_children_type args)
                         noexcept(
                             noexcept(
-                                tag_and_children_type(
+                                storage_type(
                                     static_cast<Tag &&>(tag)
                                   , static_cast<proto_children_type &&>(args)
                                 )
                             )
                         )
-                      : tag_and_children_(
+                      : storage_type(
                             static_cast<Tag &&>(tag)
                           , static_cast<proto_children_type &&>(args)
                         )
@@ -522,15 +666,15 @@ namespace boost
                     constexpr basic_expr(Tag tag, A &&a)
                         noexcept(
                             noexcept(
-                                tag_and_children_type(
+                                storage_type(
                                     static_cast<Tag &&>(tag)
-                                  , proto_children_type(static_cast<A &&>(a))
+                                  , static_cast<A &&>(a)
                                 )
                             )
                         )
-                      : tag_and_children_(
+                      : storage_type(
                             static_cast<Tag &&>(tag)
-                          , proto_children_type(static_cast<A &&>(a))
+                          , static_cast<A &&>(a)
                         )
                     {}
 
@@ -553,15 +697,15 @@ namespace boost
                     constexpr basic_expr(Tag tag, A &&a, B &&b, C &&... c)
                         noexcept(
                             noexcept(
-                                tag_and_children_type(
+                                storage_type(
                                     static_cast<Tag &&>(tag)
-                                  , proto_children_type(static_cast<A &&>(a), static_cast<B &&>(b), static_cast<C &&>(c)...)
+                                  , static_cast<A &&>(a), static_cast<B &&>(b), static_cast<C &&>(c)...
                                 )
                             )
                         )
-                      : tag_and_children_(
+                      : storage_type(
                             static_cast<Tag &&>(tag)
-                          , proto_children_type(static_cast<A &&>(a), static_cast<B &&>(b), static_cast<C &&>(c)...)
+                          , static_cast<A &&>(a), static_cast<B &&>(b), static_cast<C &&>(c)...
                         )
                     {}
 
@@ -697,11 +841,38 @@ namespace boost
                 };
             }
 
+            namespace detail
+            {
+                // Expressions don't share a common empty base class, because two subobjects of
+                // the same type can never share an address and that would keep empty
+                // expressions from being packed. Look for a basic_expr base instead. (The
+                // packed children of an expression inherit privately from the expressions they
+                // hold, so their nested typedefs are inaccessible.) The domain of the base is
+                // deduced, because extensions may give themselves a different domain.
+                template<typename ExprDesc, typename Domain>
+                std::true_type has_basic_expr_base_(exprs::basic_expr<ExprDesc, Domain> const *);
+
+                template<typename ExprDesc>
+                std::false_type has_basic_expr_base_(void const *);
+
+                template<
+                    typename T
+                  , typename ExprDesc = typename T::proto_expr_descriptor_type
+                >
+                decltype(detail::has_basic_expr_base_<ExprDesc>(static_cast<T const *>(nullptr))) is_expr_(int);
+
+                template<typename T>
+                std::false_type is_expr_(long);
+
+                template<typename T>
+                using is_expr_impl_ = decltype(detail::is_expr_<T>(1));
+            }
+
             ////////////////////////////////////////////////////////////////////////////////////////
             // is_expr
             template<typename T>
             struct is_expr
-              : std::is_base_of<expr_base, T>
+              : detail::is_expr_impl_<T>
             {
                 using type = is_expr;
                 using tag = mpl::integral_c_tag; // HACK until mpl supports std::integral_constant
@@ -709,7 +880,7 @@ namespace boost
 
             template<typename T>
             struct is_expr<T &>
-              : std::is_base_of<expr_base, T>
+              : detail::is_expr_impl_<T>
             {
                 using type = is_expr;
                 using tag = mpl::integral_c_tag; // HACK until mpl supports std::integral_constant
@@ -717,7 +888,7 @@ namespace boost
 
             template<typename T>
             struct is_expr<T &&>
-              : std::is_base_of<expr_base, T>
+              : detail::is_expr_impl_<T>
             {
                 using type = is_expr;
                 using tag = mpl::integral_c_tag; // HACK until mpl supports std::integral_constant
@@ -749,6 +920,37 @@ namespace boost
                 using tag = mpl::integral_c_tag; // HACK until mpl supports std::integral_constant
             };
 
+            namespace detail
+            {
+                template<typename ExprDesc>
+                struct is_nary_desc_
+                  : std::false_type
+                {};
+
+                // A runtime-arity expression is described by a C-style variadic function type,
+                // Tag(Child, ...); see nary_expr.hpp.
+                template<typename Tag, typename Child>
+                struct is_nary_desc_<Tag(Child...)>
+                  : std::true_type
+                {};
+
+                template<typename T, typename ExprDesc = typename T::proto_expr_descriptor_type>
+                is_nary_desc_<ExprDesc> is_nary_(int);
+
+                template<typename T>
+                std::false_type is_nary_(long);
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // is_nary
+            template<typename Expr>
+            struct is_nary
+              : decltype(detail::is_nary_<utility::uncvref<Expr>>(1))
+            {
+                using type = is_nary;
+                using tag = mpl::integral_c_tag; // HACK until mpl supports std::integral_constant
+            };
+
             namespace result_of
             {
                 ////////////////////////////////////////////////////////////////////////////////////////
@@ -11,22 +11,22 @@
 
 #include <cstddef>
 #include <utility>
+#include <type_traits>
+#include <boost/mpl/size_t.hpp>
 #include <boost/mpl/sequence_tag_fwd.hpp>
 #include <boost/fusion/include/is_view.hpp>
 #include <boost/fusion/include/tag_of_fwd.hpp>
 #include <boost/fusion/include/category_of.hpp>
 #include <boost/fusion/include/iterator_base.hpp>
 #include <boost/fusion/include/intrinsic.hpp>
-#include <boost/fusion/include/single_view.hpp>
-#include <boost/fusion/include/transform.hpp>
-#include <boost/fusion/include/as_list.hpp>
-#include <boost/fusion/include/is_segmented.hpp>
 #include <boost/fusion/sequence/comparison/enable_comparison.hpp>
 #include <boost/fusion/support/tag_of_fwd.hpp>
 #include <boost/proto/v5/proto_fwd.hpp>
 #include <boost/proto/v5/children.hpp>
 #include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
 #include <boost/proto/v5/unpack_expr.hpp>
+#include <boost/proto/v5/utility.hpp>
 
 namespace boost
 {
@@ -58,39 +58,123 @@ namespace boost
                     Expr &expr_;
                 };
 
-                template<typename Tag>
-                struct as_element
-                {
-                    template<typename Sig>
-                    struct result;
+                ////////////////////////////////////////////////////////////////////////////////////
+                // flat_child_
+                // The type of the Ith child of Expr as returned by proto::child.
+                template<typename Expr, std::size_t I>
+                using flat_child_ = decltype(proto::v5::child<I>(std::declval<Expr &>()));
 
-                    template<typename This, typename Expr>
-                    struct result<This(Expr)>
-                      : result<This(Expr const &)>
-                    {};
+                // Whether the child C of a node tagged Tag is itself flattened into its parent.
+                template<
+                    typename C
+                  , typename Tag
+                  , typename T = utility::uncvref<C>
+                  , bool IsExpr = v5::is_expr<T>::value
+                >
+                struct is_flattened_
+                  : std::false_type
+                {};
 
-                    template<typename This, typename Expr>
-                    struct result<This(Expr &)>
-                      : std::conditional<
-                            is_same<Tag, typename Expr::proto_tag_type>::value
-                          , flat_view<Expr>
-                          , fusion::single_view<Expr &>
-                        >
-                    {};
+                template<typename C, typename Tag, typename T>
+                struct is_flattened_<C, Tag, T, true>
+                  : std::integral_constant<
+                        bool
+                      , !v5::is_terminal<T>::value &&
+                        !v5::is_nary<T>::value &&
+                        std::is_same<Tag, typename result_of::tag_of<T>::type>::value
+                    >
+                {};
 
-                    template<typename Expr>
-                    typename result<as_element(Expr &)>::type operator ()(Expr &e) const
+                template<
+                    typename Expr
+                  , typename Tag
+                  , typename Indices = utility::make_indices<Expr::proto_size::value>
+                >
+                struct flat_size_;
+
+                // The number of leaves the child C contributes to a flattened node tagged Tag.
+                template<typename C, typename Tag, bool Flatten = is_flattened_<C, Tag>::value>
+                struct flat_leaves_
+                  : std::integral_constant<std::size_t, 1>
+                {};
+
+                template<typename C, typename Tag>
+                struct flat_leaves_<C, Tag, true>
+                  : flat_size_<typename std::remove_reference<C>::type, Tag>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // flat_size_
+                // The number of leaves in the flattened view of Expr. Computed once per node type.
+                template<typename Expr, typename Tag, std::size_t ...I>
+                struct flat_size_<Expr, Tag, utility::indices<I...>>
+                  : std::integral_constant<
+                        std::size_t
+                      , utility::size_ops::sum(flat_leaves_<flat_child_<Expr, I>, Tag>::value...)
+                    >
+                {};
+
+                template<
+                    typename Expr
+                  , typename Tag
+                  , std::size_t N
+                  , std::size_t I = 0
+                  , bool Here = (N < flat_leaves_<flat_child_<Expr, I>, Tag>::value)
+                >
+                struct flat_at_;
+
+                template<
+                    typename Expr
+                  , typename Tag
+                  , std::size_t N
+                  , std::size_t I
+                  , bool Flatten = is_flattened_<flat_child_<Expr, I>, Tag>::value
+                >
+                struct flat_leaf_
+                {
+                    using type = flat_child_<Expr, I>;
+                    using value_type =
+                        typename exprs::children_element<I, typename Expr::proto_children_type>::type;
+
+                    static type call(Expr &e)
                     {
-                        return typename result<as_element(Expr &)>::type(e);
+                        return proto::v5::child<I>(e);
                     }
+                };
 
-                    template<typename Expr>
-                    typename result<as_element(Expr const &)>::type operator ()(Expr const &e) const
+                template<typename Expr, typename Tag, std::size_t N, std::size_t I>
+                struct flat_leaf_<Expr, Tag, N, I, true>
+                {
+                    using child_type = typename std::remove_reference<flat_child_<Expr, I>>::type;
+                    using type = typename flat_at_<child_type, Tag, N>::type;
+                    using value_type = typename flat_at_<child_type, Tag, N>::value_type;
+
+                    static type call(Expr &e)
                     {
-                        return typename result<as_element(Expr const &)>::type(e);
+                        return flat_at_<child_type, Tag, N>::call(proto::v5::child<I>(e));
                     }
                 };
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // flat_at_
+                // Maps the position N in the flattened view of Expr directly to the leaf there,
+                // skipping over whole children that come before it.
+                template<typename Expr, typename Tag, std::size_t N, std::size_t I, bool Here>
+                struct flat_at_
+                  : flat_at_<Expr, Tag, N - flat_leaves_<flat_child_<Expr, I>, Tag>::value, I + 1>
+                {};
+
+                template<typename Expr, typename Tag, std::size_t N, std::size_t I>
+                struct flat_at_<Expr, Tag, N, I, true>
+                  : flat_leaf_<Expr, Tag, N, I>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // flat_view
+                // A view of the children of an expression in which children with the same tag
+                // as the expression are replaced with their own children, recursively. It holds
+                // only a reference to the expression; the position of each leaf is computed at
+                // compile time, and only when that leaf is accessed.
                 template<typename Expr>
                 struct flat_view
                   : fusion::sequence_base<flat_view<Expr>>
@@ -98,27 +182,68 @@ namespace boost
                     BOOST_PROTO_REGULAR_TRIVIAL_CLASS(flat_view);
 
                     using expr_type = Expr;
-                    using category = fusion::forward_traversal_tag;
+                    using proto_tag_type = typename result_of::tag_of<Expr>::type;
+                    using proto_size = flat_size_<Expr, proto_tag_type>;
+                    using category = fusion::random_access_traversal_tag;
                     using fusion_tag =
                         proto_flat_view<
                             typename result_of::tag_of<Expr>::type
                           , typename result_of::domain_of<Expr>::type
                         >;
-                    using segments_type =
-                        typename fusion::result_of::as_list<
-                            typename fusion::result_of::transform<
-                                Expr
-                              , as_element<typename Expr::proto_tag_type>
-                            >::type
-                        >::type;
 
-                    explicit flat_view(Expr &e)
-                      : segs_(fusion::as_list(
-                            fusion::transform(e, as_element<typename Expr::proto_tag_type>())
-                        ))
+                    explicit flat_view(Expr &e) noexcept
+                      : expr_(e)
                     {}
 
-                    segments_type segs_;
+                    Expr &expr_;
+                };
+
+                template<typename View, std::size_t Pos>
+                struct flat_view_iterator
+                  : fusion::iterator_base<flat_view_iterator<View, Pos>>
+                {
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(flat_view_iterator);
+
+                    static constexpr std::size_t index = Pos;
+                    using view_type = View;
+                    using expr_type = typename View::expr_type;
+                    using category = fusion::random_access_traversal_tag;
+                    using fusion_tag =
+                        proto_flat_view_iterator<
+                            typename result_of::tag_of<expr_type>::type
+                          , typename result_of::domain_of<expr_type>::type
+                        >;
+
+                    explicit flat_view_iterator(expr_type &e) noexcept
+                      : expr_(e)
+                    {}
+
+                    expr_type &expr_;
+                };
+
+                // A runtime-arity node has no static size to build a Fusion view on. Its
+                // children are already flat -- make_flat_expr splices same-tag operands
+                // in -- so flattening it yields its children range.
+                template<typename Expr, bool IsNary = is_nary<Expr>::value>
+                struct flatten_
+                {
+                    using type = flat_view<Expr>;
+
+                    static type call(Expr &e)
+                    {
+                        return type(e);
+                    }
+                };
+
+                template<typename Expr>
+                struct flatten_<Expr, true>
+                {
+                    using type = decltype(exprs::children_of(std::declval<Expr &>()));
+
+                    static type call(Expr &e) noexcept
+                    {
+                        return exprs::children_of(e);
+                    }
                 };
             }
 
@@ -132,7 +257,7 @@ namespace boost
                 template<typename Expr>
                 struct flatten<Expr &>
                 {
-                    using type = detail::flat_view<Expr>;
+                    using type = typename detail::flatten_<Expr>::type;
                 };
             }
 
@@ -163,19 +288,19 @@ namespace boost
                     template<typename This, typename Expr>
                     struct result<This(Expr &)>
                     {
-                        using type = proto::v5::detail::flat_view<Expr>;
+                        using type = typename proto::v5::detail::flatten_<Expr>::type;
                     };
 
                     template<typename Expr>
-                    proto::v5::detail::flat_view<Expr> operator ()(Expr &e) const
+                    typename proto::v5::detail::flatten_<Expr>::type operator ()(Expr &e) const
                     {
-                        return proto::v5::detail::flat_view<Expr>(e);
+                        return proto::v5::detail::flatten_<Expr>::call(e);
                     }
 
                     template<typename Expr>
-                    proto::v5::detail::flat_view<Expr const> operator ()(Expr const &e) const
+                    typename proto::v5::detail::flatten_<Expr const>::type operator ()(Expr const &e) const
                     {
-                        return proto::v5::detail::flat_view<Expr const>(e);
+                        return proto::v5::detail::flatten_<Expr const>::call(e);
                     }
                 };
             }
@@ -191,18 +316,21 @@ namespace boost
             /// expression <tt>a | b | c</tt> has a flattened view with elements
             /// [a, b, c], even though the tree is grouped as
             /// <tt>((a | b) | c)</tt>.
+            ///
+            /// A runtime-arity node (see \c make_flat_expr) is already flat, so
+            /// for one of those \c flatten returns its children range instead.
             template<typename Expr>
-            proto::v5::detail::flat_view<Expr> flatten(Expr &e)
+            typename proto::v5::detail::flatten_<Expr>::type flatten(Expr &e)
             {
-                return proto::v5::detail::flat_view<Expr>(e);
+                return proto::v5::detail::flatten_<Expr>::call(e);
             }
 
             /// \overload
             ///
             template<typename Expr>
-            proto::v5::detail::flat_view<Expr const> flatten(Expr const &e)
+            typename proto::v5::detail::flatten_<Expr const>::type flatten(Expr const &e)
             {
-                return proto::v5::detail::flat_view<Expr const>(e);
+                return proto::v5::detail::flatten_<Expr const>::call(e);
             }
         }
     }
@@ -559,46 +687,205 @@ namespace boost
                 };
             };
 
-            template<typename Tag>
-            struct is_segmented_impl;
+            template<typename Tag, typename Domain>
+            struct category_of_impl<proto::v5::proto_flat_view<Tag, Domain>>
+            {
+                template<typename Sequence>
+                struct apply
+                {
+                    using type = random_access_traversal_tag;
+                };
+            };
 
             template<typename Tag, typename Domain>
-            struct is_segmented_impl<proto::v5::proto_flat_view<Tag, Domain>>
+            struct size_impl<proto::v5::proto_flat_view<Tag, Domain>>
             {
-                template<typename Iterator>
+                template<typename Sequence>
                 struct apply
-                  : std::true_type
+                  : mpl::size_t<Sequence::proto_size::value>
                 {};
             };
 
-            template<typename Tag>
-            struct segments_impl;
-
             template<typename Tag, typename Domain>
-            struct segments_impl<proto::v5::proto_flat_view<Tag, Domain>>
+            struct begin_impl<proto::v5::proto_flat_view<Tag, Domain>>
             {
                 template<typename Sequence>
                 struct apply
                 {
-                    using type = typename Sequence::segments_type const &;
+                    using type =
+                        proto::v5::detail::flat_view_iterator<
+                            typename std::remove_const<Sequence>::type
+                          , 0
+                        >;
 
-                    static type call(Sequence &sequence)
+                    static type call(Sequence &seq)
                     {
-                        return sequence.segs_;
+                        return type(seq.expr_);
                     }
                 };
             };
 
             template<typename Tag, typename Domain>
-            struct category_of_impl<proto::v5::proto_flat_view<Tag, Domain>>
+            struct end_impl<proto::v5::proto_flat_view<Tag, Domain>>
             {
                 template<typename Sequence>
                 struct apply
                 {
-                    using type = forward_traversal_tag;
+                    using type =
+                        proto::v5::detail::flat_view_iterator<
+                            typename std::remove_const<Sequence>::type
+                          , Sequence::proto_size::value
+                        >;
+
+                    static type call(Sequence &seq)
+                    {
+                        return type(seq.expr_);
+                    }
+                };
+            };
+
+            template<typename Tag, typename Domain>
+            struct value_at_impl<proto::v5::proto_flat_view<Tag, Domain>>
+            {
+                template<typename Sequence, typename Index>
+                struct apply
+                {
+                    using type =
+                        typename proto::v5::detail::flat_at_<
+                            typename Sequence::expr_type
+                          , typename Sequence::proto_tag_type
+                          , (std::size_t)Index::value
+                        >::value_type;
                 };
             };
 
+            template<typename Tag, typename Domain>
+            struct at_impl<proto::v5::proto_flat_view<Tag, Domain>>
+            {
+                template<typename Sequence, typename Index>
+                struct apply
+                {
+                    using impl =
+                        proto::v5::detail::flat_at_<
+                            typename Sequence::expr_type
+                          , typename Sequence::proto_tag_type
+                          , (std::size_t)Index::value
+                        >;
+                    using type = typename impl::type;
+
+                    static type call(Sequence &seq)
+                    {
+                        return impl::call(seq.expr_);
+                    }
+                };
+            };
+
+            template<typename Tag, typename Domain>
+            struct value_of_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>
+            {
+                template<typename Iterator>
+                struct apply
+                {
+                    using type =
+                        typename proto::v5::detail::flat_at_<
+                            typename Iterator::expr_type
+                          , typename Iterator::view_type::proto_tag_type
+                          , Iterator::index
+                        >::value_type;
+                };
+            };
+
+            template<typename Tag, typename Domain>
+            struct deref_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>
+            {
+                template<typename Iterator>
+                struct apply
+                {
+                    using impl =
+                        proto::v5::detail::flat_at_<
+                            typename Iterator::expr_type
+                          , typename Iterator::view_type::proto_tag_type
+                          , Iterator::index
+                        >;
+                    using type = typename impl::type;
+
+                    static type call(Iterator const &iter)
+                    {
+                        return impl::call(iter.expr_);
+                    }
+                };
+            };
+
+            template<typename Tag, typename Domain>
+            struct advance_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>
+            {
+                template<typename Iterator, typename N>
+                struct apply
+                {
+                    static constexpr std::ptrdiff_t signed_index =
+                        (std::ptrdiff_t)Iterator::index + (std::ptrdiff_t)N::value;
+
+                    // Range-check the result
+                    static_assert(
+                        0 <= signed_index
+                      , "Cannot advance before the beginning of the sequence"
+                    );
+
+                    // index == size allowed for 1-past the last element.
+                    static_assert(
+                        Iterator::view_type::proto_size::value >= (std::size_t)signed_index
+                      , "Cannot advance past the end of the sequence"
+                    );
+
+                    using type =
+                        proto::v5::detail::flat_view_iterator<
+                            typename Iterator::view_type
+                          , (std::size_t)signed_index
+                        >;
+
+                    static type call(Iterator const &iter)
+                    {
+                        return type(iter.expr_);
+                    }
+                };
+            };
+
+            template<typename Tag, typename Domain>
+            struct distance_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>
+            {
+                template<typename IteratorFrom, typename IteratorTo>
+                struct apply
+                  : std::integral_constant<
+                        int
+                      , (int)((std::ptrdiff_t)IteratorTo::index - (std::ptrdiff_t)IteratorFrom::index)
+                    >
+                {};
+            };
+
+            template<typename Tag, typename Domain>
+            struct next_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>
+            {
+                template<typename Iterator>
+                struct apply
+                  : advance_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>::template apply<
+                        Iterator
+                      , std::integral_constant<int, 1>
+                    >
+                {};
+            };
+
+            template<typename Tag, typename Domain>
+            struct prior_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>
+            {
+                template<typename Iterator>
+                struct apply
+                  : advance_impl<proto::v5::proto_flat_view_iterator<Tag, Domain>>::template apply<
+                        Iterator
+                      , std::integral_constant<int, -1>
+                    >
+                {};
+            };
+
         }
 
         namespace traits
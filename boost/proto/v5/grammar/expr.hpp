@@ -265,6 +265,19 @@ namespace boost
                     >
                 {};
 
+                // Handle runtime-arity matches. The number of children isn't known until
+                // runtime, so only a variadic pattern with a single repeated grammar can match.
+                template<
+                    typename Tag0, typename Child0
+                  , typename Tag1, typename Grammar
+                >
+                struct matches_expr_<Tag0(Child0...), Tag1(Grammar...)>
+                  : utility::and_<
+                        tag_matches<Tag0, Tag1>
+                      , result_of::matches<Child0, Grammar>
+                    >
+                {};
+
                 // Handle terminal matches.
                 template<
                     typename Tag0, typename Value0
@@ -0,0 +1,400 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// hash.hpp
+// Structural hashing and equality of expressions, so that they can be the keys of unordered
+// containers. An expression's hash combines a hash of its shape, its tags' ids and arities,
+// computed at compile time, with the hashes of its terminals' values. Terminals that hold their
+// values by reference are hashed and compared by value or by address, according to a policy.
+// Hashing never allocates.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_HASH_HPP_INCLUDED
+#define BOOST_PROTO_V5_HASH_HPP_INCLUDED
+
+#include <memory>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/children.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
+#include <boost/proto/v5/tags.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/detail/access.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // value_hash
+            // How a terminal's value of type T is hashed. Specialize it for your own types. By
+            // default, enumerations are hashed as their underlying type, empty types such as
+            // placeholders all hash alike, and everything else uses std::hash.
+            template<typename T, typename Enable = void>
+            struct value_hash
+            {
+                std::size_t operator()(T const &t) const noexcept(noexcept(std::hash<T>()(t)))
+                {
+                    return std::hash<T>()(t);
+                }
+            };
+
+            template<typename T>
+            struct value_hash<T, typename std::enable_if<std::is_enum<T>::value>::type>
+            {
+                std::size_t operator()(T const &t) const noexcept
+                {
+                    using underlying_type = typename std::underlying_type<T>::type;
+                    return std::hash<underlying_type>()(static_cast<underlying_type>(t));
+                }
+            };
+
+            template<typename T>
+            struct value_hash<T, typename std::enable_if<std::is_empty<T>::value>::type>
+            {
+                std::size_t operator()(T const &) const noexcept
+                {
+                    return 0;
+                }
+            };
+
+            template<typename T, std::size_t N>
+            struct value_hash<T[N]>
+            {
+                std::size_t operator()(T const (&t)[N]) const noexcept(noexcept(value_hash<T>()(t[0])))
+                {
+                    std::size_t seed = N;
+                    for(std::size_t i = 0; i != N; ++i)
+                        seed ^= value_hash<T>()(t[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                    return seed;
+                }
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // hash_refs_by_value, hash_refs_by_address
+            // Whether terminals that hold their values by reference are hashed and compared by
+            // their values or by the addresses of the objects they refer to. Terminals that hold
+            // their values by value are always hashed by value.
+            struct hash_refs_by_value
+            {};
+
+            struct hash_refs_by_address
+            {};
+
+            namespace detail
+            {
+                constexpr std::size_t hash_combine_(std::size_t seed, std::size_t value) noexcept
+                {
+                    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+                }
+
+                constexpr std::size_t hash_fold_(std::size_t seed) noexcept
+                {
+                    return seed;
+                }
+
+                template<typename ...Tail>
+                constexpr std::size_t hash_fold_(std::size_t seed, std::size_t head, Tail... tail) noexcept
+                {
+                    return detail::hash_fold_(detail::hash_combine_(seed, head), tail...);
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // shape_hash_
+                // A hash of the tags and arities of the nodes of Expr, in preorder. A runtime-arity
+                // node is told apart from a node with one child by an arity no node can have.
+                template<
+                    typename Expr
+                  , typename ExprDesc = typename Expr::proto_expr_descriptor_type
+                  , bool IsTerminal = is_terminal<Expr>::value
+                >
+                struct shape_hash_;
+
+                template<typename Expr, typename Tag, typename Value>
+                struct shape_hash_<Expr, Tag(Value), true>
+                  : std::integral_constant<std::size_t, detail::hash_combine_(tag_id<Tag>::value, 0)>
+                {};
+
+                template<typename Expr, typename Tag, typename ...Children>
+                struct shape_hash_<Expr, Tag(Children...), false>
+                  : std::integral_constant<
+                        std::size_t
+                      , detail::hash_fold_(
+                            detail::hash_combine_(tag_id<Tag>::value, sizeof...(Children))
+                          , shape_hash_<utility::uncvref<Children>>::value...
+                        )
+                    >
+                {};
+
+                template<typename Expr, typename Tag, typename Child>
+                struct shape_hash_<Expr, Tag(Child...), false>
+                  : std::integral_constant<
+                        std::size_t
+                      , detail::hash_fold_(
+                            detail::hash_combine_(tag_id<Tag>::value, ~std::size_t(0))
+                          , shape_hash_<utility::uncvref<Child>>::value
+                        )
+                    >
+                {};
+
+                template<typename Expr, typename ExprDesc = typename Expr::proto_expr_descriptor_type>
+                struct terminal_value_;
+
+                template<typename Expr, typename Tag, typename Value>
+                struct terminal_value_<Expr, Tag(Value)>
+                {
+                    using type = Value;
+                };
+
+                // Values of different types are never equal, since they needn't hash alike. Empty
+                // values are all equal, as they all hash alike.
+                template<typename T, typename U>
+                inline bool value_equal_(T const &, U const &) noexcept
+                {
+                    return false;
+                }
+
+                template<typename T, BOOST_PROTO_ENABLE_IF(!std::is_empty<T>::value)>
+                inline bool value_equal_(T const &a, T const &b)
+                {
+                    return static_cast<bool>(a == b);
+                }
+
+                template<typename T, BOOST_PROTO_ENABLE_IF(std::is_empty<T>::value)>
+                inline bool value_equal_(T const &, T const &) noexcept
+                {
+                    return true;
+                }
+
+                template<typename T, std::size_t N>
+                inline bool value_equal_(T const (&a)[N], T const (&b)[N])
+                {
+                    for(std::size_t i = 0; i != N; ++i)
+                        if(!detail::value_equal_(a[i], b[i]))
+                            return false;
+                    return true;
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // hash_terminal_
+                template<typename Value, typename Policy>
+                struct hash_terminal_
+                {
+                    static std::size_t hash(Value const &t)
+                    {
+                        return value_hash<utility::uncvref<Value>>()(t);
+                    }
+                };
+
+                template<typename T>
+                struct hash_terminal_<T &, hash_refs_by_address>
+                {
+                    static std::size_t hash(T const &t) noexcept
+                    {
+                        return std::hash<void const *>()(std::addressof(t));
+                    }
+                };
+
+                template<typename A, typename B, typename Policy>
+                struct equal_terminal_
+                {
+                    static bool call(A const &a, B const &b)
+                    {
+                        return detail::value_equal_(a, b);
+                    }
+                };
+
+                template<typename T, typename U>
+                struct equal_terminal_<T &, U &, hash_refs_by_address>
+                {
+                    static bool call(T const &a, U const &b) noexcept
+                    {
+                        return static_cast<void const *>(std::addressof(a)) ==
+                               static_cast<void const *>(std::addressof(b));
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // hash_expr_
+                template<typename Policy>
+                struct hash_expr_
+                {
+                    std::size_t &seed_;
+
+                    template<typename E, BOOST_PROTO_ENABLE_IF(is_terminal<E>::value)>
+                    void operator()(E const &e) const
+                    {
+                        using value_type = typename terminal_value_<E>::type;
+                        seed_ = detail::hash_combine_(
+                            seed_
+                          , hash_terminal_<value_type, Policy>::hash(proto::v5::value(e))
+                        );
+                    }
+
+                    template<typename E, BOOST_PROTO_ENABLE_IF(!is_terminal<E>::value && !is_nary<E>::value)>
+                    void operator()(E const &e) const
+                    {
+                        exprs::for_each(exprs::access::proto_args(e), *this);
+                    }
+
+                    template<typename E, BOOST_PROTO_ENABLE_IF(is_nary<E>::value)>
+                    void operator()(E const &e) const
+                    {
+                        seed_ = detail::hash_combine_(seed_, proto::v5::children_of(e).size());
+                        for(auto const &child : proto::v5::children_of(e))
+                            (*this)(child);
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // same_shape_
+                // Whether two expressions have the same tags and arities at their roots. Their
+                // children are compared in turn.
+                template<typename A, typename B, bool IsNary = is_nary<A>::value || is_nary<B>::value>
+                struct same_shape_
+                  : std::integral_constant<
+                        bool
+                      , std::is_same<typename result_of::tag_of<A>::type, typename result_of::tag_of<B>::type>::value &&
+                        result_of::arity_of<A>::value == result_of::arity_of<B>::value
+                    >
+                {};
+
+                // The arity of an nary expression is only known at runtime
+                template<typename A, typename B>
+                struct same_shape_<A, B, true>
+                  : std::integral_constant<
+                        bool
+                      , std::is_same<typename result_of::tag_of<A>::type, typename result_of::tag_of<B>::type>::value &&
+                        is_nary<A>::value && is_nary<B>::value
+                    >
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // equal_expr_
+                // Compares two expressions node by node. They needn't have the same type, so an
+                // expression holding its terminals by reference can be compared with a copy of it
+                // holding them by value.
+                template<typename Policy>
+                struct equal_expr_
+                {
+                    template<typename A, typename B, BOOST_PROTO_ENABLE_IF(!same_shape_<A, B>::value)>
+                    static bool call(A const &, B const &) noexcept
+                    {
+                        return false;
+                    }
+
+                    template<typename A, typename B
+                      , BOOST_PROTO_ENABLE_IF(same_shape_<A, B>::value && is_terminal<A>::value)>
+                    static bool call(A const &a, B const &b)
+                    {
+                        return equal_terminal_<
+                            typename terminal_value_<A>::type
+                          , typename terminal_value_<B>::type
+                          , Policy
+                        >::call(proto::v5::value(a), proto::v5::value(b));
+                    }
+
+                    template<typename A, typename B
+                      , BOOST_PROTO_ENABLE_IF(same_shape_<A, B>::value && !is_terminal<A>::value && !is_nary<A>::value)>
+                    static bool call(A const &a, B const &b)
+                    {
+                        return equal_expr_::children_(
+                            utility::make_indices<result_of::arity_of<A>::value>()
+                          , a
+                          , b
+                        );
+                    }
+
+                    template<typename A, typename B
+                      , BOOST_PROTO_ENABLE_IF(same_shape_<A, B>::value && is_nary<A>::value)>
+                    static bool call(A const &a, B const &b)
+                    {
+                        std::size_t const size = proto::v5::children_of(a).size();
+                        if(size != proto::v5::children_of(b).size())
+                            return false;
+                        for(std::size_t i = 0; i != size; ++i)
+                            if(!equal_expr_::call(proto::v5::child(a, i), proto::v5::child(b, i)))
+                                return false;
+                        return true;
+                    }
+
+                private:
+                    template<std::size_t ...I, typename A, typename B>
+                    static bool children_(utility::indices<I...>, A const &a, B const &b)
+                    {
+                        bool const equal[] = {
+                            equal_expr_::call(proto::v5::child<I>(a), proto::v5::child<I>(b))...
+                          , true
+                        };
+                        for(bool e : equal)
+                            if(!e)
+                                return false;
+                        return true;
+                    }
+                };
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // hash_value
+            // The structural hash of an expression. Expressions that are equal according to
+            // expr_equal_to with the same Policy have the same hash. All tags must have a tag_id.
+            template<typename Policy = hash_refs_by_value, typename E, BOOST_PROTO_ENABLE_IF(is_expr<E>::value)>
+            inline std::size_t hash_value(E const &e)
+            {
+                std::size_t seed = detail::shape_hash_<E>::value;
+                detail::hash_expr_<Policy>{seed}(e);
+                return seed;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // expr_hash, expr_equal_to
+            // Function objects for the keys of unordered containers. Since == on expressions
+            // builds an expression, unordered containers of expressions need expr_equal_to. It
+            // also compares expressions of different types with the same shape, such as an
+            // expression and its deep_copy.
+            template<typename Policy = hash_refs_by_value>
+            struct expr_hash
+            {
+                template<typename E>
+                std::size_t operator()(E const &e) const
+                {
+                    return proto::v5::hash_value<Policy>(e);
+                }
+            };
+
+            template<typename Policy = hash_refs_by_value>
+            struct expr_equal_to
+            {
+                template<typename A, typename B, BOOST_PROTO_ENABLE_IF(is_expr<A>::value && is_expr<B>::value)>
+                bool operator()(A const &a, B const &b) const
+                {
+                    return detail::equal_expr_<Policy>::call(a, b);
+                }
+            };
+        }
+    }
+}
+
+namespace std
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // basic_expr and expr hash by value. Expression types of your own can derive their
+    // specializations of std::hash from proto::expr_hash<>.
+    template<typename ExprDesc, typename Domain>
+    struct hash<boost::proto::v5::exprs::basic_expr<ExprDesc, Domain>>
+      : boost::proto::v5::expr_hash<>
+    {};
+
+    template<typename ExprDesc, typename Domain>
+    struct hash<boost::proto::v5::exprs::expr<ExprDesc, Domain>>
+      : boost::proto::v5::expr_hash<>
+    {};
+}
+
+#endif
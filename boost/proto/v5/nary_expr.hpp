@@ -0,0 +1,683 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// nary_expr.hpp
+// Expressions whose number of children is only known at runtime. The expression descriptor of
+// such an expression is a C-style variadic function type, Tag(Child...), which reads the same as
+// the grammar that matches it. All the children have the same type and are stored contiguously,
+// the first few of them inline. Domains that use make_flat_expr build such nodes from chains of
+// associative operators.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_NARY_EXPR_HPP_INCLUDED
+#define BOOST_PROTO_V5_NARY_EXPR_HPP_INCLUDED
+
+#include <new>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/domain.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/accessors.hpp>
+#include <boost/proto/v5/tags.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/detail/access.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            namespace exprs
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // nary_children
+                // A contiguous sequence of children that keeps up to InlineSize of them in the
+                // object itself and allocates only when it grows past that.
+                template<typename Child, std::size_t InlineSize>
+                struct nary_children
+                {
+                    static_assert(
+                        std::is_object<Child>::value
+                      , "The children of a runtime-arity expression must be held by value"
+                    );
+
+                    using value_type        = Child;
+                    using reference         = Child &;
+                    using const_reference   = Child const &;
+                    using iterator          = Child *;
+                    using const_iterator    = Child const *;
+                    using size_type         = std::size_t;
+                    using difference_type   = std::ptrdiff_t;
+
+                    nary_children() noexcept
+                      : begin_(this->inline_())
+                      , size_(0)
+                      , capacity_(InlineSize)
+                    {}
+
+                    nary_children(std::initializer_list<Child> children)
+                      : nary_children()
+                    {
+                        this->append_(children.begin(), children.end(), std::random_access_iterator_tag());
+                    }
+
+                    template<typename Iter
+                      , typename Cat = typename std::iterator_traits<Iter>::iterator_category>
+                    nary_children(Iter first, Iter last)
+                      : nary_children()
+                    {
+                        this->append_(first, last, Cat());
+                    }
+
+                    nary_children(nary_children const &that)
+                      : nary_children()
+                    {
+                        this->append_(that.begin(), that.end(), std::random_access_iterator_tag());
+                    }
+
+                    nary_children(nary_children &&that)
+                        noexcept(std::is_nothrow_move_constructible<Child>::value)
+                      : nary_children()
+                    {
+                        this->steal_(that);
+                    }
+
+                    nary_children &operator=(nary_children const &that)
+                    {
+                        if(this != &that)
+                        {
+                            this->clear();
+                            this->append_(that.begin(), that.end(), std::random_access_iterator_tag());
+                        }
+                        return *this;
+                    }
+
+                    nary_children &operator=(nary_children &&that)
+                        noexcept(std::is_nothrow_move_constructible<Child>::value)
+                    {
+                        if(this != &that)
+                        {
+                            this->clear();
+                            this->deallocate_();
+                            this->steal_(that);
+                        }
+                        return *this;
+                    }
+
+                    ~nary_children()
+                    {
+                        this->clear();
+                        this->deallocate_();
+                    }
+
+                    size_type size() const noexcept
+                    {
+                        return size_;
+                    }
+
+                    bool empty() const noexcept
+                    {
+                        return 0 == size_;
+                    }
+
+                    size_type capacity() const noexcept
+                    {
+                        return capacity_;
+                    }
+
+                    static constexpr size_type max_size() noexcept
+                    {
+                        return static_cast<size_type>(-1) / sizeof(Child);
+                    }
+
+                    iterator begin() noexcept
+                    {
+                        return begin_;
+                    }
+
+                    const_iterator begin() const noexcept
+                    {
+                        return begin_;
+                    }
+
+                    iterator end() noexcept
+                    {
+                        return begin_ + size_;
+                    }
+
+                    const_iterator end() const noexcept
+                    {
+                        return begin_ + size_;
+                    }
+
+                    Child & operator[](size_type i) noexcept
+                    {
+                        return begin_[i];
+                    }
+
+                    Child const & operator[](size_type i) const noexcept
+                    {
+                        return begin_[i];
+                    }
+
+                    void reserve(size_type n)
+                    {
+                        if(n > max_size())
+                            throw std::length_error("nary_children::reserve");
+                        if(n > capacity_)
+                            this->reallocate_(n);
+                    }
+
+                    void push_back(Child const &child)
+                    {
+                        this->emplace_back(child);
+                    }
+
+                    void push_back(Child &&child)
+                    {
+                        this->emplace_back(static_cast<Child &&>(child));
+                    }
+
+                    template<typename ...A>
+                    void emplace_back(A &&... a)
+                    {
+                        if(size_ == capacity_)
+                        {
+                            // The arguments may refer to a child that is about to move.
+                            Child child(static_cast<A &&>(a)...);
+                            this->reallocate_(this->grown_capacity_());
+                            ::new(static_cast<void *>(begin_ + size_)) Child(static_cast<Child &&>(child));
+                        }
+                        else
+                        {
+                            ::new(static_cast<void *>(begin_ + size_)) Child(static_cast<A &&>(a)...);
+                        }
+                        ++size_;
+                    }
+
+                    void pop_back() noexcept
+                    {
+                        begin_[--size_].~Child();
+                    }
+
+                    void clear() noexcept
+                    {
+                        while(0 != size_)
+                            this->pop_back();
+                    }
+
+                private:
+                    Child *inline_() noexcept
+                    {
+                        return static_cast<Child *>(static_cast<void *>(&inline_children_));
+                    }
+
+                    bool is_inline_() const noexcept
+                    {
+                        return static_cast<void const *>(begin_) == static_cast<void const *>(&inline_children_);
+                    }
+
+                    template<typename Iter>
+                    void append_(Iter first, Iter last, std::input_iterator_tag)
+                    {
+                        for(; first != last; ++first)
+                            this->emplace_back(*first);
+                    }
+
+                    // Doubles the capacity, but no further than max_size().
+                    size_type grown_capacity_() const
+                    {
+                        if(capacity_ == max_size())
+                            throw std::length_error("nary_children::emplace_back");
+                        return capacity_ < (max_size() - 1) / 2 ? capacity_ * 2 + 1 : max_size();
+                    }
+
+                    template<typename Iter>
+                    void append_(Iter first, Iter last, std::forward_iterator_tag)
+                    {
+                        size_type const n = static_cast<size_type>(std::distance(first, last));
+                        if(n > max_size() - size_)
+                            throw std::length_error("nary_children::append");
+                        this->reserve(size_ + n);
+                        for(; first != last; ++first)
+                            ::new(static_cast<void *>(begin_ + size_++)) Child(*first);
+                    }
+
+                    void reallocate_(size_type n)
+                    {
+                        Child *children = static_cast<Child *>(::operator new(n * sizeof(Child)));
+                        size_type i = 0;
+                        try
+                        {
+                            for(; i != size_; ++i)
+                                ::new(static_cast<void *>(children + i)) Child(std::move_if_noexcept(begin_[i]));
+                        }
+                        catch(...)
+                        {
+                            while(0 != i)
+                                children[--i].~Child();
+                            ::operator delete(children);
+                            throw;
+                        }
+                        for(i = 0; i != size_; ++i)
+                            begin_[i].~Child();
+                        this->deallocate_();
+                        begin_ = children;
+                        capacity_ = n;
+                    }
+
+                    void deallocate_() noexcept
+                    {
+                        if(!this->is_inline_())
+                            ::operator delete(begin_);
+                        begin_ = this->inline_();
+                        capacity_ = InlineSize;
+                    }
+
+                    // Precondition: *this is empty and holds no allocation.
+                    void steal_(nary_children &that)
+                    {
+                        if(that.is_inline_())
+                        {
+                            for(; size_ != that.size_; ++size_)
+                                ::new(static_cast<void *>(begin_ + size_)) Child(static_cast<Child &&>(that.begin_[size_]));
+                            that.clear();
+                        }
+                        else
+                        {
+                            begin_ = that.begin_;
+                            size_ = that.size_;
+                            capacity_ = that.capacity_;
+                            that.begin_ = that.inline_();
+                            that.size_ = 0;
+                            that.capacity_ = InlineSize;
+                        }
+                    }
+
+                    typename std::aligned_storage<
+                        sizeof(Child) * (InlineSize ? InlineSize : 1)
+                      , alignof(Child)
+                    >::type inline_children_;
+                    Child *begin_;
+                    size_type size_;
+                    size_type capacity_;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // struct basic_expr
+                // An expression with a runtime number of children. It has no proto_arity, so
+                // algorithms that need to know the number of children at compile time reject
+                // it.
+                template<typename Tag, typename Child, typename Domain>
+                struct basic_expr<Tag(Child...), Domain>
+                  : private detail::expr_storage_<Tag, nary_children<Child>>
+                {
+                private:
+                    friend struct access;
+
+                    using storage_type = detail::expr_storage_<Tag, nary_children<Child>>;
+
+                public:
+                    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(basic_expr);
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // usings and typedefs
+                    using proto_tag_type                = Tag;
+                    using proto_is_terminal_type        = std::false_type;
+                    using proto_children_type           = nary_children<Child>;
+                    using proto_domain_type             = Domain;
+                    using proto_expr_descriptor_type    = Tag(Child...);
+
+                    static_assert(
+                        !detail::is_terminal_tag<Tag>::value
+                      , "A terminal can't have a runtime number of children"
+                    );
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // constructors
+                    explicit basic_expr(Tag tag)
+                      : storage_type(static_cast<Tag &&>(tag))
+                    {}
+
+                    basic_expr(Tag tag, std::initializer_list<Child> children)
+                      : storage_type(static_cast<Tag &&>(tag), children)
+                    {}
+
+                    basic_expr(Tag tag, proto_children_type children)
+                      : storage_type(static_cast<Tag &&>(tag), static_cast<proto_children_type &&>(children))
+                    {}
+
+                    template<typename Iter
+                      , typename Cat = typename std::iterator_traits<Iter>::iterator_category>
+                    basic_expr(Tag tag, Iter first, Iter last)
+                      : storage_type(static_cast<Tag &&>(tag), first, last)
+                    {}
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // struct expr
+                template<typename Tag, typename Child, typename Domain>
+                struct expr<Tag(Child...), Domain>
+                  : basic_expr<Tag(Child...), Domain>
+                  , expr_assign<expr<Tag(Child...), Domain>>
+                  , expr_subscript<expr<Tag(Child...), Domain>>
+                  , expr_function<expr<Tag(Child...), Domain>>
+                {
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // constructors
+                    using basic_expr<Tag(Child...), Domain>::basic_expr;
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // operator=
+                    using expr_assign<expr>::operator=;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // struct expr
+                template<
+                    template<typename...> class DerivedExpr
+                  , typename Tag
+                  , typename Child
+                  , typename ...Rest
+                  , typename Domain
+                >
+                struct expr<DerivedExpr<Tag(Child...), Rest...>, Domain>
+                  : basic_expr<Tag(Child...), Domain>
+                  , expr_assign<DerivedExpr<Tag(Child...), Rest...>>
+                  , expr_subscript<DerivedExpr<Tag(Child...), Rest...>>
+                  , expr_function<DerivedExpr<Tag(Child...), Rest...>>
+                {
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // constructors
+                    using basic_expr<Tag(Child...), Domain>::basic_expr;
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // operator=
+                    using expr_assign<DerivedExpr<Tag(Child...), Rest...>>::operator=;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // children_of
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline typename basic_expr<ExprDesc, Domain>::proto_children_type & children_of(basic_expr<ExprDesc, Domain> &e) noexcept
+                {
+                    return access::proto_args(e);
+                }
+
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline typename basic_expr<ExprDesc, Domain>::proto_children_type const & children_of(basic_expr<ExprDesc, Domain> const &e) noexcept
+                {
+                    return access::proto_args(e);
+                }
+
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline typename basic_expr<ExprDesc, Domain>::proto_children_type && children_of(basic_expr<ExprDesc, Domain> &&e) noexcept
+                {
+                    return access::proto_args(static_cast<basic_expr<ExprDesc, Domain> &&>(e));
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // child, with an index known only at runtime
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline typename basic_expr<ExprDesc, Domain>::proto_children_type::value_type & child(basic_expr<ExprDesc, Domain> &e, std::size_t i) noexcept
+                {
+                    return access::proto_args(e)[i];
+                }
+
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline typename basic_expr<ExprDesc, Domain>::proto_children_type::value_type const & child(basic_expr<ExprDesc, Domain> const &e, std::size_t i) noexcept
+                {
+                    return access::proto_args(e)[i];
+                }
+
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline typename basic_expr<ExprDesc, Domain>::proto_children_type::value_type && child(basic_expr<ExprDesc, Domain> &&e, std::size_t i) noexcept
+                {
+                    return static_cast<typename basic_expr<ExprDesc, Domain>::proto_children_type::value_type &&>(access::proto_args(e)[i]);
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // tag_of
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline detail::tag_ref_<
+                    typename basic_expr<ExprDesc, Domain>::proto_tag_type
+                  , typename basic_expr<ExprDesc, Domain>::proto_tag_type &
+                >
+                tag_of(basic_expr<ExprDesc, Domain> &that) noexcept
+                {
+                    return access::proto_tag(that);
+                }
+
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline detail::tag_ref_<
+                    typename basic_expr<ExprDesc, Domain>::proto_tag_type
+                  , typename basic_expr<ExprDesc, Domain>::proto_tag_type const &
+                >
+                tag_of(basic_expr<ExprDesc, Domain> const &that) noexcept
+                {
+                    return access::proto_tag(that);
+                }
+
+                template<typename ExprDesc, typename Domain
+                  , BOOST_PROTO_ENABLE_IF(detail::is_nary_desc_<ExprDesc>::value)>
+                inline detail::tag_ref_<
+                    typename basic_expr<ExprDesc, Domain>::proto_tag_type
+                  , typename basic_expr<ExprDesc, Domain>::proto_tag_type &&
+                >
+                tag_of(basic_expr<ExprDesc, Domain> &&that) noexcept
+                {
+                    return access::proto_tag(static_cast<basic_expr<ExprDesc, Domain> &&>(that));
+                }
+            }
+
+            using exprs::children_of;
+            using exprs::child;
+            using exprs::tag_of;
+
+            namespace detail
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // as_basic_expr_
+                template<typename Tag, typename Child, typename Domain>
+                struct as_basic_expr_<Tag(Child...), Domain>
+                {
+                    using domain_type =
+                        typename make_domain<exprs::basic_expr<_, Domain>, Domain>::type;
+                    using expr_desc = Tag(typename as_child_<Child, domain_type>::type...);
+                    using type = exprs::basic_expr<expr_desc, domain_type>;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // as_expr_
+                template<typename Tag, typename Child, typename Domain>
+                struct as_expr_<Tag(Child...), Domain>
+                {
+                    using domain_type =
+                        typename make_domain<exprs::expr<_, Domain>, Domain>::type;
+                    using expr_desc = Tag(typename as_child_<Child, domain_type>::type...);
+                    using type = exprs::expr<expr_desc, domain_type>;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // nary_rebind_
+                // The type of a runtime-arity expression like Expr, but with children of type
+                // Child.
+                template<typename Expr, typename Child>
+                struct nary_rebind_;
+
+                template<
+                    template<typename...> class Expr
+                  , typename Tag
+                  , typename Child0
+                  , typename ...Rest
+                  , typename Child
+                >
+                struct nary_rebind_<Expr<Tag(Child0...), Rest...>, Child>
+                {
+                    using type = Expr<Tag(Child...), Rest...>;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // flat_operand_
+                // What an operand of an associative operator Tag contributes to a flattened node:
+                // the children of a runtime-arity Tag node, the two children of a binary Tag node
+                // whose children have the same type (ignoring whether each is held by reference),
+                // or else the operand itself.
+                template<typename Tag, typename Expr
+                  , typename ExprDesc = typename utility::uncvref<Expr>::proto_expr_descriptor_type>
+                struct flat_operand_
+                {
+                    using child_type = utility::uncvref<Expr>;
+                    using is_flat = std::false_type;
+
+                    static void append(exprs::nary_children<child_type> &children, Expr && e)
+                    {
+                        children.push_back(static_cast<Expr &&>(e));
+                    }
+
+                    static exprs::nary_children<child_type> take(Expr && e)
+                    {
+                        exprs::nary_children<child_type> children;
+                        flat_operand_::append(children, static_cast<Expr &&>(e));
+                        return children;
+                    }
+                };
+
+                template<typename Tag, typename Expr>
+                struct flat_pair_operand_
+                {
+                    using child_type =
+                        utility::uncvref<decltype(proto::v5::child<0>(std::declval<Expr>()))>;
+                    using is_flat = std::true_type;
+
+                    static void append(exprs::nary_children<child_type> &children, Expr && e)
+                    {
+                        children.push_back(proto::v5::child<0>(static_cast<Expr &&>(e)));
+                        children.push_back(proto::v5::child<1>(static_cast<Expr &&>(e)));
+                    }
+
+                    static exprs::nary_children<child_type> take(Expr && e)
+                    {
+                        exprs::nary_children<child_type> children;
+                        flat_pair_operand_::append(children, static_cast<Expr &&>(e));
+                        return children;
+                    }
+                };
+
+                template<typename Tag, typename Expr, typename L, typename R>
+                struct flat_operand_<Tag, Expr, Tag(L, R)>
+                  : std::conditional<
+                        std::is_same<utility::uncvref<L>, utility::uncvref<R>>::value
+                      , flat_pair_operand_<Tag, Expr>
+                      , flat_operand_<Tag, Expr, void>
+                    >::type
+                {};
+
+                template<typename Tag, typename Expr, typename Child>
+                struct flat_operand_<Tag, Expr, Tag(Child...)>
+                {
+                    using child_type = Child;
+                    using is_flat = std::true_type;
+
+                    static void append(exprs::nary_children<child_type> &children, Expr && e)
+                    {
+                        std::size_t const size = proto::v5::children_of(e).size();
+                        children.reserve(children.size() + size);
+                        for(std::size_t i = 0; i != size; ++i)
+                            children.push_back(proto::v5::child(static_cast<Expr &&>(e), i));
+                    }
+
+                    // An rvalue gives up its children wholesale, so a long left-leaning chain is
+                    // flattened in amortized constant time per operator.
+                    static exprs::nary_children<child_type> take(Expr && e)
+                    {
+                        return proto::v5::children_of(static_cast<Expr &&>(e));
+                    }
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // can_flatten_
+                template<typename Tag, typename ...T>
+                struct can_flatten_
+                  : std::false_type
+                {};
+
+                template<typename Tag, typename A, typename B>
+                struct flat_operands_
+                  : std::integral_constant<
+                        bool
+                      , (flat_operand_<Tag, A>::is_flat::value || flat_operand_<Tag, B>::is_flat::value) &&
+                        std::is_same<
+                            typename flat_operand_<Tag, A>::child_type
+                          , typename flat_operand_<Tag, B>::child_type
+                        >::value
+                    >
+                {};
+
+                template<typename Tag, typename A, typename B>
+                struct can_flatten_<Tag, A, B>
+                  : utility::and_<
+                        is_associative<utility::uncvref<Tag>>
+                      , flat_operands_<utility::uncvref<Tag>, A, B>
+                    >
+                {};
+            }
+
+            namespace domains
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // make_flat_expr
+                // Like make_custom_expr, except that an associative operator whose operand has the
+                // same operator becomes one runtime-arity node, so that a + b + c + d is a single
+                // plus node with four children rather than a tree three levels deep. This only
+                // happens when all the children would have the same type, which they then hold by
+                // value.
+                template<template<typename...> class Expr, typename ...Rest>
+                struct make_flat_expr<Expr<_, Rest...>>
+                {
+                    template<typename Tag, typename ...T
+                      , BOOST_PROTO_ENABLE_IF(!detail::can_flatten_<Tag, T...>::value)>
+                    inline constexpr auto operator()(Tag && tag, T &&... t) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        make_custom_expr<Expr<_, Rest...>>()(
+                            static_cast<Tag &&>(tag)
+                          , static_cast<T &&>(t)...
+                        )
+                    )
+
+                    template<typename Tag, typename A, typename B
+                      , BOOST_PROTO_ENABLE_IF(detail::can_flatten_<Tag, A, B>::value)
+                      , typename Child = typename detail::flat_operand_<utility::uncvref<Tag>, A>::child_type>
+                    Expr<utility::uncvref<Tag>(Child...), Rest...> operator()(Tag && tag, A && a, B && b) const
+                    {
+                        using tag_type = utility::uncvref<Tag>;
+                        exprs::nary_children<Child> children =
+                            detail::flat_operand_<tag_type, A>::take(static_cast<A &&>(a));
+                        detail::flat_operand_<tag_type, B>::append(children, static_cast<B &&>(b));
+                        return Expr<tag_type(Child...), Rest...>(
+                            static_cast<Tag &&>(tag)
+                          , static_cast<exprs::nary_children<Child> &&>(children)
+                        );
+                    }
+                };
+            }
+        }
+    }
+}
+
+#endif // BOOST_PROTO_V5_NARY_EXPR_HPP_INCLUDED
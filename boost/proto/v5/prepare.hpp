@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// prepare.hpp
+// Prepared expressions: an expression analyzed once and then evaluated many times, each time with
+// new arguments bound positionally to its parameter slots, without building an environment.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_PREPARE_HPP_INCLUDED
+#define BOOST_PROTO_V5_PREPARE_HPP_INCLUDED
+
+#include <tuple>
+#include <cstddef>
+#include <ostream>
+#include <utility>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/accessors.hpp>
+#include <boost/proto/v5/deep_copy.hpp>
+#include <boost/proto/v5/def.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/action/basic_action.hpp>
+#include <boost/proto/v5/action/eval.hpp>
+#include <boost/proto/v5/action/switch.hpp>
+#include <boost/proto/v5/grammar/case.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // param
+            // The value of a terminal that stands for the Ith argument of a prepared expression.
+            template<std::size_t I>
+            struct param
+            {
+                BOOST_PROTO_REGULAR_TRIVIAL_CLASS(param);
+
+                friend std::ostream &operator<<(std::ostream &sout, param)
+                {
+                    return sout << "param" << I;
+                }
+            };
+
+            namespace extension
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // param_index
+                // Specialize with a nested ::value to make terminals holding a T parameter slots,
+                // as with the placeholders of example/lambda.cpp.
+                template<typename T, typename Enable = void>
+                struct param_index
+                {};
+
+                template<std::size_t I>
+                struct param_index<param<I>>
+                  : std::integral_constant<std::size_t, I>
+                {};
+            }
+
+            namespace detail
+            {
+                template<typename T, typename Index = decltype(extension::param_index<T>::value)>
+                std::true_type is_param_(int);
+
+                template<typename T>
+                std::false_type is_param_(long);
+
+                template<typename T>
+                using is_param_t_ = decltype(detail::is_param_<T>(1));
+
+                template<typename T, bool IsParam = is_param_t_<T>::value>
+                struct param_arity_
+                  : std::integral_constant<std::size_t, 0>
+                {};
+
+                template<typename T>
+                struct param_arity_<T, true>
+                  : std::integral_constant<std::size_t, extension::param_index<T>::value + 1>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // prepared_arity_
+                // One more than the largest parameter index in Expr, or 0.
+                template<
+                    typename Expr
+                  , typename ExprDesc = typename Expr::proto_expr_descriptor_type
+                  , bool IsTerminal = Expr::proto_is_terminal_type::value
+                >
+                struct prepared_arity_;
+
+                template<typename Expr, typename Tag, typename Value>
+                struct prepared_arity_<Expr, Tag(Value), true>
+                  : param_arity_<utility::uncvref<Value>>
+                {};
+
+                template<typename Expr, typename Tag, typename ...Children>
+                struct prepared_arity_<Expr, Tag(Children...), false>
+                  : std::integral_constant<
+                        std::size_t
+                      , utility::size_ops::max(prepared_arity_<utility::uncvref<Children>>::value...)
+                    >
+                {};
+
+                template<typename Expr, typename Tag, typename Child>
+                struct prepared_arity_<Expr, Tag(Child...), false>
+                  : prepared_arity_<utility::uncvref<Child>>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // _prepared_value
+                // The argument bound to a parameter slot, or else the terminal's value.
+                struct _prepared_value
+                  : basic_action<_prepared_value>
+                {
+                    template<typename E, typename Slots
+                      , typename Value = utility::uncvref<decltype(proto::v5::value(std::declval<E>()))>
+                      , BOOST_PROTO_ENABLE_IF(is_param_t_<Value>::value)>
+                    constexpr auto operator()(E &&, Slots &slots) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        std::get<extension::param_index<Value>::value>(slots)
+                    )
+
+                    template<typename E, typename Slots
+                      , typename Value = utility::uncvref<decltype(proto::v5::value(std::declval<E>()))>
+                      , BOOST_PROTO_ENABLE_IF(!is_param_t_<Value>::value)>
+                    constexpr auto operator()(E && e, Slots &) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        proto::v5::value(static_cast<E &&>(e))
+                    )
+                };
+
+                struct _prepared_eval;
+
+                struct _prepared_eval_cases
+                {
+                    template<typename Tag, bool IsTerminal = Tag::proto_is_terminal_type::value>
+                    struct case_
+                      : _eval_case<_prepared_eval, Tag>
+                    {};
+
+                    template<typename Tag>
+                    struct case_<Tag, true>
+                      : def<proto::v5::case_(terminal(_), _prepared_value)>
+                    {};
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // _prepared_eval
+                // Evaluates an expression as _eval does, with the arguments bound to the parameter
+                // slots passed as a tuple in place of an environment.
+                struct _prepared_eval
+                  : detail::as_action_<switch_(detail::_prepared_eval_cases)>
+                {};
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // prepared
+            // A callable holding a copy of an expression, with its terminals stored by value.
+            // Parameter terminals are empty, so only the other terminals take up space. The
+            // arguments of a call are bound, in order, to slots 0 through arity-1 and are
+            // referred to, not copied.
+            template<typename Expr>
+            struct prepared
+            {
+                using expr_type = Expr;
+
+                static constexpr std::size_t arity = detail::prepared_arity_<Expr>::value;
+
+                explicit constexpr prepared(Expr const &e)
+                  : expr_(e)
+                {}
+
+                explicit constexpr prepared(Expr &&e)
+                  : expr_(static_cast<Expr &&>(e))
+                {}
+
+                Expr const &expr() const noexcept
+                {
+                    return expr_;
+                }
+
+                template<typename ...Args>
+                auto operator()(Args &&... args) const
+                  -> decltype(
+                        detail::_prepared_eval()(
+                            std::declval<Expr const &>()
+                          , std::declval<std::tuple<Args &&...> &>()
+                        )
+                    )
+                {
+                    static_assert(
+                        sizeof...(Args) == arity
+                      , "a prepared expression takes exactly one argument per parameter slot"
+                    );
+                    std::tuple<Args &&...> slots(static_cast<Args &&>(args)...);
+                    return detail::_prepared_eval()(expr_, slots);
+                }
+
+            private:
+                Expr expr_;
+            };
+
+            template<typename Expr>
+            constexpr std::size_t prepared<Expr>::arity;
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // prepare
+            // Copies e, with all its nodes and terminals stored by value, into a prepared
+            // expression.
+            template<typename E>
+            auto prepare(E && e)
+            BOOST_PROTO_AUTO_RETURN(
+                prepared<utility::uncvref<decltype(proto::v5::deep_copy(static_cast<E &&>(e)))>>(
+                    proto::v5::deep_copy(static_cast<E &&>(e))
+                )
+            )
+        }
+    }
+}
+
+#endif
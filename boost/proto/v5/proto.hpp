@@ -13,5 +13,11 @@
 #include <boost/proto/v5/debug.hpp>
 #include <boost/proto/v5/functional.hpp>
 #include <boost/proto/v5/action.hpp>
+#include <boost/proto/v5/any_expr.hpp>
+#include <boost/proto/v5/dag.hpp>
+#include <boost/proto/v5/bytecode.hpp>
+#include <boost/proto/v5/prepare.hpp>
+#include <boost/proto/v5/hash.hpp>
+#include <boost/proto/v5/cache.hpp>
 
 #endif
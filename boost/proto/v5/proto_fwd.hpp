@@ -68,6 +68,20 @@
     }                                                                                               \
     /**/
 
+// Define BOOST_PROTO_SHALLOW_CALL_STACKS to remove forwarding layers between Proto's actions
+// and the functions they call. In unoptimized builds, where each layer is a real function call,
+// this makes evaluation considerably faster and stack traces much shorter. It gives up the
+// detailed diagnostics of BOOST_PROTO_TRY_CALL, so it implies BOOST_PROTO_NDEBUG. For a
+// shallower evaluator, use proto::_shallow_eval in place of proto::_eval.
+#if defined(BOOST_PROTO_SHALLOW_CALL_STACKS) && !defined(BOOST_PROTO_NDEBUG)
+#define BOOST_PROTO_NDEBUG
+#endif
+
+// The number of children a runtime-arity expression stores inline before it allocates.
+#ifndef BOOST_PROTO_NARY_INLINE_CHILDREN
+#define BOOST_PROTO_NARY_INLINE_CHILDREN 4
+#endif
+
 namespace boost
 {
     namespace proto
@@ -112,6 +126,21 @@ namespace boost
                 template<typename Expr>
                 struct flat_view;
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // is_stateless_
+                // Expressions don't store tags or children of an empty, trivial type.
+                template<typename T>
+                struct is_stateless_
+                  : std::integral_constant<bool, std::is_empty<T>::value && std::is_trivial<T>::value>
+                {};
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // tag_ref_
+                // What the accessors return for an expression's tag, where Ref is the reference
+                // to a stored one. A stateless tag is a single shared instance, which is const.
+                template<typename Tag, typename Ref>
+                using tag_ref_ = typename std::conditional<is_stateless_<Tag>::value, Tag const &, Ref>::type;
+
                 template<typename T>
                 struct as_grammar_impl_;
 
@@ -130,6 +159,9 @@ namespace boost
                 template<typename Expr, typename Domain>
                 struct as_expr_;
 
+                template<typename ExprDesc>
+                struct is_nary_desc_;
+
                 struct def_base;
 
                 template<typename First, typename Second>
@@ -183,6 +215,11 @@ namespace boost
                 // identity
                 struct identity;
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // small_by_val
+                template<std::size_t MaxSize = 16>
+                struct small_by_val;
+
                 ////////////////////////////////////////////////////////////////////////////////////
                 // substitution_failure
                 template<typename Sig>
@@ -258,6 +295,7 @@ namespace boost
                 template<typename Tag, typename Domain> struct proto_expr;
                 template<typename Tag, typename Domain> struct proto_expr_iterator;
                 template<typename Tag, typename Domain> struct proto_flat_view;
+                template<typename Tag, typename Domain> struct proto_flat_view_iterator;
             }
 
             using namespace tags;
@@ -273,6 +311,7 @@ namespace boost
             struct and_;
             struct if_;
             struct switch_;
+            struct switch_on;
             struct case_;
             struct default_;
             struct match;
@@ -298,6 +337,9 @@ namespace boost
             template<typename T>
             struct is_tag;
 
+            template<typename Tag>
+            struct is_associative;
+
             template<typename T>
             struct is_domain;
 
@@ -333,6 +375,9 @@ namespace boost
                 struct make_custom_expr;
 
                 using default_make_expr = make_custom_expr<detail::default_expr<_>>;
+
+                template<typename Expr>
+                struct make_flat_expr;
             }
 
             using domains::no_super_domain;
@@ -343,6 +388,7 @@ namespace boost
             using domains::basic_default_domain;
             using domains::make_custom_expr;
             using domains::default_make_expr;
+            using domains::make_flat_expr;
 
             namespace functional
             {
@@ -373,6 +419,9 @@ namespace boost
                 template<typename ...T>
                 struct children;
 
+                template<typename Child, std::size_t InlineSize = BOOST_PROTO_NARY_INLINE_CHILDREN>
+                struct nary_children;
+
                 template<std::size_t I, typename Children>
                 struct children_element;
 
@@ -399,20 +448,24 @@ namespace boost
                 template<typename Expr>
                 struct virtual_;
 
+                template<typename Domain = default_domain>
+                struct any_expr;
+
                 template<typename Tag, typename ...Children, typename Domain>
-                constexpr Tag &tag_of(basic_expr<Tag(Children...), Domain> &that) noexcept;
+                constexpr detail::tag_ref_<Tag, Tag &> tag_of(basic_expr<Tag(Children...), Domain> &that) noexcept;
 
                 template<typename Tag, typename ...Children, typename Domain>
-                constexpr Tag const &tag_of(basic_expr<Tag(Children...), Domain> const &that) noexcept;
+                constexpr detail::tag_ref_<Tag, Tag const &> tag_of(basic_expr<Tag(Children...), Domain> const &that) noexcept;
 
                 template<typename Tag, typename ...Children, typename Domain>
-                constexpr Tag &&tag_of(basic_expr<Tag(Children...), Domain> &&that) noexcept;
+                constexpr detail::tag_ref_<Tag, Tag &&> tag_of(basic_expr<Tag(Children...), Domain> &&that) noexcept;
             }
 
             using exprs::expr_assign;
             using exprs::expr_subscript;
             using exprs::expr_function;
             using exprs::expr_base;
+            using exprs::any_expr;
             using exprs::tag_of;
 
             template<typename ExprDesc, typename Domain = basic_default_domain>
@@ -490,6 +543,8 @@ namespace boost
 
             struct _eval;
 
+            struct _shallow_eval;
+
             struct eval_with;
 
             template<typename T>
@@ -497,6 +552,8 @@ namespace boost
 
             struct _deep_copy;
 
+            struct _lower;
+
             struct _tag_of;
 
             struct _arity_of;
@@ -539,6 +596,9 @@ namespace boost
 
             struct external;
 
+            template<typename ...Cases>
+            struct action_table;
+
             ////////////////////////////////////////////////////////////////////////////////////////
             // Misc. traits
             template<typename T>
@@ -547,6 +607,9 @@ namespace boost
             template<typename Expr>
             struct is_terminal;
 
+            template<typename Expr>
+            struct is_nary;
+
             ////////////////////////////////////////////////////////////////////////////////////////
             // Stuff for grammar building
             template<typename T>
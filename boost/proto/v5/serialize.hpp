@@ -0,0 +1,409 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// serialize.hpp
+// A compact binary form of expressions, and its reconstruction into a given static expression
+// type. Each node is written as its tag's id, followed by its number of children and then the
+// children themselves, or by its value if it is a terminal. Values are written by the
+// serialization trait, which by default copies trivially copyable values verbatim, suitably
+// aligned, so that a terminal holding a const reference can refer to them in place in a
+// memory-mapped buffer. Data are written in the machine's native byte order.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_SERIALIZE_HPP_INCLUDED
+#define BOOST_PROTO_V5_SERIALIZE_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/children.hpp>
+#include <boost/proto/v5/expr.hpp>
+#include <boost/proto/v5/nary_expr.hpp>
+#include <boost/proto/v5/tags.hpp>
+#include <boost/proto/v5/utility.hpp>
+#include <boost/proto/v5/detail/access.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // deserialize_error
+            // Thrown when a buffer doesn't hold an expression of the requested type.
+            struct deserialize_error
+              : std::runtime_error
+            {
+                explicit deserialize_error(char const *what)
+                  : std::runtime_error(what)
+                {}
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // binary_writer
+            // Appends to a buffer of bytes. Alignment is relative to the start of the buffer.
+            struct binary_writer
+            {
+                explicit binary_writer(std::vector<char> &out) noexcept
+                  : out_(out)
+                {}
+
+                void write(void const *data, std::size_t size)
+                {
+                    char const *p = static_cast<char const *>(data);
+                    out_.insert(out_.end(), p, p + size);
+                }
+
+                void align(std::size_t align)
+                {
+                    out_.resize((out_.size() + align - 1) / align * align, '\0');
+                }
+
+                std::size_t size() const noexcept
+                {
+                    return out_.size();
+                }
+
+            private:
+                std::vector<char> &out_;
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // binary_reader
+            // Reads from a buffer of bytes written by a binary_writer, starting from the same
+            // point in the buffer.
+            struct binary_reader
+            {
+                binary_reader(char const *data, std::size_t size) noexcept
+                  : begin_(data)
+                  , pos_(data)
+                  , end_(data + size)
+                {}
+
+                char const *read(std::size_t size)
+                {
+                    if(size > static_cast<std::size_t>(end_ - pos_))
+                        throw deserialize_error("unexpected end of serialized expression");
+                    char const *p = pos_;
+                    pos_ += size;
+                    return p;
+                }
+
+                void align(std::size_t align)
+                {
+                    std::size_t const offset = static_cast<std::size_t>(pos_ - begin_);
+                    this->read((offset + align - 1) / align * align - offset);
+                }
+
+                std::size_t remaining() const noexcept
+                {
+                    return static_cast<std::size_t>(end_ - pos_);
+                }
+
+            private:
+                char const *begin_;
+                char const *pos_;
+                char const *end_;
+            };
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // serialization
+            // How a terminal's value of type T is written and read back. Specialize it for your
+            // own types. view is optional; it is needed only to read into terminals that hold
+            // their values by const reference. A saved value must take at least one byte.
+            template<typename T>
+            struct serialization
+            {
+                static_assert(
+                    std::is_trivially_copyable<T>::value && !std::is_array<T>::value
+                  , "Don't know how to serialize this type. Specialize proto::serialization for it."
+                );
+
+                static void save(binary_writer &out, T const &t)
+                {
+                    out.align(alignof(T));
+                    out.write(std::addressof(t), sizeof(T));
+                }
+
+                static T load(binary_reader &in)
+                {
+                    typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer;
+                    std::memcpy(&buffer, serialization::view_bytes_(in), sizeof(T));
+                    return reinterpret_cast<T const &>(buffer);
+                }
+
+                static T const &view(binary_reader &in)
+                {
+                    char const *p = serialization::view_bytes_(in);
+                    if(0 != reinterpret_cast<std::uintptr_t>(p) % alignof(T))
+                        throw deserialize_error("serialized expression is not suitably aligned");
+                    return *reinterpret_cast<T const *>(p);
+                }
+
+            private:
+                static char const *view_bytes_(binary_reader &in)
+                {
+                    in.align(alignof(T));
+                    return in.read(sizeof(T));
+                }
+            };
+
+            namespace detail
+            {
+                // Reads the number of elements of a sequence, each of which takes at least
+                // min_bytes, so a corrupt size is caught before anything is allocated for it.
+                inline std::size_t load_size_(binary_reader &in, std::size_t min_bytes)
+                {
+                    std::uint64_t const size = serialization<std::uint64_t>::load(in);
+                    if(size > in.remaining() / min_bytes)
+                        throw deserialize_error("serialized sequence is longer than its data");
+                    return static_cast<std::size_t>(size);
+                }
+            }
+
+            template<typename Char, typename Traits, typename Alloc>
+            struct serialization<std::basic_string<Char, Traits, Alloc>>
+            {
+                static void save(binary_writer &out, std::basic_string<Char, Traits, Alloc> const &t)
+                {
+                    serialization<std::uint64_t>::save(out, t.size());
+                    out.write(t.data(), t.size() * sizeof(Char));
+                }
+
+                static std::basic_string<Char, Traits, Alloc> load(binary_reader &in)
+                {
+                    std::size_t const size = detail::load_size_(in, sizeof(Char));
+                    char const *data = in.read(size * sizeof(Char));
+                    std::basic_string<Char, Traits, Alloc> t(size, Char());
+                    std::memcpy(&t[0], data, size * sizeof(Char));
+                    return t;
+                }
+            };
+
+            template<typename T, typename Alloc>
+            struct serialization<std::vector<T, Alloc>>
+            {
+                static void save(binary_writer &out, std::vector<T, Alloc> const &t)
+                {
+                    serialization<std::uint64_t>::save(out, t.size());
+                    for(auto const &u : t)
+                        serialization<T>::save(out, u);
+                }
+
+                static std::vector<T, Alloc> load(binary_reader &in)
+                {
+                    std::size_t const size = detail::load_size_(in, 1);
+                    std::vector<T, Alloc> t;
+                    t.reserve(size);
+                    for(std::size_t i = 0; i != size; ++i)
+                        t.push_back(serialization<T>::load(in));
+                    return t;
+                }
+            };
+
+            namespace detail
+            {
+                template<typename Tag>
+                inline void save_tag_(binary_writer &out)
+                {
+                    static_assert(
+                        std::is_empty<utility::uncvref<Tag>>::value
+                      , "Only expressions with stateless tags can be serialized"
+                    );
+                    unsigned char const id = tag_id<utility::uncvref<Tag>>::value;
+                    out.write(&id, 1);
+                }
+
+                template<typename Tag>
+                inline void load_tag_(binary_reader &in)
+                {
+                    unsigned char id;
+                    std::memcpy(&id, in.read(1), 1);
+                    if(tag_id<Tag>::value != id)
+                        throw deserialize_error("serialized expression has the wrong tag");
+                }
+
+                inline void save_arity_(binary_writer &out, std::size_t arity)
+                {
+                    std::uint32_t const n = static_cast<std::uint32_t>(arity);
+                    out.write(&n, sizeof(n));
+                }
+
+                inline std::size_t load_arity_(binary_reader &in)
+                {
+                    std::uint32_t n;
+                    std::memcpy(&n, in.read(sizeof(n)), sizeof(n));
+                    return n;
+                }
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // serialize_expr_
+                struct serialize_expr_
+                {
+                    explicit serialize_expr_(binary_writer &out) noexcept
+                      : out_(out)
+                    {}
+
+                    template<typename E, BOOST_PROTO_ENABLE_IF(is_terminal<E>::value)>
+                    void operator()(E const &e) const
+                    {
+                        using value_type = utility::uncvref<decltype(proto::v5::value(e))>;
+                        detail::save_tag_<typename result_of::tag_of<E>::type>(this->out_);
+                        serialization<value_type>::save(this->out_, proto::v5::value(e));
+                    }
+
+                    template<typename E, BOOST_PROTO_ENABLE_IF(!is_terminal<E>::value && !is_nary<E>::value)>
+                    void operator()(E const &e) const
+                    {
+                        detail::save_tag_<typename result_of::tag_of<E>::type>(this->out_);
+                        detail::save_arity_(this->out_, result_of::arity_of<E>::value);
+                        exprs::for_each(exprs::access::proto_args(e), *this);
+                    }
+
+                    template<typename E, BOOST_PROTO_ENABLE_IF(is_nary<E>::value)>
+                    void operator()(E const &e) const
+                    {
+                        detail::save_tag_<typename result_of::tag_of<E>::type>(this->out_);
+                        detail::save_arity_(this->out_, proto::v5::children_of(e).size());
+                        for(auto const &child : proto::v5::children_of(e))
+                            (*this)(child);
+                    }
+
+                private:
+                    binary_writer &out_;
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // load_value_
+                // Terminals that hold their values by const reference refer to them in place.
+                template<typename T>
+                struct load_value_
+                {
+                    static T load(binary_reader &in)
+                    {
+                        return serialization<T>::load(in);
+                    }
+                };
+
+                template<typename T>
+                struct load_value_<T const &>
+                {
+                    static T const &load(binary_reader &in)
+                    {
+                        return serialization<T>::view(in);
+                    }
+                };
+
+                template<typename T>
+                struct load_value_<T &>
+                {
+                    static_assert(
+                        utility::never<T>::value
+                      , "Can't deserialize into a terminal that holds its value by non-const reference"
+                    );
+                };
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // deserialize_expr_
+                template<typename Expr
+                  , typename ExprDesc = typename Expr::proto_expr_descriptor_type
+                  , bool IsTerminal = is_terminal<Expr>::value>
+                struct deserialize_expr_;
+
+                template<typename Expr, typename Tag, typename Value>
+                struct deserialize_expr_<Expr, Tag(Value), true>
+                {
+                    static Expr load(binary_reader &in)
+                    {
+                        detail::load_tag_<Tag>(in);
+                        return Expr{Tag(), load_value_<Value>::load(in)};
+                    }
+                };
+
+                template<typename Expr, typename Tag, typename ...Children>
+                struct deserialize_expr_<Expr, Tag(Children...), false>
+                {
+                    static_assert(
+                        utility::and_<std::is_object<Children>...>::value
+                      , "Can only deserialize into expressions that hold their children by value"
+                    );
+
+                    static Expr load(binary_reader &in)
+                    {
+                        detail::load_tag_<Tag>(in);
+                        if(sizeof...(Children) != detail::load_arity_(in))
+                            throw deserialize_error("serialized expression has the wrong number of children");
+                        // The elements of a braced-init-list are evaluated in order
+                        return Expr{Tag(), deserialize_expr_<Children>::load(in)...};
+                    }
+                };
+
+                template<typename Expr, typename Tag, typename Child>
+                struct deserialize_expr_<Expr, Tag(Child...), false>
+                {
+                    static Expr load(binary_reader &in)
+                    {
+                        detail::load_tag_<Tag>(in);
+                        std::size_t const size = detail::load_arity_(in);
+                        // Each child takes at least its tag's byte
+                        if(size > in.remaining())
+                            throw deserialize_error("serialized expression is shorter than its children");
+                        Expr e{Tag()};
+                        proto::v5::children_of(e).reserve(size);
+                        for(std::size_t i = 0; i != size; ++i)
+                            proto::v5::children_of(e).push_back(deserialize_expr_<Child>::load(in));
+                        return e;
+                    }
+                };
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // serialize
+            // Appends the binary form of e to out.
+            template<typename E>
+            inline void serialize(E const &e, binary_writer &out)
+            {
+                detail::serialize_expr_{out}(e);
+            }
+
+            template<typename E>
+            inline void serialize(E const &e, std::vector<char> &out)
+            {
+                binary_writer writer(out);
+                proto::v5::serialize(e, writer);
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // deserialize
+            // Reads back an expression of type Expr. Throws deserialize_error if the data don't
+            // describe an expression with the same shape. Terminals that hold their values by
+            // const reference refer to the buffer, which must then outlive the expression and, for
+            // types with alignment requirements, be suitably aligned.
+            template<typename Expr>
+            inline Expr deserialize(binary_reader &in)
+            {
+                return detail::deserialize_expr_<Expr>::load(in);
+            }
+
+            template<typename Expr>
+            inline Expr deserialize(char const *data, std::size_t size)
+            {
+                binary_reader reader(data, size);
+                Expr e = proto::v5::deserialize<Expr>(reader);
+                if(0 != reader.remaining())
+                    throw deserialize_error("unexpected data after serialized expression");
+                return e;
+            }
+        }
+    }
+}
+
+#endif
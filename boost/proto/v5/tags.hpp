@@ -470,6 +470,140 @@ namespace boost
               : std::is_base_of<expr_tag_base, T>
             {};
 
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // is_associative
+            // Whether (a op b) op c means the same as a op (b op c). Domains that flatten chains of
+            // associative operators into a single node consult this; specialize it for your own
+            // tags as needed.
+            template<typename Tag>
+            struct is_associative
+              : std::false_type
+            {};
+
+            template<typename Tag>
+            struct is_associative<Tag &>
+              : is_associative<Tag>
+            {};
+
+            template<typename Tag>
+            struct is_associative<Tag &&>
+              : is_associative<Tag>
+            {};
+
+            template<>
+            struct is_associative<plus>
+              : std::true_type
+            {};
+
+            template<>
+            struct is_associative<multiplies>
+              : std::true_type
+            {};
+
+            template<>
+            struct is_associative<logical_and>
+              : std::true_type
+            {};
+
+            template<>
+            struct is_associative<logical_or>
+              : std::true_type
+            {};
+
+            template<>
+            struct is_associative<bitwise_and>
+              : std::true_type
+            {};
+
+            template<>
+            struct is_associative<bitwise_or>
+              : std::true_type
+            {};
+
+            template<>
+            struct is_associative<bitwise_xor>
+              : std::true_type
+            {};
+
+            ////////////////////////////////////////////////////////////////////////////////////////
+            // tag_id
+            // A number that stands for a tag at runtime, e.g. in serialized expressions. Proto's own
+            // tags use numbers below 64; specialize this for your own tags with numbers from 64 to
+            // 255.
+            template<typename Tag>
+            struct tag_id;
+
+            template<typename Tag>
+            struct tag_id<Tag &>
+              : tag_id<Tag>
+            {};
+
+            template<typename Tag>
+            struct tag_id<Tag &&>
+              : tag_id<Tag>
+            {};
+
+            template<typename Tag>
+            struct tag_id<Tag const>
+              : tag_id<Tag>
+            {};
+
+        #define BOOST_PROTO_DEFINE_TAG_ID(TAG, ID)                                                  \
+            template<>                                                                              \
+            struct tag_id<TAG>                                                                      \
+              : std::integral_constant<unsigned char, ID>                                           \
+            {};                                                                                     \
+            /**/
+
+            BOOST_PROTO_DEFINE_TAG_ID(terminal, 0)
+            BOOST_PROTO_DEFINE_TAG_ID(unary_plus, 1)
+            BOOST_PROTO_DEFINE_TAG_ID(negate, 2)
+            BOOST_PROTO_DEFINE_TAG_ID(dereference, 3)
+            BOOST_PROTO_DEFINE_TAG_ID(complement, 4)
+            BOOST_PROTO_DEFINE_TAG_ID(address_of, 5)
+            BOOST_PROTO_DEFINE_TAG_ID(logical_not, 6)
+            BOOST_PROTO_DEFINE_TAG_ID(pre_inc, 7)
+            BOOST_PROTO_DEFINE_TAG_ID(pre_dec, 8)
+            BOOST_PROTO_DEFINE_TAG_ID(post_inc, 9)
+            BOOST_PROTO_DEFINE_TAG_ID(post_dec, 10)
+            BOOST_PROTO_DEFINE_TAG_ID(shift_left, 11)
+            BOOST_PROTO_DEFINE_TAG_ID(shift_right, 12)
+            BOOST_PROTO_DEFINE_TAG_ID(multiplies, 13)
+            BOOST_PROTO_DEFINE_TAG_ID(divides, 14)
+            BOOST_PROTO_DEFINE_TAG_ID(modulus, 15)
+            BOOST_PROTO_DEFINE_TAG_ID(plus, 16)
+            BOOST_PROTO_DEFINE_TAG_ID(minus, 17)
+            BOOST_PROTO_DEFINE_TAG_ID(less, 18)
+            BOOST_PROTO_DEFINE_TAG_ID(greater, 19)
+            BOOST_PROTO_DEFINE_TAG_ID(less_equal, 20)
+            BOOST_PROTO_DEFINE_TAG_ID(greater_equal, 21)
+            BOOST_PROTO_DEFINE_TAG_ID(equal_to, 22)
+            BOOST_PROTO_DEFINE_TAG_ID(not_equal_to, 23)
+            BOOST_PROTO_DEFINE_TAG_ID(logical_or, 24)
+            BOOST_PROTO_DEFINE_TAG_ID(logical_and, 25)
+            BOOST_PROTO_DEFINE_TAG_ID(bitwise_and, 26)
+            BOOST_PROTO_DEFINE_TAG_ID(bitwise_or, 27)
+            BOOST_PROTO_DEFINE_TAG_ID(bitwise_xor, 28)
+            BOOST_PROTO_DEFINE_TAG_ID(comma, 29)
+            BOOST_PROTO_DEFINE_TAG_ID(mem_ptr, 30)
+            BOOST_PROTO_DEFINE_TAG_ID(assign, 31)
+            BOOST_PROTO_DEFINE_TAG_ID(shift_left_assign, 32)
+            BOOST_PROTO_DEFINE_TAG_ID(shift_right_assign, 33)
+            BOOST_PROTO_DEFINE_TAG_ID(multiplies_assign, 34)
+            BOOST_PROTO_DEFINE_TAG_ID(divides_assign, 35)
+            BOOST_PROTO_DEFINE_TAG_ID(modulus_assign, 36)
+            BOOST_PROTO_DEFINE_TAG_ID(plus_assign, 37)
+            BOOST_PROTO_DEFINE_TAG_ID(minus_assign, 38)
+            BOOST_PROTO_DEFINE_TAG_ID(bitwise_and_assign, 39)
+            BOOST_PROTO_DEFINE_TAG_ID(bitwise_or_assign, 40)
+            BOOST_PROTO_DEFINE_TAG_ID(bitwise_xor_assign, 41)
+            BOOST_PROTO_DEFINE_TAG_ID(subscript, 42)
+            BOOST_PROTO_DEFINE_TAG_ID(if_else_, 43)
+            BOOST_PROTO_DEFINE_TAG_ID(function, 44)
+            BOOST_PROTO_DEFINE_TAG_ID(member, 45)
+
+        #undef BOOST_PROTO_DEFINE_TAG_ID
+
             ////////////////////////////////////////////////////////////////////////////////////////
             // _tag_of
             struct _tag_of
@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// tuple.hpp
+// Make expressions and their children<> tuple-like: std::tuple_size, std::tuple_element and get
+// are defined for them, so that structured bindings and algorithms written over index sequences
+// can get at the children without going through the Fusion adaptation in fusion.hpp.
+// Expressions with a runtime number of children (see nary_expr.hpp) are not tuple-like.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_TUPLE_HPP_INCLUDED
+#define BOOST_PROTO_V5_TUPLE_HPP_INCLUDED
+
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <boost/proto/v5/proto_fwd.hpp>
+#include <boost/proto/v5/children.hpp>
+#include <boost/proto/v5/accessors.hpp>
+
+namespace boost
+{
+    namespace proto
+    {
+        inline namespace v5
+        {
+            namespace exprs
+            {
+                ////////////////////////////////////////////////////////////////////////////////////
+                // get
+                // The Ith child of an expression; the same as child<I>. Found by ADL, as
+                // structured bindings require.
+                template<std::size_t I, typename ExprDesc, typename Domain>
+                inline constexpr auto get(basic_expr<ExprDesc, Domain> &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<I>(e)
+                )
+
+                template<std::size_t I, typename ExprDesc, typename Domain>
+                inline constexpr auto get(basic_expr<ExprDesc, Domain> const &e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<I>(e)
+                )
+
+                template<std::size_t I, typename ExprDesc, typename Domain>
+                inline constexpr auto get(basic_expr<ExprDesc, Domain> &&e)
+                BOOST_PROTO_AUTO_RETURN(
+                    exprs::child<I>(static_cast<basic_expr<ExprDesc, Domain> &&>(e))
+                )
+            }
+
+            namespace detail
+            {
+                template<typename ...Children>
+                struct tuple_size_
+                  : std::integral_constant<std::size_t, sizeof...(Children)>
+                {};
+
+                template<std::size_t I, typename ...Children>
+                struct tuple_element_
+                  : exprs::children_element<I, exprs::children<Children...>>
+                {};
+            }
+
+            using exprs::get;
+        }
+    }
+}
+
+namespace std
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // children<>
+    template<typename ...T>
+    struct tuple_size<boost::proto::v5::exprs::children<T...>>
+      : boost::proto::v5::detail::tuple_size_<T...>
+    {};
+
+    template<std::size_t I, typename ...T>
+    struct tuple_element<I, boost::proto::v5::exprs::children<T...>>
+      : boost::proto::v5::detail::tuple_element_<I, T...>
+    {};
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // basic_expr and expr. A terminal is a tuple of one element, its value. Expression types of
+    // your own that derive from basic_expr can be made tuple-like the same way.
+    template<typename Tag, typename ...Children, typename Domain>
+    struct tuple_size<boost::proto::v5::exprs::basic_expr<Tag(Children...), Domain>>
+      : boost::proto::v5::detail::tuple_size_<Children...>
+    {};
+
+    template<std::size_t I, typename Tag, typename ...Children, typename Domain>
+    struct tuple_element<I, boost::proto::v5::exprs::basic_expr<Tag(Children...), Domain>>
+      : boost::proto::v5::detail::tuple_element_<I, Children...>
+    {};
+
+    template<typename Tag, typename ...Children, typename Domain>
+    struct tuple_size<boost::proto::v5::exprs::expr<Tag(Children...), Domain>>
+      : boost::proto::v5::detail::tuple_size_<Children...>
+    {};
+
+    template<std::size_t I, typename Tag, typename ...Children, typename Domain>
+    struct tuple_element<I, boost::proto::v5::exprs::expr<Tag(Children...), Domain>>
+      : boost::proto::v5::detail::tuple_element_<I, Children...>
+    {};
+
+    template<
+        template<typename...> class DerivedExpr
+      , typename Tag
+      , typename ...Children
+      , typename ...Rest
+      , typename Domain
+    >
+    struct tuple_size<boost::proto::v5::exprs::expr<DerivedExpr<Tag(Children...), Rest...>, Domain>>
+      : boost::proto::v5::detail::tuple_size_<Children...>
+    {};
+
+    template<
+        std::size_t I
+      , template<typename...> class DerivedExpr
+      , typename Tag
+      , typename ...Children
+      , typename ...Rest
+      , typename Domain
+    >
+    struct tuple_element<I, boost::proto::v5::exprs::expr<DerivedExpr<Tag(Children...), Rest...>, Domain>>
+      : boost::proto::v5::detail::tuple_element_<I, Children...>
+    {};
+}
+
+#endif
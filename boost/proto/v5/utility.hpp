@@ -256,6 +256,23 @@ namespace boost
                 template<typename T>
                 inline constexpr auto by_val_(T const &t, long)
                     BOOST_PROTO_AUTO_RETURN(t)
+
+                ////////////////////////////////////////////////////////////////////////////////////
+                // is_small_value_
+                // Arrays and functions can't be returned by value, so they are never small.
+                template<typename T, std::size_t MaxSize
+                  , bool IsObject = std::is_object<T>::value && !std::is_array<T>::value>
+                struct is_small_value_
+                  : std::integral_constant<
+                        bool
+                      , sizeof(T) <= MaxSize && std::is_trivially_copyable<T>::value
+                    >
+                {};
+
+                template<typename T, std::size_t MaxSize>
+                struct is_small_value_<T, MaxSize, false>
+                  : std::false_type
+                {};
             }
 
             namespace utility
@@ -271,6 +288,26 @@ namespace boost
                     )
                 };
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // by_val_arg
+                // Like by_val, but for arguments that are consumed before the end of the full
+                // expression: rvalues are passed along without being moved into a temporary
+                // first, so the callee can move from them directly.
+                struct by_val_arg
+                {
+                    template<typename T, BOOST_PROTO_ENABLE_IF(!std::is_reference<T>::value)>
+                    inline constexpr T && operator()(T &&t) const noexcept
+                    {
+                        return static_cast<T &&>(t);
+                    }
+
+                    template<typename T>
+                    inline constexpr auto operator()(T &t) const
+                    BOOST_PROTO_AUTO_RETURN(
+                        detail::by_val_(t, 1)
+                    )
+                };
+
                 ////////////////////////////////////////////////////////////////////////////////////
                 // by_ref
                 struct by_ref
@@ -282,6 +319,29 @@ namespace boost
                     }
                 };
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // small_by_val
+                // Stores trivially copyable objects no bigger than MaxSize bytes by value, since
+                // they cost less to copy than to get at through a reference. Anything else is
+                // stored as by identity: lvalues by reference, and rvalues moved in.
+                template<std::size_t MaxSize>
+                struct small_by_val
+                {
+                    template<typename T, typename U = utility::uncvref<T>
+                      , BOOST_PROTO_ENABLE_IF(detail::is_small_value_<U, MaxSize>::value)>
+                    inline constexpr U operator()(T &&t) const noexcept(noexcept(U(static_cast<T &&>(t))))
+                    {
+                        return static_cast<T &&>(t);
+                    }
+
+                    template<typename T, typename U = utility::uncvref<T>
+                      , BOOST_PROTO_ENABLE_IF(!detail::is_small_value_<U, MaxSize>::value)>
+                    inline constexpr T operator()(T &&t) const noexcept(noexcept(T(static_cast<T &&>(t))))
+                    {
+                        return static_cast<T &&>(t);
+                    }
+                };
+
                 ////////////////////////////////////////////////////////////////////////////////////
                 // logical_ops
                 struct logical_ops
@@ -339,6 +399,41 @@ namespace boost
                     }
                 };
 
+                ////////////////////////////////////////////////////////////////////////////////////
+                // size_ops
+                // The sum and maximum of a list of sizes, in constant expressions. Each recursion
+                // step evaluates the rest of the list once.
+                struct size_ops
+                {
+                    static inline constexpr std::size_t sum() noexcept
+                    {
+                        return 0;
+                    }
+
+                    template<typename ...Size, typename Impl = size_ops>
+                    static inline constexpr std::size_t sum(std::size_t s0, Size... rest) noexcept
+                    {
+                        return s0 + Impl::sum(rest...);
+                    }
+
+                    static inline constexpr std::size_t max() noexcept
+                    {
+                        return 0;
+                    }
+
+                    template<typename ...Size, typename Impl = size_ops>
+                    static inline constexpr std::size_t max(std::size_t s0, Size... rest) noexcept
+                    {
+                        return Impl::max2_(s0, Impl::max(rest...));
+                    }
+
+                private:
+                    static inline constexpr std::size_t max2_(std::size_t s0, std::size_t s1) noexcept
+                    {
+                        return s0 > s1 ? s0 : s1;
+                    }
+                };
+
                 ////////////////////////////////////////////////////////////////////////////////////
                 // lazy_condition
                 template<bool Cond, typename Fun0, typename Fun1>
@@ -435,9 +530,27 @@ namespace boost
 
                 ////////////////////////////////////////////////////////////////////////////////////
                 // concat
-                template<typename List0, typename List1>
+                // Concatenates any number of lists. The result has the form of the first.
+                template<typename ...Lists>
                 struct concat;
 
+                template<>
+                struct concat<>
+                {
+                    using type = list<>;
+                };
+
+                template<typename List0>
+                struct concat<List0>
+                {
+                    using type = List0;
+                };
+
+                template<typename List0, typename List1, typename List2, typename ...Rest>
+                struct concat<List0, List1, List2, Rest...>
+                  : concat<typename concat<List0, List1>::type, List2, Rest...>
+                {};
+
                 template<
                     template<typename...> class T0, typename ...List
                   , template<typename...> class T1, typename ...Rest
@@ -865,8 +978,10 @@ namespace boost
                 #define BOOST_PROTO_TRY_CALL boost::proto::v5::utility::try_call
                 #define BOOST_PROTO_TRY_CALL_IF(B) boost::proto::v5::utility::try_call_if<B>
             #else
-                #define BOOST_PROTO_TRY_CALL
-                #define BOOST_PROTO_TRY_CALL_IF(B)
+                // The extra parentheses keep BOOST_PROTO_TRY_CALL(T())(args...) from being parsed
+                // as a cast to a function type.
+                #define BOOST_PROTO_TRY_CALL(...) ((__VA_ARGS__))
+                #define BOOST_PROTO_TRY_CALL_IF(B) BOOST_PROTO_TRY_CALL
             #endif
             }
         }
@@ -86,6 +86,8 @@ namespace
 }
 
 static_assert(std::is_trivial<lambda_var<placeholder_c<0>>>::value, "_1 should be trivial");
+static_assert(std::is_empty<lambda_var<placeholder_c<0>>>::value, "_1 should be empty");
+static_assert(sizeof(proto::deep_copy(_1 + 42 * _2)) == sizeof(int), "only 42 should take up space");
 BOOST_PROTO_IGNORE_UNUSED(_1, _2, _3);
 
 int main()
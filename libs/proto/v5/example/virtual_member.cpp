@@ -224,7 +224,8 @@ int main()
 
     // Even though all expressions in the mini-lambda
     // domain have members named else_, while_, and catch_,
-    // they all occupy the same byte in the expression.
-    static_assert(sizeof(_1) == 3, "_1 should be only 3 bytes");
+    // they all occupy the same byte in the expression. The
+    // placeholder terminal itself takes up no room at all.
+    static_assert(sizeof(_1) == 1, "_1 should be only 1 byte");
 }
 //]
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// abstraction_penalty.cpp
+// Pairs of functions, one using Proto and one written by hand, that should compile to
+// (nearly) the same code. abstraction_penalty.sh compares their sizes in the object file.
+// Every function that starts with "proto_" must have a "hand_" twin.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <map>
+#include <cstddef>
+#include "./fixtures.hpp"
+
+namespace proto = boost::proto;
+using namespace fixtures;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The lambda from example/lambda.cpp
+extern "C" int proto_lambda(int a, int b)
+{
+    return (_1 + 42 * _2)(a, b);
+}
+
+extern "C" int hand_lambda(int a, int b)
+{
+    return a + 42 * b;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The calculator from scratch/main.cpp
+using ull = unsigned long long;
+
+extern "C" ull proto_calc(ull x, ull y, ull z)
+{
+    return Calc()(proto::literal<ull>(x) + proto::literal<ull>(y) * proto::literal<ull>(z));
+}
+
+extern "C" ull hand_calc(ull x, ull y, ull z)
+{
+    return x + y * z;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// map_list_of from example/map_list_of.cpp
+extern "C" void proto_map_list_of(std::map<int, int> &map, int a, int b, int c)
+{
+    MapListOf()(map_list_of(a, b)(b, c)(c, a), proto::data = map);
+}
+
+extern "C" void hand_map_list_of(std::map<int, int> &map, int a, int b, int c)
+{
+    map[a] = b;
+    map[b] = c;
+    map[c] = a;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// An elementwise vector expression
+extern "C" void proto_vector(double *r, double const *a, double const *b, double const *c, std::size_t n)
+{
+    auto expr = vec{a} + vec{b} * vec{c} - 2.0;
+    for(std::size_t i = 0; i < n; ++i)
+        r[i] = VecEval()(expr, proto::data = i);
+}
+
+extern "C" void hand_vector(double *r, double const *a, double const *b, double const *c, std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i)
+        r[i] = a[i] + b[i] * c[i] - 2.0;
+}
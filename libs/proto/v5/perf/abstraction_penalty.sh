@@ -0,0 +1,61 @@
+#!/bin/sh
+# (C) Copyright 2013: Eric Niebler
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+#
+# Usage: abstraction_penalty.sh <object file> [tolerance in percent]
+#
+# Counts the instructions in each proto_XXX function of the object file and compares it with
+# the instruction count of its hand_XXX twin. Fails if any Proto version is more than
+# <tolerance> percent larger than the hand-written one. Requires only objdump and awk.
+
+obj="$1"
+tolerance="${2:-10}"
+
+if [ -z "$obj" ]; then
+    echo "usage: $0 <object file> [tolerance in percent]" >&2
+    exit 2
+fi
+
+objdump -d --no-show-raw-insn "$obj" | awk -v tolerance="$tolerance" '
+    /^[0-9a-f]+ <[^>]*>:$/ {
+        name = $2
+        gsub(/[<>:]/, "", name)
+        next
+    }
+    /^$/ {
+        name = ""
+        next
+    }
+    name != "" && /^ *[0-9a-f]+:/ {
+        count[name]++
+    }
+    END {
+        status = 0
+        checked = 0
+        printf "%-20s %8s %8s %8s\n", "function", "proto", "hand", "limit"
+        for(fn in count) {
+            if(fn !~ /^proto_/)
+                continue
+            base = substr(fn, 7)
+            if(!(("hand_" base) in count)) {
+                printf "%-20s missing hand_%s\n", base, base
+                status = 1
+                continue
+            }
+            proto = count[fn]
+            hand = count["hand_" base]
+            limit = int(hand * (100 + tolerance) / 100 + 0.5)
+            verdict = proto > limit ? "FAIL" : "ok"
+            printf "%-20s %8d %8d %8d %s\n", base, proto, hand, limit, verdict
+            if(proto > limit)
+                status = 1
+            ++checked
+        }
+        if(checked == 0) {
+            print "no proto_XXX functions found"
+            status = 1
+        }
+        exit status
+    }
+'
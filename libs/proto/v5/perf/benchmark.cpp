@@ -0,0 +1,530 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// benchmark.cpp
+// Measures the time per operation of Proto's core evaluation paths and writes the results as
+// CSV to stdout, one line per benchmark, always in the same order:
+//
+//   benchmark,param,iterations,ns_per_op
+//
+// Each benchmark is run several times and the fastest run is reported.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/fusion/include/cons.hpp>
+#include <boost/fusion/include/fold.hpp>
+#include "./fixtures.hpp"
+
+namespace proto = boost::proto;
+namespace fusion = boost::fusion;
+using proto::_;
+using namespace fixtures;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Keep the optimizer from discarding or hoisting the work being measured
+template<typename T>
+inline void do_not_optimize(T const &t)
+{
+    asm volatile("" : : "g"(&t) : "memory");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// run
+//  Times `iterations` calls of fun, `repeat` times over, and prints the fastest.
+template<typename Fun>
+void run(char const *name, int param, Fun fun)
+{
+    constexpr std::size_t iterations = 1u << 20;
+    constexpr int repeat = 5;
+    using clock = std::chrono::steady_clock;
+
+    for(std::size_t i = 0; i < iterations / 16; ++i)
+        fun();
+
+    double best = 0;
+    for(int r = 0; r < repeat; ++r)
+    {
+        auto start = clock::now();
+        for(std::size_t i = 0; i < iterations; ++i)
+            fun();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        double ns = elapsed.count() / iterations;
+        if(r == 0 || ns < best)
+            best = ns;
+    }
+
+    std::printf("%s,%d,%zu,%.3f\n", name, param, iterations, best);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// tree<N>::make
+//  Builds a complete binary tree of depth N+1 of alternating + and * nodes that holds its
+//  children by value.
+template<int N, bool Plus = (N % 2 == 1)>
+struct tree;
+
+template<int N>
+struct tree<N, true>
+{
+    static auto make(proto::literal<int> const &leaf)
+    BOOST_PROTO_AUTO_RETURN(
+        proto::deep_copy(tree<N-1>::make(leaf) + tree<N-1>::make(leaf))
+    )
+};
+
+template<int N>
+struct tree<N, false>
+{
+    static auto make(proto::literal<int> const &leaf)
+    BOOST_PROTO_AUTO_RETURN(
+        proto::deep_copy(tree<N-1>::make(leaf) * tree<N-1>::make(leaf))
+    )
+};
+
+template<>
+struct tree<0, false>
+{
+    static proto::literal<int> make(proto::literal<int> const &leaf)
+    {
+        return leaf;
+    }
+};
+
+template<int N>
+void bench_eval(int seed)
+{
+    auto expr = tree<N>::make(proto::literal<int>{seed});
+    run("eval", N + 1, [&]{
+        do_not_optimize(expr);
+        int result = proto::_eval()(expr);
+        do_not_optimize(result);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Flattening with fold and recursive_fold, as in test/flatten.cpp and test/fold.cpp
+struct CountLeaves
+  : proto::def<
+        proto::match(
+            proto::case_( proto::terminal(_),
+                proto::_int<1>
+            )
+          , proto::default_(
+                proto::fold(_, proto::_int<0>, proto::functional::cxx::plus(CountLeaves, proto::_state))
+            )
+        )
+    >
+{};
+
+struct ToConsList
+  : proto::def<
+        proto::recursive_fold(
+            _
+          , fusion::nil()
+          , proto::make( fusion::cons<proto::_value, proto::_state>(proto::_value, proto::_state) )
+        )
+    >
+{};
+
+struct sum_values
+{
+    template<typename Expr>
+    int operator()(int state, Expr const &e) const
+    {
+        return state + proto::value(e);
+    }
+};
+
+void bench_fold(int seed)
+{
+    proto::literal<int> a{seed}, b{seed + 1}, c{seed + 2}, d{seed + 3};
+    auto expr = a >> b >> c >> d;
+
+    run("fold", 4, [&]{
+        do_not_optimize(expr);
+        int leaves = CountLeaves()(expr);
+        do_not_optimize(leaves);
+    });
+
+    run("recursive_fold", 4, [&]{
+        do_not_optimize(expr);
+        auto list = ToConsList()(expr);
+        do_not_optimize(list);
+    });
+
+    run("flatten", 4, [&]{
+        do_not_optimize(expr);
+        int sum = fusion::fold(proto::flatten(expr), 0, sum_values());
+        do_not_optimize(sum);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lambdas that look up their arguments in an environment, as in example/lambda.cpp
+void bench_lambda(int seed)
+{
+    int a = seed, b = seed + 1, c = seed + 2;
+    auto fun1 = _1 + 42;
+    auto fun2 = _1 + 42 * _2;
+    auto fun3 = _1 + 42 * _2 - _3 * _1;
+
+    run("lambda", 1, [&]{
+        do_not_optimize(a);
+        int result = fun1(a);
+        do_not_optimize(result);
+    });
+
+    run("lambda", 2, [&]{
+        do_not_optimize(a);
+        int result = fun2(a, b);
+        do_not_optimize(result);
+    });
+
+    run("lambda", 3, [&]{
+        do_not_optimize(a);
+        int result = fun3(a, b, c);
+        do_not_optimize(result);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The same lambdas, prepared once and then called with arguments bound to parameter slots
+void bench_prepare(int seed)
+{
+    int a = seed, b = seed + 1, c = seed + 2;
+    auto fun1 = proto::prepare(_1 + 42);
+    auto fun2 = proto::prepare(_1 + 42 * _2);
+    auto fun3 = proto::prepare(_1 + 42 * _2 - _3 * _1);
+
+    run("prepared", 1, [&]{
+        do_not_optimize(a);
+        int result = fun1(a);
+        do_not_optimize(result);
+    });
+
+    run("prepared", 2, [&]{
+        do_not_optimize(a);
+        int result = fun2(a, b);
+        do_not_optimize(result);
+    });
+
+    run("prepared", 3, [&]{
+        do_not_optimize(a);
+        int result = fun3(a, b, c);
+        do_not_optimize(result);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar-heavy lambdas, with the scalars stored by reference (the default) and by value (the
+// utility::small_by_val storage policy)
+void bench_store_value(int seed)
+{
+    double a = seed, b = seed + 1, c = seed + 2, d = seed + 3, e = seed + 4, f = seed + 5;
+    double x = seed / 2.;
+    auto by_ref3 = _1 * a + b * _1 - c;
+    auto by_val3 = small_1 * a + b * small_1 - c;
+    auto by_ref6 = ((_1 * a + b) * _1 + c) * _1 + d - e / (_1 + f);
+    auto by_val6 = ((small_1 * a + b) * small_1 + c) * small_1 + d - e / (small_1 + f);
+
+    run("lambda_scalars_by_ref", 3, [&]{
+        do_not_optimize(x);
+        double result = by_ref3(x);
+        do_not_optimize(result);
+    });
+
+    run("lambda_scalars_small_by_val", 3, [&]{
+        do_not_optimize(x);
+        double result = by_val3(x);
+        do_not_optimize(result);
+    });
+
+    run("lambda_scalars_by_ref", 6, [&]{
+        do_not_optimize(x);
+        double result = by_ref6(x);
+        do_not_optimize(result);
+    });
+
+    run("lambda_scalars_small_by_val", 6, [&]{
+        do_not_optimize(x);
+        double result = by_val6(x);
+        do_not_optimize(result);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// deep_copy of trees of increasing depth
+template<int N>
+void bench_deep_copy(int seed)
+{
+    proto::literal<int> i{seed};
+    auto expr = tree<N>::make(i);
+    run("deep_copy", N + 1, [&]{
+        do_not_optimize(expr);
+        auto copy = proto::deep_copy(expr);
+        do_not_optimize(copy);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copying and freeing a small predicate whose terminals own heap memory, with deep_copy and with
+// deep_copy_into an arena, and moving the arena copy with memcpy
+using string_ = proto::literal<std::string>;
+using ints_ = proto::literal<std::vector<int>>;
+using name_eq_ = proto::expr<proto::equal_to(string_, string_)>;
+using count_lt_ = proto::expr<proto::less(proto::literal<int>, proto::expr<proto::subscript(ints_, proto::literal<int>)>)>;
+using pred_ = proto::expr<proto::logical_and(name_eq_, count_lt_)>;
+
+void bench_arena_copy(int seed)
+{
+    pred_ expr {
+        proto::logical_and()
+      , name_eq_{proto::equal_to(), string_{"a name too long to be stored inline"}, string_{"another name much too long to be stored inline"}}
+      , count_lt_{
+            proto::less()
+          , proto::literal<int>{seed}
+          , proto::expr<proto::subscript(ints_, proto::literal<int>)>{
+                proto::subscript(), ints_{std::vector<int>{seed, seed + 1, seed + 2}}, proto::literal<int>{1}
+            }
+        }
+    };
+
+    run("deep_copy_owned", 3, [&]{
+        do_not_optimize(expr);
+        auto copy = proto::deep_copy(expr);
+        do_not_optimize(copy);
+    });
+
+    proto::arena arena;
+    run("deep_copy_into_arena", 3, [&]{
+        do_not_optimize(expr);
+        auto &copy = proto::deep_copy_into(arena, expr);
+        do_not_optimize(copy);
+        arena.clear();
+    });
+
+    std::size_t const size = proto::deep_copy_size(expr);
+    auto &copy = proto::deep_copy_into(arena, expr);
+    std::vector<std::max_align_t> buffer(size / sizeof(std::max_align_t) + 1);
+    run("arena_memcpy", 3, [&]{
+        do_not_optimize(copy);
+        std::memcpy(buffer.data(), static_cast<void const *>(std::addressof(copy)), size);
+        do_not_optimize(buffer);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Rebuilding trees with passthru, as in test/passthru.cpp
+struct MinusToPlus
+  : proto::def<
+        proto::match(
+            proto::case_(
+                proto::minus(MinusToPlus, MinusToPlus)
+              , proto::plus(MinusToPlus(proto::_left), MinusToPlus(proto::_right))
+            )
+          , proto::case_(
+                _(MinusToPlus...)
+              , proto::passthru
+            )
+          , proto::case_(
+                proto::terminal(_)
+              , proto::passthru
+            )
+        )
+    >
+{};
+
+void bench_passthru(int seed)
+{
+    proto::literal<int> a{seed}, b{seed + 1}, c{seed + 2};
+    auto expr = proto::deep_copy(-(a - b) * (c - a) - b);
+    run("passthru", 7, [&]{
+        do_not_optimize(expr);
+        auto result = MinusToPlus()(expr);
+        do_not_optimize(result);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// A filter over a batch of records, as a static lambda, by walking an any_expr, and as bytecode
+// run once per record and once per batch
+void bench_bytecode(int seed)
+{
+    constexpr int records = 64;
+    std::vector<int> inputs(2 * records);
+    for(int i = 0; i < 2 * records; ++i)
+        inputs[i] = seed + i % 13;
+    std::vector<int> results(records);
+
+    auto lambda = _1 * 2 + _2 > 10 && _1 < _2;
+    run("filter_static", records, [&]{
+        do_not_optimize(inputs);
+        for(int i = 0; i < records; ++i)
+            results[i] = lambda(inputs[2 * i], inputs[2 * i + 1]);
+        do_not_optimize(results);
+    });
+
+    proto::any_expr_pool pool;
+    proto::any_expr<> x = proto::any_expr<>::make_arg(pool, 0);
+    proto::any_expr<> y = proto::any_expr<>::make_arg(pool, 1);
+    proto::any_expr<> filter = x * 2 + y > 10 && x < y;
+    run("filter_any_expr", records, [&]{
+        do_not_optimize(inputs);
+        for(int i = 0; i < records; ++i)
+            results[i] = filter.eval<int>(inputs[2 * i], inputs[2 * i + 1]);
+        do_not_optimize(results);
+    });
+
+    proto::bytecode<int> prog = proto::compile<int>(filter);
+    std::vector<int> regs(prog.registers());
+    run("filter_bytecode", records, [&]{
+        do_not_optimize(inputs);
+        for(int i = 0; i < records; ++i)
+            results[i] = prog.run(&inputs[2 * i], regs.data());
+        do_not_optimize(results);
+    });
+
+    run("filter_bytecode_batch", records, [&]{
+        do_not_optimize(inputs);
+        prog.run_batch(inputs.data(), records, results.data());
+        do_not_optimize(results);
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Executing instructions whose opcode is a runtime value held by a terminal, with switch_on's
+// jump table and with a cascade of comparisons
+using opcode_ = proto::literal<int>;
+using instr_ = proto::expr<proto::function(opcode_, proto::literal<int>)>;
+
+struct _opcode
+  : proto::basic_action<_opcode>
+{
+    template<typename E>
+    int operator()(E const &e) const
+    {
+        return proto::value(proto::child<0>(e));
+    }
+};
+
+// Different work for each opcode, so the comparisons can't be folded into arithmetic
+template<int Op> int exec_op(int x);
+template<> int exec_op<0>(int x) { return x + 7; }
+template<> int exec_op<1>(int x) { return x * 3; }
+template<> int exec_op<2>(int x) { return x ^ 0x5a; }
+template<> int exec_op<3>(int x) { return x >> 1; }
+template<> int exec_op<4>(int x) { return x - 11; }
+template<> int exec_op<5>(int x) { return x * x; }
+template<> int exec_op<6>(int x) { return ~x; }
+template<> int exec_op<7>(int x) { return x << 2; }
+
+template<int Op>
+struct _exec_op
+  : proto::basic_action<_exec_op<Op>>
+{
+    template<typename E>
+    int operator()(E const &e) const
+    {
+        return exec_op<Op>(proto::value(proto::child<1>(e)));
+    }
+};
+
+template<int Op>
+using op_case = proto::case_(std::integral_constant<int, Op>, _exec_op<Op>);
+
+struct ExecSwitch
+  : proto::def<
+        proto::switch_on(
+            _opcode
+          , op_case<0>, op_case<1>, op_case<2>, op_case<3>
+          , op_case<4>, op_case<5>, op_case<6>, op_case<7>
+        )
+    >
+{};
+
+struct _exec_if_chain
+  : proto::basic_action<_exec_if_chain>
+{
+    template<typename E>
+    int operator()(E const &e) const
+    {
+        int const op = _opcode()(e);
+        return op == 0 ? _exec_op<0>()(e)
+             : op == 1 ? _exec_op<1>()(e)
+             : op == 2 ? _exec_op<2>()(e)
+             : op == 3 ? _exec_op<3>()(e)
+             : op == 4 ? _exec_op<4>()(e)
+             : op == 5 ? _exec_op<5>()(e)
+             : op == 6 ? _exec_op<6>()(e)
+             : op == 7 ? _exec_op<7>()(e)
+             : 0;
+    }
+};
+
+void bench_switch_on(int seed)
+{
+    constexpr int instrs = 64;
+    std::vector<instr_> program;
+    unsigned state = static_cast<unsigned>(seed);
+    for(int i = 0; i < instrs; ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        program.push_back(instr_{proto::function(), opcode_{int(state >> 16) % 8}, proto::literal<int>{i}});
+    }
+
+    run("switch_on", instrs, [&]{
+        do_not_optimize(program);
+        int result = 0;
+        for(instr_ const &instr : program)
+            result += ExecSwitch()(instr);
+        do_not_optimize(result);
+    });
+
+    run("switch_if_chain", instrs, [&]{
+        do_not_optimize(program);
+        int result = 0;
+        for(instr_ const &instr : program)
+            result += _exec_if_chain()(instr);
+        do_not_optimize(result);
+    });
+}
+
+int main(int argc, char *[])
+{
+    int seed = argc;
+
+    std::printf("benchmark,param,iterations,ns_per_op\n");
+
+    bench_eval<0>(seed);
+    bench_eval<1>(seed);
+    bench_eval<2>(seed);
+    bench_eval<3>(seed);
+    bench_eval<4>(seed);
+    bench_eval<5>(seed);
+
+    bench_fold(seed);
+
+    bench_lambda(seed);
+    bench_prepare(seed);
+
+    bench_store_value(seed);
+
+    bench_deep_copy<1>(seed);
+    bench_deep_copy<3>(seed);
+    bench_deep_copy<5>(seed);
+
+    bench_arena_copy(seed);
+
+    bench_passthru(seed);
+
+    bench_bytecode(seed);
+
+    bench_switch_on(seed);
+}
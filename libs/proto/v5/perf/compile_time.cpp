@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// compile_time.cpp
+// Sums the values of the children of many different expression types, either through the Fusion
+// adaptation of expressions (with BOOST_PROTO_COMPILE_TIME_FUSION defined) or through the tuple
+// protocol in tuple.hpp. compile_time.sh compiles it both ways and compares the times.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+#include <type_traits>
+#include <boost/preprocessor/repetition/repeat.hpp>
+#include <boost/proto/v5/expr.hpp>
+
+#ifdef BOOST_PROTO_COMPILE_TIME_FUSION
+#include <boost/fusion/include/accumulate.hpp>
+#include <boost/proto/v5/fusion.hpp>
+#else
+#include <boost/proto/v5/tuple.hpp>
+#endif
+
+#ifndef BOOST_PROTO_COMPILE_TIME_TYPES
+#define BOOST_PROTO_COMPILE_TIME_TYPES 100
+#endif
+
+namespace proto = boost::proto;
+
+template<int N>
+using leaf = proto::literal<std::integral_constant<int, N>>;
+
+template<int N>
+using node = proto::expr<proto::function(leaf<N>, leaf<N + 1>, leaf<N + 2>, leaf<N + 3>)>;
+
+#ifdef BOOST_PROTO_COMPILE_TIME_FUSION
+struct add_value
+{
+    using result_type = int;
+
+    template<typename Leaf>
+    int operator()(int state, Leaf const &leaf) const
+    {
+        return state + proto::value(leaf);
+    }
+};
+
+template<typename Expr>
+int sum(Expr const &e)
+{
+    return boost::fusion::accumulate(e, 0, add_value());
+}
+#else
+inline int add_values()
+{
+    return 0;
+}
+
+template<typename Head, typename ...Tail>
+int add_values(Head const &head, Tail const &...tail)
+{
+    return proto::value(head) + add_values(tail...);
+}
+
+template<typename Expr, std::size_t ...I>
+int sum(Expr const &e, proto::utility::indices<I...>)
+{
+    return add_values(proto::get<I>(e)...);
+}
+
+template<typename Expr>
+int sum(Expr const &e)
+{
+    return sum(e, proto::utility::make_indices<std::tuple_size<Expr>::value>());
+}
+#endif
+
+#define SUM(Z, N, D) + sum(node<N>{proto::function(), leaf<N>{}, leaf<N + 1>{}, leaf<N + 2>{}, leaf<N + 3>{}})
+
+int main()
+{
+    return 0 BOOST_PP_REPEAT(BOOST_PROTO_COMPILE_TIME_TYPES, SUM, ~) > 0 ? 0 : 1;
+}
+
+#undef SUM
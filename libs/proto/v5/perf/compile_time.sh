@@ -0,0 +1,49 @@
+#!/bin/sh
+# (C) Copyright 2013: Eric Niebler
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+#
+# Usage: compile_time.sh <boost root> [compiler] [runs]
+#
+# Compiles compile_time.cpp with the Fusion adaptation of expressions and with the tuple
+# protocol, <runs> times each (default 3), and prints the best time of each in milliseconds
+# along with the size of the preprocessed source.
+
+root="$1"
+cxx="${2:-${CXX:-g++}}"
+runs="${3:-3}"
+here=$(dirname "$0")
+src="$here/compile_time.cpp"
+
+if [ -z "$root" ]; then
+    echo "usage: $0 <boost root> [compiler] [runs]" >&2
+    exit 2
+fi
+
+now_ms() {
+    echo $(($(date +%s%N) / 1000000))
+}
+
+best_time() {
+    best=""
+    i=0
+    while [ $i -lt "$runs" ]; do
+        start=$(now_ms)
+        "$cxx" -std=c++11 -I"$root" -fsyntax-only "$@" "$src" || exit 1
+        elapsed=$(($(now_ms) - start))
+        if [ -z "$best" ] || [ $elapsed -lt $best ]; then
+            best=$elapsed
+        fi
+        i=$((i + 1))
+    done
+    echo $best
+}
+
+lines() {
+    "$cxx" -std=c++11 -I"$root" -E "$@" "$src" | wc -l
+}
+
+printf "%-8s %10s %12s\n" "route" "ms" "pp lines"
+printf "%-8s %10s %12s\n" "tuple" $(best_time) $(lines)
+printf "%-8s %10s %12s\n" "fusion" \
+    $(best_time -DBOOST_PROTO_COMPILE_TIME_FUSION) $(lines -DBOOST_PROTO_COMPILE_TIME_FUSION)
@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// fixtures.hpp
+// Small Proto-based libraries shared by the performance checks, modeled on the examples.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_V5_PERF_FIXTURES_HPP_INCLUDED
+#define BOOST_PROTO_V5_PERF_FIXTURES_HPP_INCLUDED
+
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+
+namespace fixtures
+{
+    namespace proto = boost::proto;
+    using proto::_;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // The lambda library from example/lambda.cpp
+    template<typename T>
+    struct placeholder
+      : proto::env_tag<placeholder<T>>
+    {
+        BOOST_PROTO_REGULAR_TRIVIAL_CLASS(placeholder);
+        using proto::env_tag<placeholder<T>>::operator=;
+    };
+
+    template<std::size_t I>
+    using placeholder_c = placeholder<std::integral_constant<std::size_t, I>>;
+}
+
+// The placeholders are also the parameter slots of prepared lambdas
+namespace boost { namespace proto { inline namespace v5 { namespace extension
+{
+    template<std::size_t I>
+    struct param_index<fixtures::placeholder_c<I>>
+      : std::integral_constant<std::size_t, I>
+    {};
+}}}}
+
+namespace fixtures
+{
+
+    struct lambda_eval
+      : proto::def<
+            proto::match(
+                proto::case_( proto::terminal(placeholder<_>),
+                    proto::get_env(proto::_value)
+                )
+              , proto::case_( proto::terminal(_),
+                    proto::_value
+                )
+              , proto::default_(
+                    proto::eval_with(lambda_eval)
+                )
+            )
+        >
+    {};
+
+    template<std::size_t ...I, typename E, typename ...T>
+    inline auto lambda_eval_(proto::utility::indices<I...>, E && e, T &&... t)
+    BOOST_PROTO_AUTO_RETURN(
+        lambda_eval()(
+            std::forward<E>(e)
+          , proto::make_env(placeholder_c<I>() = std::forward<T>(t)...)
+        )
+    )
+
+    template<typename ExprDesc>
+    struct lambda_expr
+      : proto::basic_expr<lambda_expr<ExprDesc>>
+      , proto::expr_assign<lambda_expr<ExprDesc>>
+      , proto::expr_subscript<lambda_expr<ExprDesc>>
+    {
+        using proto::basic_expr<lambda_expr>::basic_expr;
+        using proto::expr_assign<lambda_expr>::operator=;
+
+        template<typename ...T>
+        auto operator()(T &&... t) const
+        BOOST_PROTO_AUTO_RETURN(
+            lambda_eval_(
+                proto::utility::make_indices<sizeof...(T)>()
+              , *this, std::forward<T>(t)...
+            )
+        )
+    };
+
+    template<typename T>
+    using lambda_var = proto::custom<lambda_expr<_>>::terminal<T>;
+
+    namespace
+    {
+        constexpr auto const & _1 = proto::utility::static_const<lambda_var<placeholder_c<0>>>::value;
+        constexpr auto const & _2 = proto::utility::static_const<lambda_var<placeholder_c<1>>>::value;
+        constexpr auto const & _3 = proto::utility::static_const<lambda_var<placeholder_c<2>>>::value;
+    }
+
+    BOOST_PROTO_IGNORE_UNUSED(_1, _2, _3);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // The same lambda library in a domain that stores small scalars by value instead of by
+    // reference.
+    template<typename ExprDesc>
+    struct small_lambda_expr;
+
+    struct small_lambda_domain
+      : proto::domain<small_lambda_domain>
+    {
+        using store_value = proto::utility::small_by_val<>;
+        using make_expr = proto::make_custom_expr<small_lambda_expr<_>>;
+    };
+
+    template<typename ExprDesc>
+    struct small_lambda_expr
+      : proto::basic_expr<ExprDesc, small_lambda_domain>
+      , proto::expr_assign<small_lambda_expr<ExprDesc>>
+      , proto::expr_subscript<small_lambda_expr<ExprDesc>>
+    {
+        using proto::basic_expr<ExprDesc, small_lambda_domain>::basic_expr;
+        using proto::expr_assign<small_lambda_expr>::operator=;
+
+        template<typename ...T>
+        auto operator()(T &&... t) const
+        BOOST_PROTO_AUTO_RETURN(
+            lambda_eval_(
+                proto::utility::make_indices<sizeof...(T)>()
+              , *this, std::forward<T>(t)...
+            )
+        )
+    };
+
+    template<typename T>
+    using small_lambda_var = small_lambda_expr<proto::terminal(T)>;
+
+    namespace
+    {
+        constexpr auto const & small_1 = proto::utility::static_const<small_lambda_var<placeholder_c<0>>>::value;
+    }
+
+    BOOST_PROTO_IGNORE_UNUSED(small_1);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // The calculator from scratch/main.cpp
+    struct Calc
+      : proto::def<
+            proto::match(
+                proto::case_(proto::terminal(unsigned long long), proto::_value)
+              , proto::case_(proto::plus(Calc, Calc), proto::plus(Calc(proto::_left), Calc(proto::_right)))
+              , proto::case_(proto::multiplies(Calc, Calc), proto::multiplies(Calc(proto::_left), Calc(proto::_right)))
+            )
+        >
+    {};
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // The map_list_of utility from example/map_list_of.cpp
+    struct map_list_of_
+    {};
+
+    struct MapListOf
+      : proto::def<
+            proto::match(
+                proto::case_( proto::terminal(map_list_of_),
+                    void()
+                )
+              , proto::case_( proto::function(MapListOf, proto::terminal(_), proto::terminal(_)),
+                    MapListOf(proto::_child0),
+                    proto::assign(
+                        proto::subscript(proto::_data, proto::_value(proto::_child1))
+                      , proto::_value(proto::_child2)
+                    )
+                )
+            )
+        >
+    {};
+
+    constexpr proto::expr<proto::terminal(map_list_of_)> map_list_of {};
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Elementwise evaluation of vector expressions. Terminals are pointers to the first element
+    // of a vector, and the index being evaluated is passed as the data parameter.
+    struct VecEval
+      : proto::def<
+            proto::match(
+                proto::case_( proto::terminal(double const *),
+                    proto::functional::cxx::subscript(proto::_value, proto::_data)
+                )
+              , proto::case_( proto::terminal(_),
+                    proto::_value
+                )
+              , proto::default_(
+                    proto::eval_with(VecEval)
+                )
+            )
+        >
+    {};
+
+    using vec = proto::literal<double const *>;
+}
+
+#endif
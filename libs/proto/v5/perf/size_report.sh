@@ -0,0 +1,172 @@
+#!/bin/sh
+# (C) Copyright 2013: Eric Niebler
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+#
+# Usage: size_report.sh [--check <tolerance in percent>] <binary>...
+#
+# Attributes the code size of the given programs to Proto's actions and grammars. Reads the
+# demangled symbol table with nm and prints two tables, largest first:
+#
+#   1. bytes of code per Proto component (_match_, _passthru_, _fold, make_expr, ...), i.e. the
+#      Proto class or function a symbol belongs to;
+#   2. bytes of code per user type, i.e. the first non-Boost, non-std type that appears in the
+#      symbol's name, which is usually the grammar or action that caused it to be instantiated.
+#
+# Most Proto functions are declared with BOOST_PROTO_AUTO_RETURN, so their names start with a
+# "decltype (...)" return type. Those expressions are skipped when looking for the function's
+# name and for user types.
+#
+# With --check, also fails if more than <tolerance> percent of Proto's code is not attributed
+# to a component, or if a C++ keyword is reported as a user type. Both mean that the symbol
+# names were not parsed properly.
+#
+# Requires only binutils (nm), awk and sort.
+
+tolerance=""
+if [ "$1" = "--check" ]; then
+    tolerance="$2"
+    shift 2
+fi
+
+if [ $# -eq 0 ]; then
+    echo "usage: $0 [--check <tolerance in percent>] <binary>..." >&2
+    exit 2
+fi
+
+nm -C -S --defined-only -t d "$@" 2>/dev/null | awk -v tolerance="$tolerance" '
+    function strip_templates(s,    t) {
+        t = ""
+        while(t != s) {
+            t = s
+            gsub(/<[^<>]*>/, "", s)
+        }
+        return s
+    }
+
+    # Replaces each "decltype (...)" in s with "decltype", skipping balanced parentheses.
+    function strip_decltypes(s,    t, rest, depth) {
+        t = ""
+        while(match(s, /decltype ?\(/)) {
+            t = t substr(s, 1, RSTART - 1) "decltype"
+            rest = substr(s, RSTART + RLENGTH)
+            depth = 1
+            while(depth > 0 && match(rest, /[()]/)) {
+                depth += substr(rest, RSTART, 1) == "(" ? 1 : -1
+                rest = substr(rest, RSTART + 1)
+            }
+            s = rest
+        }
+        return t s
+    }
+
+    # Names with the operators that would confuse the parsing below spelled out, and with
+    # decltype expressions removed.
+    function simplify(name,    s) {
+        s = name
+        gsub(/\[abi:[^]]*\]/, "", s)
+        gsub(/\{lambda/, "{", s)
+        gsub(/operator\(\)/, "operator_call", s)
+        gsub(/operator(<<=|>>=|<<|>>|<=|>=|->\*|->|<|>)/, "operator_op", s)
+        return strip_decltypes(s)
+    }
+
+    # The Proto component a function belongs to: the first name after boost::proto::v5 and
+    # its sub-namespaces in the qualified function name.
+    function component(name,    s, n, parts, i) {
+        s = strip_templates(simplify(name))
+        sub(/\(.*$/, "", s)
+        n = split(s, parts, " ")
+        s = parts[n]
+        if(s !~ /^boost::proto::/)
+            return ""
+        n = split(s, parts, "::")
+        for(i = 3; i <= n; ++i) {
+            if(parts[i] !~ /^(v5|detail|exprs|extension|utility|envs|domains|functional|cxx|std|tags|result_of|literals)$/)
+                return parts[i]
+        }
+        return parts[n]
+    }
+
+    # The first type in the symbol name that does not belong to Boost, the standard library
+    # or the compiler.
+    function user_type(name,    s, tok) {
+        s = simplify(name)
+        gsub(/[0-9][0-9A-Za-z_]*/, "0", s)    # literals such as 0ul
+        while(match(s, /(::~?)?[A-Za-z_][A-Za-z0-9_]*(::[A-Za-z_][A-Za-z0-9_]*)*/)) {
+            tok = substr(s, RSTART, RLENGTH)
+            s = substr(s, RSTART + RLENGTH)
+            if(tok ~ /^::/)     # a member of the preceding type, e.g. expr<...>::type
+                continue
+            if(tok ~ /^(boost|std|mpl_|__gnu_cxx|__cxx11|anonymous)(::|$)/)
+                continue
+            if(tok ~ /^(void|bool|char|wchar_t|char16_t|char32_t|short|int|long|unsigned|signed|float|double|const|volatile|auto|decltype|sizeof|true|false|nullptr_t|namespace)$/)
+                continue
+            if(tok ~ /^operator/)
+                continue
+            if(tok ~ /^_+[A-Z]/)
+                continue
+            return tok
+        }
+        return ""
+    }
+
+    NF >= 4 && $3 ~ /^[tTwW]$/ {
+        size = $2 + 0
+        name = $0
+        sub(/^[^ ]+ [^ ]+ [^ ]+ /, "", name)
+        total += size
+
+        c = component(name)
+        if(c == "" && name !~ /boost::proto::/)
+            next
+        if(c == "")
+            c = "(proto, other)"
+        proto_total += size
+        by_component[c] += size
+        count_component[c]++
+
+        u = user_type(name)
+        if(u == "")
+            u = "(none)"
+        by_user[u] += size
+        count_user[u]++
+    }
+
+    END {
+        printf "total code bytes: %d\n", total
+        printf "proto code bytes: %d\n", proto_total
+        print ""
+        print "component,bytes,symbols"
+        for(c in by_component)
+            printf "%s,%d,%d\n", c, by_component[c], count_component[c] | "sort -t, -k2,2nr -k1,1"
+        close("sort -t, -k2,2nr -k1,1")
+        print ""
+        print "user type,bytes,symbols"
+        for(u in by_user)
+            printf "%s,%d,%d\n", u, by_user[u], count_user[u] | "sort -t, -k2,2nr -k1,1"
+        close("sort -t, -k2,2nr -k1,1")
+
+        if(tolerance == "")
+            exit 0
+        status = 0
+        other = by_component["(proto, other)"] + 0
+        print ""
+        printf "unattributed proto code: %d of %d bytes, limit %d%%\n", other, proto_total, tolerance
+        if(proto_total == 0) {
+            print "FAIL: no proto code found"
+            status = 1
+        }
+        else if(other * 100 > proto_total * tolerance) {
+            print "FAIL: too much proto code is not attributed to a component"
+            status = 1
+        }
+        for(u in by_user) {
+            if(u ~ /^(this|static_cast|const_cast|reinterpret_cast|dynamic_cast|noexcept|typename|template|new|delete|throw|alignof|typeid)$/) {
+                printf "FAIL: the keyword %s was reported as a user type\n", u
+                status = 1
+            }
+        }
+        exit status
+    }
+'
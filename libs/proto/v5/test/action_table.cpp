@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// action_table.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+// An arithmetic grammar whose operators are named rules, handled externally
+struct arith;
+
+struct plus_rule
+  : proto::def<proto::plus(arith, arith)>
+  , proto::env_tag<plus_rule>
+{
+    using proto::env_tag<plus_rule>::operator=;
+};
+
+struct minus_rule
+  : proto::def<proto::minus(arith, arith)>
+  , proto::env_tag<minus_rule>
+{
+    using proto::env_tag<minus_rule>::operator=;
+};
+
+struct arith
+  : proto::def<
+        proto::match(
+            proto::case_(proto::terminal(int), proto::_value)
+          , proto::case_(plus_rule, proto::external)
+          , proto::case_(minus_rule, proto::external)
+        )
+    >
+{};
+
+struct evaluate
+  : proto::def<proto::eval_with(arith)>
+{};
+
+struct append_digit
+{
+    int operator()(int left, int right) const
+    {
+        return left * 10 + right;
+    }
+};
+
+// Reads 1 + 2 as 12
+struct digits
+  : proto::def<append_digit(arith(proto::_left), arith(proto::_right))>
+{};
+
+using arith_actions =
+    proto::action_table<proto::case_(plus_rule, evaluate), proto::case_(minus_rule, evaluate)>;
+
+struct digit_actions
+  : proto::action_table<proto::case_(plus_rule, digits)>
+{};
+
+static_assert(std::is_empty<arith_actions>::value, "");
+static_assert(std::is_empty<digit_actions>::value, "");
+
+void test_action_tables()
+{
+    proto::literal<int> one{1}, two{2}, four{4};
+    BOOST_CHECK_EQUAL(arith()(one + two - four, arith_actions()), -1);
+    BOOST_CHECK_EQUAL(arith()(one + two + four, digit_actions()), 124);
+
+    // Other variables can be added to a table
+    BOOST_CHECK_EQUAL(arith()(one + two, (digit_actions(), proto::data = 42)), 12);
+}
+
+void test_fallback()
+{
+    // Rules a table doesn't map are looked up in the rest of the environment
+    proto::literal<int> one{1}, two{2}, four{4};
+    BOOST_CHECK_EQUAL(arith()(one + two - four, (digit_actions(), minus_rule() = evaluate())), 8);
+    BOOST_CHECK_EQUAL(
+        arith()(one + two, (proto::action_table<>(), plus_rule() = digits()))
+      , 12
+    );
+}
+
+void test_shadowing()
+{
+    // Rules bound over a table take precedence over its entries
+    proto::literal<int> one{1}, two{2};
+    BOOST_CHECK_EQUAL(arith()(one + two, (digit_actions(), plus_rule() = evaluate())), 3);
+    BOOST_CHECK_EQUAL(
+        arith()(one + two, (digit_actions(), plus_rule() = evaluate(), proto::data = 42))
+      , 3
+    );
+
+    // ... even when bound more than once
+    BOOST_CHECK_EQUAL(
+        arith()(one + two, (arith_actions(), plus_rule() = evaluate(), plus_rule() = digits()))
+      , 12
+    );
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test action tables");
+
+    test->add(BOOST_TEST_CASE(&test_action_tables));
+    test->add(BOOST_TEST_CASE(&test_fallback));
+    test->add(BOOST_TEST_CASE(&test_shadowing));
+
+    return test;
+}
@@ -0,0 +1,342 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// allocations.cpp
+// Verify that building and evaluating expressions never touches the heap unless a terminal
+// value does so itself.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <new>
+#include <map>
+#include <string>
+#include <cstdlib>
+#include <utility>
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+using proto::_a;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Counting replacements for the global allocation functions
+namespace
+{
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+}
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if(void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    if(p)
+    {
+        ++deallocations;
+        std::free(p);
+    }
+}
+
+void operator delete[](void *p) noexcept
+{
+    ::operator delete(p);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// allocation_counter
+//  Records the number of allocations and deallocations that happen between its construction and
+//  a call to allocations() or deallocations().
+struct allocation_counter
+{
+    allocation_counter()
+      : allocs_(::allocations)
+      , deallocs_(::deallocations)
+    {}
+
+    std::size_t allocations() const
+    {
+        return ::allocations - allocs_;
+    }
+
+    std::size_t deallocations() const
+    {
+        return ::deallocations - deallocs_;
+    }
+
+private:
+    std::size_t allocs_;
+    std::size_t deallocs_;
+};
+
+#define CHECK_NO_ALLOCATIONS(counter)                                                               \
+    BOOST_CHECK_EQUAL((counter).allocations(), 0u);                                                 \
+    BOOST_CHECK_EQUAL((counter).deallocations(), 0u)                                                \
+    /**/
+
+static_assert(std::is_trivially_copyable<proto::literal<int>>::value, "");
+static_assert(std::is_trivially_copyable<proto::literal<double>>::value, "");
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// A lambda library in the style of example/lambda.cpp
+template<typename T>
+struct placeholder
+  : proto::env_tag<placeholder<T>>
+{
+    BOOST_PROTO_REGULAR_TRIVIAL_CLASS(placeholder);
+    using proto::env_tag<placeholder<T>>::operator=;
+};
+
+template<std::size_t I>
+using placeholder_c = placeholder<std::integral_constant<std::size_t, I>>;
+
+struct lambda_eval
+  : proto::def<
+        proto::match(
+            proto::case_( proto::terminal(placeholder<_>),
+                proto::get_env(proto::_value)
+            )
+          , proto::case_( proto::terminal(_),
+                proto::_value
+            )
+          , proto::default_(
+                proto::eval_with(lambda_eval)
+            )
+        )
+    >
+{};
+
+namespace
+{
+    constexpr auto const & _1 = proto::utility::static_const<proto::literal<placeholder_c<0>>>::value;
+    constexpr auto const & _2 = proto::utility::static_const<proto::literal<placeholder_c<1>>>::value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// A map_list_of in the style of example/map_list_of.cpp
+struct map_list_of_
+{};
+
+struct MapListOf
+  : proto::def<
+        proto::match(
+            proto::case_( proto::terminal(map_list_of_),
+                void()
+            )
+          , proto::case_( proto::function(MapListOf, proto::terminal(_), proto::terminal(_)),
+                MapListOf(proto::_child0),
+                proto::assign(
+                    proto::subscript(proto::_data, proto::_value(proto::_child1))
+                  , proto::_value(proto::_child2)
+                )
+            )
+        )
+    >
+{};
+
+constexpr proto::expr<proto::terminal(map_list_of_)> map_list_of {};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Counts the terminals in an expression with fold
+struct CountLeaves
+  : proto::def<
+        proto::match(
+            proto::case_( proto::terminal(_),
+                proto::_int<1>
+            )
+          , proto::default_(
+                proto::fold(_, proto::_int<0>, proto::functional::cxx::plus(CountLeaves, proto::_state))
+            )
+        )
+    >
+{};
+
+struct LetSum
+  : proto::def<
+        proto::let(
+            _a(proto::_value(proto::_left))
+          , proto::functional::cxx::plus(_a, proto::_value(proto::_right))
+        )
+    >
+{};
+
+void test_make_expr_allocations()
+{
+    int i = 42;
+    allocation_counter counter;
+    auto t1 = proto::make_expr(proto::terminal(), 1);
+    auto t2 = proto::make_expr<proto::terminal>(i);
+    auto p1 = proto::make_expr(proto::plus(), t1, t2);
+    auto p2 = proto::make_expr<proto::negate>(p1);
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_EQUAL(proto::value(proto::child<0>(proto::child<0>(p2))), 1);
+}
+
+void test_operator_allocations()
+{
+    proto::literal<int> i {1};
+    proto::literal<double> d {2.5};
+    allocation_counter counter;
+    auto e = -(i + d) * i / 2 < d && !(i == 3);
+    auto f = (i(d, 3)[i], i << d);
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_PROTO_IGNORE_UNUSED(e, f);
+}
+
+void test_deep_copy_allocations()
+{
+    int j = 2;
+    proto::literal<int> i {1};
+    proto::literal<int &> r {j};
+    {
+        allocation_counter counter;
+        auto e = proto::deep_copy(i + r * 3);
+        CHECK_NO_ALLOCATIONS(counter);
+        BOOST_CHECK_EQUAL(proto::value(proto::left(e)), 1);
+    }
+
+    // Terminals that allocate when copied allocate exactly once per copy
+    std::string str(100, 'x');
+    proto::literal<std::string &> s {str};
+    {
+        allocation_counter counter;
+        auto e = proto::deep_copy(s + s);
+        BOOST_CHECK_EQUAL(counter.allocations(), 2u);
+        BOOST_TEST_MESSAGE("deep_copy of 2 std::string terminals: " << counter.allocations() << " allocations");
+        BOOST_CHECK_EQUAL(proto::value(proto::left(e)), str);
+    }
+}
+
+void test_eval_allocations()
+{
+    proto::literal<int> i {1};
+    proto::literal<double> d {2.5};
+    auto e = (i + d) * i - 4 / d;
+    allocation_counter counter;
+    double x = proto::_eval()(e);
+    bool b = proto::_eval()(i < d && !(i == 3));
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_EQUAL(x, (1 + 2.5) * 1 - 4 / 2.5);
+    BOOST_CHECK(b);
+}
+
+void test_fold_allocations()
+{
+    proto::literal<int> i {1};
+    auto e = i + i * i - i;
+    allocation_counter counter;
+    int leaves = CountLeaves()(e);
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_EQUAL(leaves, 4);
+}
+
+void test_let_allocations()
+{
+    proto::literal<int> i {1};
+    allocation_counter counter;
+    int sum = LetSum()(i + 41);
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_EQUAL(sum, 42);
+}
+
+void test_env_allocations()
+{
+    allocation_counter counter;
+    auto env = proto::make_env(placeholder_c<0>() = 1, placeholder_c<1>() = 2.5);
+    int i = env(placeholder_c<0>());
+    double d = env(placeholder_c<1>());
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_EQUAL(i, 1);
+    BOOST_CHECK_EQUAL(d, 2.5);
+}
+
+void test_lambda_allocations()
+{
+    allocation_counter counter;
+    auto fun = _1 + 42 * _2;
+    int i = lambda_eval()(fun, proto::make_env(placeholder_c<0>() = 8, placeholder_c<1>() = 2));
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_EQUAL(i, 92);
+}
+
+void test_hash_allocations()
+{
+    std::string str(100, 'x');
+    proto::literal<std::string &> s {str};
+    proto::literal<int> i {1};
+    auto e = s + s == i * 2;
+    allocation_counter counter;
+    std::size_t by_value = proto::hash_value(e);
+    std::size_t by_address = proto::hash_value<proto::hash_refs_by_address>(e);
+    bool equal = proto::expr_equal_to<>()(e, e);
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_NE(by_value, by_address);
+    BOOST_CHECK(equal);
+}
+
+void test_any_action_allocations()
+{
+    auto e = proto::literal<int>{3} * 4;
+    using action = proto::any_action<int(decltype(e) const &)>;
+    allocation_counter counter;
+    action eval = proto::_eval();
+    action copy = eval;
+    int i = copy(e);
+    copy = CountLeaves();
+    int j = copy(e);
+    CHECK_NO_ALLOCATIONS(counter);
+    BOOST_CHECK_EQUAL(i, 12);
+    BOOST_CHECK_EQUAL(j, 2);
+}
+
+void test_map_list_of_allocations()
+{
+    std::map<int, int> map;
+    {
+        allocation_counter counter;
+        auto e = map_list_of(1,2)(2,3)(3,4);
+        CHECK_NO_ALLOCATIONS(counter);
+
+        // Filling the map allocates one node per element, and nothing else.
+        MapListOf()(e, proto::data = map);
+        BOOST_CHECK_EQUAL(counter.allocations(), 3u);
+        BOOST_TEST_MESSAGE("map_list_of with 3 elements: " << counter.allocations() << " allocations");
+    }
+    BOOST_CHECK_EQUAL(map.size(), 3u);
+    BOOST_CHECK_EQUAL(map[2], 3);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("testing that expressions do not allocate");
+
+    test->add(BOOST_TEST_CASE(&test_make_expr_allocations));
+    test->add(BOOST_TEST_CASE(&test_operator_allocations));
+    test->add(BOOST_TEST_CASE(&test_deep_copy_allocations));
+    test->add(BOOST_TEST_CASE(&test_eval_allocations));
+    test->add(BOOST_TEST_CASE(&test_fold_allocations));
+    test->add(BOOST_TEST_CASE(&test_let_allocations));
+    test->add(BOOST_TEST_CASE(&test_env_allocations));
+    test->add(BOOST_TEST_CASE(&test_lambda_allocations));
+    test->add(BOOST_TEST_CASE(&test_hash_allocations));
+    test->add(BOOST_TEST_CASE(&test_any_action_allocations));
+    test->add(BOOST_TEST_CASE(&test_map_list_of_allocations));
+
+    return test;
+}
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// any_action.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <functional>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using mul_ = proto::expr<proto::multiplies(int_, int_)>;
+using sum_ = proto::expr<proto::plus(mul_, int_)>;
+
+// Returns the smaller of the two operands of a binary node
+struct _min
+  : proto::basic_action<_min>
+{
+    template<typename E, typename ...Rest>
+    int operator()(E const &e, Rest &&...) const
+    {
+        int const left = proto::value(proto::child<0>(e));
+        int const right = proto::value(proto::child<1>(e));
+        return left < right ? left : right;
+    }
+};
+
+// An action with some state
+struct _offset
+  : proto::basic_action<_offset>
+{
+    int offset;
+
+    template<typename E, typename ...Rest>
+    int operator()(E const &e, Rest &&...) const
+    {
+        return proto::_eval()(e) + offset;
+    }
+};
+
+// A grammar that leaves the handling of multiplications to its environment
+struct scale_rule
+  : proto::def<proto::multiplies(proto::terminal(int), proto::terminal(int))>
+{};
+
+struct calc
+  : proto::def<
+        proto::match(
+            proto::case_(proto::terminal(int), proto::_value)
+          , proto::case_(scale_rule, proto::external)
+          , proto::case_(proto::plus(calc, calc), proto::eval_with(calc))
+        )
+    >
+{};
+
+// An environment holding the action for scale_rule, chosen at runtime. It has to be declared
+// ahead because the type of the any_action names it.
+struct strategies;
+using strategy = proto::any_action<int(mul_ const &, strategies const &)>;
+
+struct strategies
+{
+    strategy scale;
+
+    strategy const &operator()(scale_rule) const
+    {
+        return scale;
+    }
+};
+
+void test_any_action()
+{
+    mul_ m{proto::multiplies(), int_{3}, int_{4}};
+    proto::any_action<int(mul_ const &)> act;
+    BOOST_CHECK(!act);
+    BOOST_CHECK_THROW(act(m), std::bad_function_call);
+
+    act = proto::_eval();
+    BOOST_CHECK(!!act);
+    BOOST_CHECK_EQUAL(act(m), 12);
+
+    act = _min();
+    BOOST_CHECK_EQUAL(act(m), 3);
+
+    _offset off;
+    off.offset = 10;
+    act = off;
+    proto::any_action<int(mul_ const &)> copy = act;
+    BOOST_CHECK_EQUAL(copy(m), 22);
+
+    act.reset();
+    BOOST_CHECK(!act);
+    BOOST_CHECK_EQUAL(copy(m), 22);
+}
+
+void test_external()
+{
+    sum_ s{proto::plus(), mul_{proto::multiplies(), int_{3}, int_{4}}, int_{1}};
+    strategies env;
+
+    env.scale = proto::_eval();
+    BOOST_CHECK_EQUAL(calc()(s, env), 13);
+
+    env.scale = _min();
+    BOOST_CHECK_EQUAL(calc()(s, env), 4);
+
+    // The action can itself be a grammar
+    env.scale = proto::def<proto::case_(scale_rule, proto::_int<0>)>();
+    BOOST_CHECK_EQUAL(calc()(s, env), 1);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test the type-erased any_action");
+
+    test->add(BOOST_TEST_CASE(&test_any_action));
+    test->add(BOOST_TEST_CASE(&test_external));
+
+    return test;
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// any_expr.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <sstream>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using any_ = proto::any_expr<>;
+
+void test_operators()
+{
+    proto::any_expr_pool pool;
+    any_ x = any_::make_arg(pool, 0);
+    any_ y = any_::make_arg(pool, 1);
+
+    any_ e = x * 2 + y - 1;
+    BOOST_CHECK_EQUAL(e.tag_id(), proto::tag_id<proto::minus>::value);
+    BOOST_CHECK_EQUAL(e.size(), 2u);
+    BOOST_CHECK_EQUAL(*e.child(1).value_ptr<int>(), 1);
+    BOOST_CHECK(nullptr == e.child(1).value_ptr<long>());
+    BOOST_CHECK_EQUAL(e.eval<int>(3, 4), 9);
+    BOOST_CHECK_EQUAL(e.eval<double>(0.5, 4), 4.0);
+    BOOST_CHECK_EQUAL(pool.size(), 7u);
+
+    BOOST_CHECK_EQUAL((x && y).eval<bool>(true, false), false);
+
+    // && and || yield a bool, as with _eval, even when they stop at their first operand
+    BOOST_CHECK_EQUAL((x || y).eval<int>(5, 0), 1);
+    BOOST_CHECK_EQUAL((x && y).eval<int>(5, 7), 1);
+    BOOST_CHECK_EQUAL((x && y).eval<int>(0, 7), 0);
+    BOOST_CHECK_EQUAL(any_::make(pool, proto::logical_or(), x, y, x).eval<int>(0, 0), 0);
+    BOOST_CHECK_EQUAL(any_::make(pool, proto::logical_or(), x, y, x).eval<int>(0, 5), 1);
+    BOOST_CHECK_EQUAL(if_else(x < y, x, y).eval<int>(4, 3), 3);
+    BOOST_CHECK_EQUAL((-x)[y].tag_id(), proto::tag_id<proto::subscript>::value);
+    BOOST_CHECK_EQUAL(x(1, 2, y).size(), 4u);
+    BOOST_CHECK_EQUAL((x++).tag_id(), proto::tag_id<proto::post_inc>::value);
+}
+
+void test_make()
+{
+    proto::any_expr_pool pool;
+    any_ x = any_::make_arg(pool, 0);
+
+    // As if read from a configuration file
+    any_ sum = any_::make(pool, proto::tag_id<proto::plus>::value, {x, x, any_::make_terminal(pool, 10)});
+    BOOST_CHECK_EQUAL(sum.size(), 3u);
+    BOOST_CHECK_EQUAL(sum.eval<long>(1), 12);
+
+    any_ all = any_::make(pool, proto::logical_and(), x, true, x);
+    BOOST_CHECK_EQUAL(all.eval<bool>(true), true);
+    BOOST_CHECK_EQUAL(all.eval<bool>(false), false);
+
+    // The comma operator evaluates both operands and yields the right one
+    any_ ten = any_::make_terminal(pool, 10);
+    BOOST_CHECK_EQUAL(any_::make(pool, proto::comma(), x, ten).eval<int>(3), 10);
+    BOOST_CHECK_THROW(any_::make(pool, proto::comma(), sum, ten).eval<int>(), proto::any_expr_error);
+
+    // ~ is not applied to bools
+    BOOST_CHECK_EQUAL((~x).eval<int>(0), -1);
+    BOOST_CHECK_THROW((~x).eval<bool>(true), proto::any_expr_error);
+
+    BOOST_CHECK_THROW(any_::make(pool, proto::tag_id<proto::negate>::value, {x, x}), proto::any_expr_error);
+    BOOST_CHECK_THROW(any_::make(pool, 200, {x}), proto::any_expr_error);
+
+    proto::any_expr_pool other;
+    BOOST_CHECK_THROW(any_::make(other, proto::negate(), x), proto::any_expr_error);
+    BOOST_CHECK_THROW(sum.eval<int>(), proto::any_expr_error);
+    BOOST_CHECK_THROW((x + std::string("oops")).eval<int>(1), proto::any_expr_error);
+}
+
+void test_wrap()
+{
+    proto::any_expr_pool pool;
+    any_ x = any_::make_arg(pool, 0);
+
+    // 5 + x, where x is a runtime expression inside a static one
+    using x_ = proto::literal<any_>;
+    proto::expr<proto::plus(int_, x_)> e{proto::plus(), int_{5}, x_{x}};
+    any_ a(pool, e);
+    BOOST_CHECK_EQUAL(pool.size(), 3u);
+    BOOST_CHECK_EQUAL(a.eval<int>(7), proto::_eval()(proto::expr<proto::plus(int_, int_)>{proto::plus(), int_{5}, int_{7}}));
+
+    using sum_ = proto::expr<proto::plus(int_...)>;
+    sum_ s {proto::plus()};
+    for(int i = 1; i <= 100; ++i)
+        proto::children_of(s).push_back(int_{i});
+    any_ b(pool, s);
+    BOOST_CHECK_EQUAL(b.size(), 100u);
+    BOOST_CHECK_EQUAL(b.eval<int>(), 5050);
+}
+
+void test_display()
+{
+    proto::any_expr_pool pool;
+    any_ e = any_::make_arg(pool, 0) + 42;
+    std::ostringstream sout;
+    proto::display_expr(e, sout);
+    BOOST_CHECK_EQUAL(sout.str(),
+        "plus(\n"
+        "    terminal( (proto::any_arg) arg0 )\n"
+        "  , terminal( (int) 42 )\n"
+        ")\n"
+    );
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test type-erased expressions");
+
+    test->add(BOOST_TEST_CASE(&test_operators));
+    test->add(BOOST_TEST_CASE(&test_make));
+    test->add(BOOST_TEST_CASE(&test_wrap));
+    test->add(BOOST_TEST_CASE(&test_display));
+
+    return test;
+}
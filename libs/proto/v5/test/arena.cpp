@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// arena.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using string_ = proto::literal<std::string>;
+using int_ = proto::literal<int>;
+using ints_ = proto::literal<std::vector<int>>;
+
+// name == "widget" && count < limits[1]
+using name_eq_ = proto::expr<proto::equal_to(string_, proto::literal<char const (&)[7]>)>;
+using count_lt_ = proto::expr<proto::less(int_, proto::expr<proto::subscript(ints_, int_)>)>;
+using pred_ = proto::expr<proto::logical_and(name_eq_, count_lt_)>;
+
+pred_ make_pred(std::string name, int count)
+{
+    return pred_{
+        proto::logical_and()
+      , name_eq_{proto::equal_to(), string_{name}, proto::literal<char const (&)[7]>{"widget"}}
+      , count_lt_{
+            proto::less()
+          , int_{count}
+          , proto::expr<proto::subscript(ints_, int_)>{
+                proto::subscript(), ints_{std::vector<int>{10, 20, 30}}, int_{1}
+            }
+        }
+    };
+}
+
+void test_arena()
+{
+    proto::arena a(64);
+    void *p = a.allocate(10, 1);
+    void *q = a.allocate(8, 8);
+    BOOST_CHECK(static_cast<char *>(q) >= static_cast<char *>(p) + 10);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(q) % 8, 0u);
+
+    // Requests bigger than a chunk get a chunk of their own
+    char *big = static_cast<char *>(a.allocate(1000));
+    std::memset(big, 'x', 1000);
+
+    a.clear();
+    BOOST_CHECK(a.allocate(10, 1) != nullptr);
+
+    // Aligning the last byte of a chunk takes the position past its end, so the request goes to
+    // a new chunk rather than just past the end of this one
+    proto::arena b(100);
+    char *first = static_cast<char *>(b.allocate(60, 1));
+    b.allocate(55, 1);
+    char *last = static_cast<char *>(b.allocate(1, 16));
+    *last = 'x';
+    BOOST_CHECK(last < first || last >= first + 132);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(last) % 16, 0u);
+
+    char *wide = static_cast<char *>(b.allocate(8, 256));
+    std::memset(wide, 'x', 8);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(wide) % 256, 0u);
+}
+
+void test_deep_copy_into()
+{
+    proto::arena a;
+    pred_ e = make_pred("widget", 15);
+    auto &c = proto::deep_copy_into(a, e);
+
+    // Owned data has been replaced with views of the arena
+    static_assert(std::is_same<proto::arena_string &, decltype(proto::value(proto::left(proto::left(c))))>::value, "");
+    static_assert(std::is_same<proto::arena_array<int> &, decltype(proto::value(proto::left(proto::right(proto::right(c)))))>::value, "");
+    static_assert(std::is_trivially_destructible<typename std::remove_reference<decltype(c)>::type>::value, "");
+    BOOST_CHECK(proto::value(proto::left(proto::left(c))) == "widget");
+    BOOST_CHECK(proto::value(proto::right(proto::left(c))) == std::string("widget"));
+    BOOST_CHECK_EQUAL(proto::value(proto::left(proto::right(proto::right(c))))[2], 30);
+    BOOST_CHECK(proto::_eval()(c));
+
+    // ... which is all in one region just after the copy
+    char const *begin = reinterpret_cast<char const *>(std::addressof(c));
+    char const *end = begin + proto::deep_copy_size(e);
+    char const *str = proto::value(proto::left(proto::left(c))).data();
+    BOOST_CHECK(str > begin && str < end);
+    BOOST_CHECK(str != proto::value(proto::left(proto::left(e))).data());
+
+    // The region can be moved with memcpy
+    using copy_type = typename std::remove_reference<decltype(c)>::type;
+    std::vector<std::max_align_t> buffer(proto::deep_copy_size(e) / sizeof(std::max_align_t) + 1);
+    std::memcpy(buffer.data(), static_cast<void const *>(std::addressof(c)), proto::deep_copy_size(e));
+    std::memset(static_cast<void *>(std::addressof(c)), 0, proto::deep_copy_size(e));
+    copy_type &d = *reinterpret_cast<copy_type *>(buffer.data());
+    BOOST_CHECK(proto::value(proto::left(proto::left(d))) == "widget");
+    BOOST_CHECK_EQUAL(proto::value(proto::left(proto::right(d))), 15);
+    BOOST_CHECK(proto::_eval()(d));
+
+    // Copied the usual way, an arena_array must be rebound to its elements
+    static_assert(std::is_trivially_copyable<copy_type>::value, "");
+    proto::arena_string f = proto::value(proto::left(proto::left(d)));
+    f.rebind(proto::value(proto::left(proto::left(d))));
+    BOOST_CHECK_EQUAL(f.data(), proto::value(proto::left(proto::left(d))).data());
+    BOOST_CHECK(f == "widget");
+
+    // Other copies are independent of each other
+    auto &g = proto::deep_copy_into(a, make_pred("gadget", 25));
+    BOOST_CHECK(!proto::_eval()(g));
+    BOOST_CHECK(proto::value(proto::left(proto::left(g))) != proto::value(proto::left(proto::left(d))));
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test deep_copy_into an arena");
+
+    test->add(BOOST_TEST_CASE(&test_arena));
+    test->add(BOOST_TEST_CASE(&test_deep_copy_into));
+
+    return test;
+}
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// bytecode.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <vector>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using arg_ = proto::literal<proto::any_arg>;
+using any_ = proto::any_expr<>;
+
+void test_compile()
+{
+    proto::any_expr_pool pool;
+    any_ x = any_::make_arg(pool, 0);
+    any_ y = any_::make_arg(pool, 1);
+
+    // x*2 + y occurs twice, and is computed once
+    any_ e = (x * 2 + y > 10 && x < y) || (x * 2 + y) == 7;
+    proto::bytecode<int> prog = proto::compile<int>(e);
+    BOOST_CHECK_EQUAL(prog.arity(), 2u);
+    BOOST_CHECK_EQUAL(prog.constants().size(), 3u);
+    for(int a = 0; a < 6; ++a)
+        for(int b = 0; b < 12; b += 5)
+            BOOST_CHECK_EQUAL(prog(a, b), e.eval<int>(a, b));
+
+    // Only one branch is taken
+    proto::bytecode<int> cond = proto::compile<int>(if_else(x < y, x * 100, y / x));
+    BOOST_CHECK_EQUAL(cond(0, 5), 0);
+    BOOST_CHECK_EQUAL(cond(4, 2), 0);
+    BOOST_CHECK_EQUAL(cond(2, 4), 200);
+
+    // && and || give the same results as _eval's left fold
+    for(int a = -1; a < 3; ++a)
+    {
+        for(int b = -1; b < 3; ++b)
+        {
+            BOOST_CHECK_EQUAL(proto::compile<int>(x || y)(a, b), (x || y).eval<int>(a, b));
+            BOOST_CHECK_EQUAL(proto::compile<int>(x && y)(a, b), (x && y).eval<int>(a, b));
+        }
+    }
+
+    // && and || yield a bool even when they stop at their first operand
+    BOOST_CHECK_EQUAL(proto::compile<int>(x || y)(5, 0), 1);
+    BOOST_CHECK_EQUAL(proto::compile<int>(x && y)(5, 7), 1);
+    any_ five = any_::make_terminal(pool, 5);
+    any_ zero = any_::make_terminal(pool, 0);
+    BOOST_CHECK_EQUAL(proto::compile<int>(five || zero)(), 1);
+    BOOST_CHECK_EQUAL(proto::compile<int>(zero || five)(), 1);
+    BOOST_CHECK_EQUAL(proto::compile<int>(five && zero)(), 0);
+
+    BOOST_CHECK_THROW(proto::compile<double>(x % y), proto::any_expr_error);
+    BOOST_CHECK_THROW(proto::compile<int>(x[y]), proto::any_expr_error);
+
+    // The comma operator yields its right operand, and ~ is not applied to bools
+    BOOST_CHECK_EQUAL(proto::compile<int>(any_::make(pool, proto::comma(), x, y))(1, 2), 2);
+    BOOST_CHECK_EQUAL(proto::compile<int>(~x)(0), -1);
+    BOOST_CHECK_THROW(proto::compile<bool>(~x), proto::any_expr_error);
+}
+
+void test_static()
+{
+    // x + 42, with x an input
+    proto::expr<proto::plus(arg_, int_)> e{proto::plus(), arg_{proto::any_arg{0}}, int_{42}};
+    BOOST_CHECK_EQUAL(proto::compile<int>(e)(8), 50);
+
+    // The constants are copied when compiling
+    int i = 1;
+    proto::expr<proto::multiplies(arg_, proto::expr<proto::terminal(int &)>)> m{
+        proto::multiplies(), arg_{proto::any_arg{0}}, proto::expr<proto::terminal(int &)>{i}
+    };
+    proto::bytecode<long> times = proto::compile<long>(m);
+    i = 2;
+    BOOST_CHECK_EQUAL(times(21), 21);
+
+    using all_ = proto::expr<proto::logical_and(arg_...)>;
+    all_ all{proto::logical_and()};
+    for(std::size_t n = 0; n < 3; ++n)
+        proto::children_of(all).push_back(arg_{proto::any_arg{n}});
+    proto::bytecode<int> prog = proto::compile<int>(all);
+    BOOST_CHECK_EQUAL(prog.arity(), 3u);
+    BOOST_CHECK_EQUAL(prog(1, 1, 1), 1);
+    BOOST_CHECK_EQUAL(prog(1, 0, 1), 0);
+}
+
+void test_batch()
+{
+    proto::any_expr_pool pool;
+    any_ x = any_::make_arg(pool, 0);
+    any_ y = any_::make_arg(pool, 1);
+
+    proto::bytecode<double> prog = proto::compile<double>(x * y - 1);
+    std::vector<double> const inputs = {1, 2, 3, 4, 5, 6};
+    std::vector<double> results(3);
+    prog.run_batch(inputs.data(), 3, results.data());
+    BOOST_CHECK_EQUAL(results[0], 1.0);
+    BOOST_CHECK_EQUAL(results[1], 11.0);
+    BOOST_CHECK_EQUAL(results[2], 29.0);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test the bytecode compiler and interpreter");
+
+    test->add(BOOST_TEST_CASE(&test_compile));
+    test->add(BOOST_TEST_CASE(&test_static));
+    test->add(BOOST_TEST_CASE(&test_batch));
+
+    return test;
+}
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// cache.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+struct cached_domain
+  : proto::domain<cached_domain>
+{
+    using cache_results = std::true_type;
+    using make_expr = proto::make_custom_expr<proto::expr<_, cached_domain>>;
+};
+
+using int_ = proto::expr<proto::terminal(int), cached_domain>;
+using ref_ = proto::expr<proto::terminal(int &), cached_domain>;
+using mul_ = proto::expr<proto::multiplies(ref_, int_), cached_domain>;
+
+int evaluations = 0;
+
+// Counts how often the cache has to evaluate, and adds the extra argument, if any
+struct _counting_eval
+  : proto::basic_action<_counting_eval>
+{
+    template<typename E>
+    int operator()(E const &e) const
+    {
+        ++evaluations;
+        return proto::_eval()(e);
+    }
+
+    template<typename E>
+    int operator()(E const &e, int offset) const
+    {
+        ++evaluations;
+        return proto::_eval()(e) + offset;
+    }
+};
+
+void test_cache()
+{
+    evaluations = 0;
+    int x = 3, y = 4;
+    mul_ a{proto::multiplies(), ref_{x}, int_{2}};
+    mul_ b{proto::multiplies(), ref_{y}, int_{2}};
+    proto::result_cache<mul_, int, _counting_eval> cache;
+
+    BOOST_CHECK_EQUAL(cache(a), 6);
+    BOOST_CHECK_EQUAL(cache(a), 6);
+    BOOST_CHECK_EQUAL(cache(b), 8);
+    BOOST_CHECK_EQUAL(evaluations, 2);
+    BOOST_CHECK_EQUAL(cache.hits(), 1u);
+    BOOST_CHECK_EQUAL(cache.misses(), 2u);
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+
+    // Keys hold values, not references: a now looks like b
+    x = 4;
+    BOOST_CHECK_EQUAL(cache(a), 8);
+    BOOST_CHECK_EQUAL(evaluations, 2);
+
+    x = 5;
+    BOOST_CHECK_EQUAL(cache(a), 10);
+    BOOST_CHECK_EQUAL(evaluations, 3);
+
+    cache.reset_counters();
+    BOOST_CHECK_EQUAL(cache.hits(), 0u);
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.size(), 0u);
+}
+
+void test_eviction()
+{
+    evaluations = 0;
+    int x = 1, y = 2, z = 3;
+    mul_ a{proto::multiplies(), ref_{x}, int_{2}};
+    mul_ b{proto::multiplies(), ref_{y}, int_{2}};
+    mul_ c{proto::multiplies(), ref_{z}, int_{2}};
+    proto::result_cache<mul_, int, _counting_eval> cache(2);
+
+    cache(a);
+    cache(b);
+    cache(a);   // a is now the most recently used
+    cache(c);   // forgets b
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+    BOOST_CHECK_EQUAL(evaluations, 3);
+    cache(a);
+    BOOST_CHECK_EQUAL(evaluations, 3);
+    cache(b);
+    BOOST_CHECK_EQUAL(evaluations, 4);
+
+    cache.capacity(1);
+    BOOST_CHECK_EQUAL(cache.size(), 1u);
+    cache(b);
+    BOOST_CHECK_EQUAL(evaluations, 4);
+
+    cache.capacity(0);
+    BOOST_CHECK_EQUAL(cache.size(), 0u);
+    BOOST_CHECK_EQUAL(cache(b), 4);
+    BOOST_CHECK_EQUAL(cache.size(), 0u);
+}
+
+void test_args()
+{
+    evaluations = 0;
+    int x = 3;
+    mul_ a{proto::multiplies(), ref_{x}, int_{2}};
+    proto::result_cache<mul_, int, _counting_eval, int> cache;
+
+    BOOST_CHECK_EQUAL(cache(a, 1), 7);
+    BOOST_CHECK_EQUAL(cache(a, 1), 7);
+    BOOST_CHECK_EQUAL(cache(a, 2), 8);
+    BOOST_CHECK_EQUAL(evaluations, 2);
+}
+
+void test_uncached_domain()
+{
+    evaluations = 0;
+    using lit_ = proto::literal<int>;
+    proto::expr<proto::plus(lit_, lit_)> p{proto::plus(), lit_{1}, lit_{2}};
+    proto::result_cache<decltype(p), int, _counting_eval> cache;
+
+    BOOST_CHECK_EQUAL(cache(p), 3);
+    BOOST_CHECK_EQUAL(cache(p), 3);
+    BOOST_CHECK_EQUAL(evaluations, 2);
+    BOOST_CHECK_EQUAL(cache.size(), 0u);
+    BOOST_CHECK_EQUAL(cache.misses(), 0u);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test the cache of evaluation results");
+
+    test->add(BOOST_TEST_CASE(&test_cache));
+    test->add(BOOST_TEST_CASE(&test_eviction));
+    test->add(BOOST_TEST_CASE(&test_args));
+    test->add(BOOST_TEST_CASE(&test_uncached_domain));
+
+    return test;
+}
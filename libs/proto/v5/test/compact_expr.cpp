@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// compact_expr.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <memory>
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+struct placeholder
+{};
+
+using int_ = proto::literal<int>;
+using int_ref_ = proto::literal<int &>;
+using double_ = proto::literal<double>;
+using placeholder_ = proto::literal<placeholder>;
+
+// i + (j * d) - _1
+using times_ = proto::expr<proto::multiplies(int_ref_, double_)>;
+using plus_ = proto::expr<proto::plus(int_, times_)>;
+using expr_ = proto::expr<proto::minus(plus_, placeholder_)>;
+
+void test_compact_layout()
+{
+    using compact = proto::compact_expr<expr_>;
+    static_assert(std::is_same<proto::exprs::children<int, int &, double, placeholder>, compact::proto_values_type>::value, "");
+    static_assert(sizeof(compact) == sizeof(proto::exprs::children<int, int &, double>), "");
+    static_assert(std::is_trivially_copyable<compact>::value, "");
+    static_assert(std::is_trivially_copyable<proto::compact_expr<proto::expr<proto::plus(int_, double_)>>>::value, "");
+    static_assert(std::is_same<proto::minus, compact::proto_tag_type>::value, "");
+}
+
+void test_compact_access()
+{
+    int j = 2;
+    expr_ e {proto::minus(), plus_{proto::plus(), int_{1}, times_{proto::multiplies(), int_ref_{j}, double_{3.5}}}, placeholder_()};
+    auto c = proto::compact(e);
+    static_assert(std::is_same<proto::compact_expr<expr_>, decltype(c)>::value, "");
+
+    BOOST_CHECK_EQUAL(proto::value(proto::left(proto::left(c))), 1);
+    BOOST_CHECK_EQUAL(proto::value(proto::left(proto::right(proto::left(c)))), 2);
+    BOOST_CHECK_EQUAL(proto::value(proto::child<1>(proto::child<1>(proto::child<0>(c)))), 3.5);
+    static_assert(std::is_same<int &, decltype(proto::value(proto::left(proto::left(c))))>::value, "");
+    static_assert(std::is_same<placeholder &, decltype(proto::value(proto::right(c)))>::value, "");
+    static_assert(std::is_same<proto::multiplies, decltype(proto::tag_of(proto::right(proto::left(c))))>::value, "");
+
+    // Terminals held by reference still refer to the same object
+    BOOST_CHECK_EQUAL(std::addressof(proto::value(proto::left(proto::right(proto::left(c))))), &j);
+
+    // Views write through to the compact expression
+    proto::value(proto::left(proto::left(c))) = 42;
+    BOOST_CHECK_EQUAL(proto::exprs::get<0>(c.proto_values_), 42);
+
+    auto const &cc = c;
+    static_assert(std::is_same<int const &, decltype(proto::value(proto::left(proto::left(cc))))>::value, "");
+    static_assert(std::is_same<int &, decltype(proto::value(proto::left(proto::right(proto::left(cc)))))>::value, "");
+    static_assert(std::is_same<double const &, decltype(proto::value(proto::right(proto::right(proto::left(cc)))))>::value, "");
+
+    proto::compact_expr<int_> t = proto::compact(int_{7});
+    static_assert(std::is_same<int &&, decltype(proto::value(std::move(t)))>::value, "");
+    BOOST_CHECK_EQUAL(proto::value(t), 7);
+}
+
+void test_compact_compare()
+{
+    int j = 2;
+    expr_ e {proto::minus(), plus_{proto::plus(), int_{1}, times_{proto::multiplies(), int_ref_{j}, double_{3.5}}}, placeholder_()};
+    auto c = proto::compact(proto::left(e));
+    auto d = c;
+    BOOST_CHECK(c == d);
+    proto::value(proto::right(proto::right(d))) = 4.5;
+    BOOST_CHECK(c != d);
+}
+
+void test_compact_expand()
+{
+    int j = 2;
+    using expr2_ = proto::expr<proto::minus(plus_, int_)>;
+    expr2_ e {proto::minus(), plus_{proto::plus(), int_{1}, times_{proto::multiplies(), int_ref_{j}, double_{3.5}}}, int_{4}};
+    auto c = proto::compact(e);
+    auto x = proto::expand(c);
+    static_assert(proto::is_expr<decltype(x)>::value, "");
+    static_assert(std::is_same<proto::minus const &, decltype(proto::tag_of(x))>::value, "");
+
+    // The terminals of the expanded expression refer to the compact expression's values
+    BOOST_CHECK_EQUAL(std::addressof(proto::value(proto::left(proto::left(x)))), std::addressof(proto::value(proto::left(proto::left(c)))));
+    BOOST_CHECK_EQUAL(std::addressof(proto::value(proto::left(proto::right(proto::left(x))))), &j);
+
+    double result = proto::_eval()(x);
+    BOOST_CHECK_EQUAL(result, proto::_eval()(e));
+    BOOST_CHECK_EQUAL(result, 1 + 2 * 3.5 - 4);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test the compact expression representation");
+
+    test->add(BOOST_TEST_CASE(&test_compact_layout));
+    test->add(BOOST_TEST_CASE(&test_compact_access));
+    test->add(BOOST_TEST_CASE(&test_compact_compare));
+    test->add(BOOST_TEST_CASE(&test_compact_expand));
+
+    return test;
+}
@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// counted.hpp
+// A terminal value type that counts how often it is copied, for testing that transforms move
+// rather than copy.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_PROTO_CXX11_TEST_COUNTED_HPP_INCLUDED
+#define BOOST_PROTO_CXX11_TEST_COUNTED_HPP_INCLUDED
+
+struct counted
+{
+    int value;
+
+    explicit counted(int i)
+      : value(i)
+    {}
+
+    counted(counted const &that)
+      : value(that.value)
+    {
+        ++copies();
+    }
+
+    counted(counted &&) = default;
+
+    static int &copies()
+    {
+        static int n = 0;
+        return n;
+    }
+};
+
+#endif
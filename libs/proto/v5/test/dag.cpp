@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// dag.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <sstream>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using ref_ = proto::expr<proto::terminal(int &)>;
+using mul_ = proto::expr<proto::multiplies(ref_, ref_)>;
+
+void test_sharing()
+{
+    int a = 3, b = 4;
+    // a*b + a*b
+    proto::expr<proto::plus(mul_, mul_)> e{
+        proto::plus()
+      , mul_{proto::multiplies(), ref_{a}, ref_{b}}
+      , mul_{proto::multiplies(), ref_{a}, ref_{b}}
+    };
+    proto::expr_dag dag = proto::lower(e);
+    BOOST_CHECK_EQUAL(dag.size(), 4u);
+    BOOST_CHECK_EQUAL(dag.terminal_count(), 2u);
+
+    proto::expr_dag::node_id const root = dag.root();
+    BOOST_CHECK_EQUAL(dag.tag_id(root), proto::tag_id<proto::plus>::value);
+    BOOST_CHECK_EQUAL(dag.children(root).size(), 2u);
+    BOOST_CHECK_EQUAL(dag.children(root)[0], dag.children(root)[1]);
+
+    proto::expr_dag::node_id const mul = dag.children(root)[0];
+    BOOST_CHECK(dag.is_terminal(dag.children(mul)[0]));
+    BOOST_CHECK_EQUAL(dag.value_ptr<int>(dag.children(mul)[0]), &a);
+
+    std::ostringstream sout;
+    sout << dag;
+    BOOST_CHECK_EQUAL(sout.str(),
+        "%0 = terminal((int) 3)\n"
+        "%1 = terminal((int) 4)\n"
+        "%2 = multiplies(%0, %1)\n"
+        "%3 = plus(%2, %2)\n"
+    );
+
+    // Lowering another expression into the same DAG reuses its nodes
+    BOOST_CHECK_EQUAL(proto::_lower()(proto::left(e), dag), mul);
+    BOOST_CHECK_EQUAL(dag.size(), 4u);
+}
+
+void test_eval()
+{
+    int a = 3, b = 4;
+    proto::expr<proto::plus(mul_, mul_)> e{
+        proto::plus()
+      , mul_{proto::multiplies(), ref_{a}, ref_{b}}
+      , mul_{proto::multiplies(), ref_{a}, ref_{b}}
+    };
+    proto::expr_dag dag = proto::lower(e);
+    BOOST_CHECK_EQUAL(dag.eval<int>(), proto::_eval()(e));
+
+    // Terminals are evaluated through references to the expression's values
+    a = 5;
+    BOOST_CHECK_EQUAL(dag.eval<int>(), 40);
+    BOOST_CHECK_EQUAL(dag.eval<double>(dag.children(dag.root())[0]), 20.0);
+}
+
+void test_constants()
+{
+    // Equal constants share a node, but distinct variables don't
+    proto::expr<proto::plus(int_, int_)> c{proto::plus(), int_{1}, int_{1}};
+    proto::expr_dag dag = proto::lower(c);
+    BOOST_CHECK_EQUAL(dag.size(), 2u);
+    BOOST_CHECK_EQUAL(dag.eval<int>(), 2);
+
+    int a = 1, b = 1;
+    mul_ m{proto::multiplies(), ref_{a}, ref_{b}};
+    BOOST_CHECK_EQUAL(proto::lower(m).size(), 3u);
+
+    using sum_ = proto::expr<proto::plus(int_...)>;
+    sum_ s {proto::plus()};
+    for(int i = 0; i != 100; ++i)
+        proto::children_of(s).push_back(int_{i % 10});
+    dag = proto::lower(s);
+    BOOST_CHECK_EQUAL(dag.size(), 11u);
+    BOOST_CHECK_EQUAL(dag.children(dag.root()).size(), 100u);
+    BOOST_CHECK_EQUAL(dag.eval<int>(), proto::_eval()(s));
+}
+
+void test_any_expr()
+{
+    proto::any_expr_pool pool;
+    proto::any_expr<> x = proto::any_expr<>::make_terminal(pool, 2);
+    proto::any_expr<> y = proto::any_expr<>::make_terminal(pool, 3);
+
+    // The pool's copies of equal numbers share a node
+    proto::expr_dag dag = proto::lower((x * 2 + y) * (x * 2 + y));
+    BOOST_CHECK_EQUAL(dag.size(), 5u);
+    BOOST_CHECK_EQUAL(dag.eval<int>(), 49);
+    BOOST_CHECK_EQUAL(dag.value_as<double>(dag.children(dag.children(dag.children(dag.root())[0])[0])[1]), 2.0);
+
+    // Each node of the pool is lowered once, however many parents it has
+    proto::any_expr<> s = x;
+    for(int i = 0; i != 40; ++i)
+        s = s + s;
+    dag = proto::lower(s);
+    BOOST_CHECK_EQUAL(dag.size(), 41u);
+    BOOST_CHECK_EQUAL(dag.eval<double>(), 2.0 * (1ull << 40));
+
+    // && and || yield a bool, as with _eval
+    proto::any_expr<> zero = proto::any_expr<>::make_terminal(pool, 0);
+    BOOST_CHECK_EQUAL(proto::lower(y || zero).eval<int>(), 1);
+    BOOST_CHECK_EQUAL(proto::lower(y && x).eval<int>(), 1);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test lowering expressions to a dag");
+
+    test->add(BOOST_TEST_CASE(&test_sharing));
+    test->add(BOOST_TEST_CASE(&test_eval));
+    test->add(BOOST_TEST_CASE(&test_constants));
+    test->add(BOOST_TEST_CASE(&test_any_expr));
+
+    return test;
+}
@@ -5,11 +5,13 @@
 //  Software License, Version 1.0. (See accompanying file
 //  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include <memory>
 #include <utility>
 #include <iostream>
 #include <boost/utility/addressof.hpp>
 #include <boost/proto/v5/core.hpp>
 #include "./unit_test.hpp"
+#include "./counted.hpp"
 
 namespace proto = boost::proto;
 
@@ -157,6 +159,40 @@ void test_noncopyable2()
     BOOST_PROTO_IGNORE_UNUSED(r1, r2);
 }
 
+void test_copies()
+{
+    using namespace proto;
+    using plus_ = exprs::plus<literal<counted>, literal<counted>>;
+    using times_ = exprs::multiplies<plus_, literal<counted>>;
+
+    times_ e {multiplies(), plus_{plus(), literal<counted>{counted(1)}, literal<counted>{counted(2)}}, literal<counted>{counted(3)}};
+
+    // Copying from an lvalue copies each terminal exactly once
+    counted::copies() = 0;
+    times_ r1 = deep_copy(e);
+    BOOST_CHECK_EQUAL(3, counted::copies());
+    BOOST_CHECK_EQUAL(2, value(right(left(r1))).value);
+
+    // Copying from an rvalue moves the terminals
+    counted::copies() = 0;
+    times_ r2 = deep_copy(std::move(e));
+    BOOST_CHECK_EQUAL(0, counted::copies());
+    BOOST_CHECK_EQUAL(3, value(right(r2)).value);
+}
+
+void test_move_only()
+{
+    using namespace proto;
+    using plus_ = exprs::plus<literal<std::unique_ptr<int>>, literal<int>>;
+
+    plus_ e {plus(), literal<std::unique_ptr<int>>{std::unique_ptr<int>(new int(42))}, literal<int>{24}};
+    int *p = value(left(e)).get();
+    plus_ r = deep_copy(std::move(e));
+    BOOST_CHECK_EQUAL(p, value(left(r)).get());
+    BOOST_CHECK_EQUAL(42, *value(left(r)));
+    BOOST_CHECK_EQUAL(24, value(right(r)));
+}
+
 using namespace boost::unit_test;
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // init_unit_test_suite
@@ -170,6 +206,8 @@ test_suite* init_unit_test_suite( int argc, char* argv[] )
     test->add(BOOST_TEST_CASE(&test_moveable));
     test->add(BOOST_TEST_CASE(&test_noncopyable));
     test->add(BOOST_TEST_CASE(&test_noncopyable2));
+    test->add(BOOST_TEST_CASE(&test_copies));
+    test->add(BOOST_TEST_CASE(&test_move_only));
 
     return test;
 }
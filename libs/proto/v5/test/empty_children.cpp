@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// empty_children.cpp
+// Verify that empty children and stateless tags take up no space in an expression.
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <memory>
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+template<int I>
+struct placeholder
+{};
+
+using _1_type = proto::literal<placeholder<0>>;
+using _2_type = proto::literal<placeholder<1>>;
+using int_ = proto::literal<int>;
+using three_ = proto::literal<std::integral_constant<int, 3>>;
+
+template<typename T>
+struct is_packed
+  : std::integral_constant<
+        bool
+      , std::is_trivial<T>::value &&
+        std::is_standard_layout<T>::value
+    >
+{};
+
+void test_empty_children_layout()
+{
+    using proto::exprs::children;
+
+    static_assert(std::is_empty<children<placeholder<0>>>::value, "");
+    static_assert(std::is_empty<children<placeholder<0>, placeholder<1>>>::value, "");
+    static_assert(sizeof(children<placeholder<0>, int>) == sizeof(int), "");
+    static_assert(sizeof(children<int, placeholder<0>>) == sizeof(int), "");
+    static_assert(sizeof(children<std::integral_constant<int, 1>, int, placeholder<0>>) == sizeof(int), "");
+    static_assert(is_packed<children<placeholder<0>, int>>::value, "");
+    static_assert(is_packed<children<int, placeholder<0>, placeholder<1>>>::value, "");
+
+    // Children with state are laid out as before
+    static_assert(sizeof(children<char, char, int>) == sizeof(children<int, int>), "");
+    static_assert(std::is_trivial<children<int &, int &>>::value, "");
+
+    children<placeholder<0>, int, placeholder<1>> c {placeholder<0>(), 42, placeholder<1>()};
+    static_assert(std::is_same<placeholder<0> &, decltype(proto::exprs::get<0>(c))>::value, "");
+    static_assert(std::is_same<int &, decltype(proto::exprs::get<1>(c))>::value, "");
+    static_assert(std::is_same<placeholder<1> &&, decltype(proto::exprs::get<2>(std::move(c)))>::value, "");
+    static_assert(std::is_same<int const &, decltype(proto::exprs::get<1>(static_cast<decltype(c) const &>(c)))>::value, "");
+    BOOST_CHECK_EQUAL(proto::exprs::get<1>(c), 42);
+    BOOST_CHECK(static_cast<void *>(std::addressof(proto::exprs::get<1>(c))) == static_cast<void *>(&c));
+
+    using one = std::integral_constant<int, 1>;
+    children<one, int> d {one(), 42}, e {one(), 42}, f {one(), 43};
+    BOOST_CHECK(d == e);
+    BOOST_CHECK(!(d == f));
+}
+
+void test_empty_terminals()
+{
+    static_assert(std::is_empty<_1_type>::value, "");
+    static_assert(std::is_empty<three_>::value, "");
+    static_assert(std::is_trivial<_1_type>::value, "");
+    static_assert(sizeof(int_) == sizeof(int), "");
+
+    _1_type _1;
+    three_ three;
+    static_assert(std::is_same<placeholder<0> &, decltype(proto::value(_1))>::value, "");
+    static_assert(std::is_same<std::integral_constant<int, 3> &&, decltype(proto::value(std::move(three)))>::value, "");
+    BOOST_CHECK_EQUAL(proto::value(three).value, 3);
+}
+
+void test_empty_children_in_exprs()
+{
+    using plus_ = proto::expr<proto::plus(_1_type, int_)>;
+    using times_ = proto::expr<proto::multiplies(plus_, _2_type)>;
+
+    static_assert(sizeof(plus_) == sizeof(int), "");
+    static_assert(sizeof(times_) == sizeof(int), "");
+    static_assert(std::is_empty<proto::expr<proto::plus(_1_type, _2_type)>>::value, "");
+    static_assert(sizeof(proto::expr<proto::plus(three_, int_)>) == sizeof(int), "");
+    static_assert(is_packed<plus_>::value, "");
+    static_assert(is_packed<times_>::value, "");
+
+    times_ e {proto::multiplies(), plus_{proto::plus(), _1_type(), int_{42}}, _2_type()};
+    BOOST_CHECK_EQUAL(proto::value(proto::right(proto::left(e))), 42);
+    static_assert(std::is_same<_2_type &, decltype(proto::right(e))>::value, "");
+    static_assert(std::is_same<_1_type &&, decltype(proto::left(proto::left(std::move(e))))>::value, "");
+
+    times_ f = e;
+    proto::value(proto::right(proto::left(f))) = 43;
+    BOOST_CHECK_EQUAL(proto::value(proto::right(proto::left(e))), 42);
+    BOOST_CHECK_EQUAL(proto::value(proto::right(proto::left(f))), 43);
+
+    // Still recognized as expressions
+    static_assert(proto::is_expr<_1_type>::value, "");
+    static_assert(proto::is_expr<times_ const &>::value, "");
+    static_assert(!proto::is_expr<placeholder<0>>::value, "");
+
+    // The tag isn't stored, and the shared instance can't be changed through an expression
+    static_assert(std::is_same<proto::multiplies const &, decltype(proto::tag_of(e))>::value, "");
+    static_assert(std::is_same<proto::multiplies const &, decltype(proto::tag_of(std::move(e)))>::value, "");
+    BOOST_CHECK(&proto::tag_of(e) == &proto::tag_of(f));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The lambda of example/lambda.cpp
+template<typename ExprDesc>
+struct lambda_expr
+  : proto::basic_expr<lambda_expr<ExprDesc>>
+  , proto::expr_assign<lambda_expr<ExprDesc>>
+  , proto::expr_subscript<lambda_expr<ExprDesc>>
+{
+    using proto::basic_expr<lambda_expr>::basic_expr;
+    using proto::expr_assign<lambda_expr>::operator=;
+};
+
+using lambda = proto::custom<lambda_expr<_>>;
+
+void test_lambda_size()
+{
+    using _1_type = lambda::terminal<placeholder<0>>;
+    using _2_type = lambda::terminal<placeholder<1>>;
+    using int_ = lambda::terminal<int>;
+    static_assert(std::is_empty<_1_type>::value, "");
+
+    // _1 + 42 * _2
+    using fun_type =
+        lambda::expr<proto::plus(_1_type, lambda::expr<proto::multiplies(int_, _2_type)>)>;
+    static_assert(sizeof(fun_type) == sizeof(int), "");
+    static_assert(is_packed<fun_type>::value, "");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The virtual members of example/virtual_member.cpp
+struct else_tag {};
+struct while_tag {};
+
+template<typename ExprDesc>
+struct expression
+  : proto::basic_expr<expression<ExprDesc>>
+{
+    using proto::basic_expr<expression<ExprDesc>>::basic_expr;
+
+    BOOST_PROTO_EXTENDS_MEMBERS(
+        expression,
+        ((else_tag,  else_))
+        ((while_tag, while_))
+    );
+};
+
+using mini_lambda = proto::custom<expression<_>>;
+
+void test_virtual_member_size()
+{
+    mini_lambda::terminal<placeholder<0>> _1;
+    mini_lambda::terminal<int> i {42};
+
+    // The virtual members all share one byte, and the placeholder takes none.
+    static_assert(sizeof(_1) == 1, "");
+
+    BOOST_CHECK(static_cast<void const *>(std::addressof(proto::child<0>(i.else_))) ==
+                static_cast<void const *>(std::addressof(i)));
+    BOOST_CHECK_EQUAL(proto::value(proto::child<0>(i.while_)), 42);
+    BOOST_PROTO_IGNORE_UNUSED(_1);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("testing that empty children take up no space");
+
+    test->add(BOOST_TEST_CASE(&test_empty_children_layout));
+    test->add(BOOST_TEST_CASE(&test_empty_terminals));
+    test->add(BOOST_TEST_CASE(&test_empty_children_in_exprs));
+    test->add(BOOST_TEST_CASE(&test_lambda_size));
+    test->add(BOOST_TEST_CASE(&test_virtual_member_size));
+
+    return test;
+}
@@ -8,6 +8,12 @@
 #include <sstream>
 #include <boost/proto/v5/proto.hpp>
 #include <boost/fusion/include/for_each.hpp>
+#include <boost/fusion/include/at_c.hpp>
+#include <boost/fusion/include/size.hpp>
+#include <boost/fusion/include/begin.hpp>
+#include <boost/fusion/include/end.hpp>
+#include <boost/fusion/include/prior.hpp>
+#include <boost/fusion/include/deref.hpp>
 #include "./unit_test.hpp"
 
 namespace fusion = boost::fusion;
@@ -177,6 +183,31 @@ void test_extension()
     BOOST_CHECK_EQUAL("(a)(b)(c>>d)(e|f)(g>>h)(i)", sout.str());
 }
 
+////////////////////////////////////////////////////////////////////////
+// Test that the flattened view is random-access and holds nothing but
+// a reference to the expression
+void test_random_access()
+{
+    proto::literal<char> a_ {'a'};
+    proto::literal<char> b_ {'b'};
+    proto::literal<char> c_ {'c'};
+    proto::literal<char> d_ {'d'};
+
+    auto expr = a_ | b_ >> c_ | d_ | a_;
+    auto flat = proto::flatten(expr);
+    static_assert(fusion::result_of::size<decltype(flat)>::value == 4, "");
+    static_assert(sizeof(flat) == sizeof(void *), "");
+
+    BOOST_CHECK_EQUAL('a', proto::value(fusion::at_c<0>(flat)));
+    BOOST_CHECK_EQUAL('d', proto::value(fusion::at_c<2>(flat)));
+    BOOST_CHECK_EQUAL('a', proto::value(fusion::deref(fusion::prior(fusion::end(flat)))));
+
+    std::stringstream sout;
+    to_string{sout}(fusion::at_c<1>(flat));
+    BOOST_CHECK_EQUAL("(b>>c)", sout.str());
+    BOOST_CHECK_EQUAL(&proto::right(proto::left(proto::left(expr))), &fusion::at_c<1>(flat));
+}
+
 using namespace boost::unit_test;
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // init_unit_test_suite
@@ -187,6 +218,7 @@ test_suite* init_unit_test_suite( int argc, char* argv[] )
 
     test->add(BOOST_TEST_CASE(&test_expr));
     test->add(BOOST_TEST_CASE(&test_extension));
+    test->add(BOOST_TEST_CASE(&test_random_access));
 
     return test;
 }
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// hash.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <unordered_map>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using ref_ = proto::expr<proto::terminal(int &)>;
+using sum_ = proto::expr<proto::plus(int_, int_)>;
+using mul_ = proto::expr<proto::multiplies(ref_, ref_)>;
+
+enum class color { red, green };
+
+// An empty type with no operator==
+struct nothing_ {};
+
+void test_hash()
+{
+    sum_ a{proto::plus(), int_{1}, int_{2}};
+    sum_ b{proto::plus(), int_{1}, int_{2}};
+    sum_ c{proto::plus(), int_{2}, int_{1}};
+    BOOST_CHECK_EQUAL(proto::hash_value(a), proto::hash_value(b));
+    BOOST_CHECK_NE(proto::hash_value(a), proto::hash_value(c));
+    BOOST_CHECK_EQUAL(std::hash<sum_>()(a), proto::hash_value(a));
+    BOOST_CHECK(proto::expr_equal_to<>()(a, b));
+    BOOST_CHECK(!proto::expr_equal_to<>()(a, c));
+
+    // The shape is part of the hash
+    proto::expr<proto::negate(int_)> n{proto::negate(), int_{1}};
+    BOOST_CHECK_NE(proto::hash_value(n), proto::hash_value(int_{1}));
+
+    // Values of enumerations, strings and empty types
+    BOOST_CHECK_EQUAL(
+        proto::hash_value(proto::literal<color>{color::green})
+      , proto::hash_value(proto::literal<color>{color::green})
+    );
+    BOOST_CHECK_EQUAL(
+        proto::hash_value(proto::literal<std::string>{std::string("hi")})
+      , proto::hash_value(proto::literal<std::string>{std::string("hi")})
+    );
+    BOOST_CHECK_EQUAL(
+        proto::hash_value(proto::literal<proto::param<0>>{})
+      , proto::hash_value(proto::literal<proto::param<0>>{})
+    );
+    BOOST_CHECK(proto::expr_equal_to<>()(proto::literal<nothing_>{}, proto::literal<nothing_>{}));
+
+    // Values of different types aren't equal, even if they compare equal, as they hash differently
+    BOOST_CHECK(!proto::expr_equal_to<>()(int_{1}, proto::literal<double>{1.0}));
+    BOOST_CHECK(!proto::expr_equal_to<>()(int_{1}, proto::literal<long>{1}));
+}
+
+void test_refs()
+{
+    int x = 5, y = 5;
+    mul_ xx{proto::multiplies(), ref_{x}, ref_{x}};
+    mul_ yy{proto::multiplies(), ref_{y}, ref_{y}};
+    BOOST_CHECK_EQUAL(proto::hash_value(xx), proto::hash_value(yy));
+    BOOST_CHECK(proto::expr_equal_to<>()(xx, yy));
+
+    // By address, terminals referring to different objects differ
+    BOOST_CHECK_NE(
+        proto::hash_value<proto::hash_refs_by_address>(xx)
+      , proto::hash_value<proto::hash_refs_by_address>(yy)
+    );
+    BOOST_CHECK(!proto::expr_equal_to<proto::hash_refs_by_address>()(xx, yy));
+    BOOST_CHECK(proto::expr_equal_to<proto::hash_refs_by_address>()(xx, xx));
+
+    // An expression and its deep copy have different types but are equal
+    auto copy = proto::deep_copy(xx);
+    BOOST_CHECK_EQUAL(proto::hash_value(copy), proto::hash_value(xx));
+    BOOST_CHECK(proto::expr_equal_to<>()(copy, xx));
+    BOOST_CHECK(!proto::expr_equal_to<>()(copy, sum_{proto::plus(), int_{5}, int_{5}}));
+}
+
+void test_nary()
+{
+    using nary_ = proto::expr<proto::plus(int_...)>;
+    nary_ s{proto::plus()};
+    proto::children_of(s).push_back(int_{1});
+    nary_ t = s;
+    BOOST_CHECK_EQUAL(proto::hash_value(s), proto::hash_value(t));
+    BOOST_CHECK(proto::expr_equal_to<>()(s, t));
+
+    proto::children_of(t).push_back(int_{1});
+    BOOST_CHECK_NE(proto::hash_value(s), proto::hash_value(t));
+    BOOST_CHECK(!proto::expr_equal_to<>()(s, t));
+
+    // A runtime-arity node with one child isn't a unary node
+    proto::expr<proto::plus(int_)> u{proto::plus(), int_{1}};
+    BOOST_CHECK_NE(proto::hash_value(s), proto::hash_value(u));
+}
+
+void test_unordered_map()
+{
+    std::unordered_map<sum_, int, std::hash<sum_>, proto::expr_equal_to<>> cache;
+    cache[sum_{proto::plus(), int_{1}, int_{2}}] = 3;
+    cache[sum_{proto::plus(), int_{2}, int_{1}}] = 4;
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+    BOOST_CHECK_EQUAL(cache[(sum_{proto::plus(), int_{1}, int_{2}})], 3);
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test structural hashing of expressions");
+
+    test->add(BOOST_TEST_CASE(&test_hash));
+    test->add(BOOST_TEST_CASE(&test_refs));
+    test->add(BOOST_TEST_CASE(&test_nary));
+    test->add(BOOST_TEST_CASE(&test_unordered_map));
+
+    return test;
+}
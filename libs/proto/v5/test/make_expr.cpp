@@ -5,6 +5,8 @@
 //  Software License, Version 1.0. (See accompanying file
 //  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include <string>
+#include <type_traits>
 #include <boost/proto/v5/proto.hpp>
 #include <boost/utility/addressof.hpp>
 #include <boost/fusion/tuple.hpp>
@@ -371,6 +373,64 @@ void test_make_expr_transform_2()
     BOOST_CHECK_EQUAL(1, proto::value(proto::child<1>(proto::child<0>(res))));
 }
 
+template<typename ExprDesc>
+struct small_expr;
+
+struct small_domain
+  : proto::domain<small_domain>
+{
+    using store_value = proto::utility::small_by_val<>;
+    using make_expr = proto::make_custom_expr<small_expr<_>>;
+};
+
+template<typename ExprDesc>
+struct small_expr
+  : proto::expr<ExprDesc, small_domain>
+{
+    using proto::expr<ExprDesc, small_domain>::expr;
+};
+
+struct big
+{
+    char buf[32];
+};
+
+void test_small_by_val()
+{
+    int i = 42;
+    double d = 3.14;
+    big b {};
+    std::string s("hello");
+
+    static_assert(std::is_same<int, decltype(proto::utility::small_by_val<>()(i))>::value, "");
+    static_assert(std::is_same<double &, decltype(proto::utility::small_by_val<4>()(d))>::value, "");
+    static_assert(std::is_same<big &, decltype(proto::utility::small_by_val<>()(b))>::value, "");
+    static_assert(std::is_same<big, decltype(proto::utility::small_by_val<>()(big()))>::value, "");
+
+    // Small, trivially copyable values are stored by value
+    small_expr<proto::terminal(int)> t1 = proto::make_expr<small_domain>(proto::terminal(), i);
+    small_expr<proto::terminal(double)> t2 = proto::make_expr<small_domain>(proto::terminal(), d);
+    i = 0;
+    BOOST_CHECK_EQUAL(proto::value(t1), 42);
+    BOOST_CHECK_EQUAL(proto::value(t2), 3.14);
+
+    // Everything else is stored by reference, unless it is an rvalue
+    small_expr<proto::terminal(big &)> t3 = proto::make_expr<small_domain>(proto::terminal(), b);
+    small_expr<proto::terminal(std::string &)> t4 = proto::make_expr<small_domain>(proto::terminal(), s);
+    small_expr<proto::terminal(std::string)> t5 = proto::make_expr<small_domain>(proto::terminal(), std::string("world"));
+    small_expr<proto::terminal(char const (&)[6])> t6 = proto::make_expr<small_domain>(proto::terminal(), "hello");
+    BOOST_CHECK_EQUAL(&proto::value(t3), &b);
+    BOOST_CHECK_EQUAL(&proto::value(t4), &s);
+    BOOST_CHECK_EQUAL(proto::value(t5), "world");
+    BOOST_PROTO_IGNORE_UNUSED(t6);
+
+    // The policy applies to the terminals that make_expr creates for non-expression children
+    small_expr<proto::plus(small_expr<proto::terminal(double)>, small_expr<proto::terminal(std::string &)>)> p =
+        proto::make_expr<small_domain>(proto::plus(), d, s);
+    BOOST_CHECK_EQUAL(proto::value(proto::left(p)), 3.14);
+    BOOST_CHECK_EQUAL(&proto::value(proto::right(p)), &s);
+}
+
 using namespace boost::unit_test;
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // init_unit_test_suite
@@ -387,9 +447,9 @@ test_suite* init_unit_test_suite( int argc, char* argv[] )
     test->add(BOOST_TEST_CASE(&test_unpack_expr_2));
     test->add(BOOST_TEST_CASE(&test_unpack_expr_functional));
     test->add(BOOST_TEST_CASE(&test_unpack_expr_functional_2));
-    test->add(BOOST_TEST_CASE(&test_unpack_expr_functional));
     test->add(BOOST_TEST_CASE(&test_make_expr_transform));
     test->add(BOOST_TEST_CASE(&test_make_expr_transform_2));
+    test->add(BOOST_TEST_CASE(&test_small_by_val));
 
     return test;
 }
@@ -0,0 +1,260 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// nary_expr.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using sum_ = proto::expr<proto::plus(int_...)>;
+using call_ = proto::expr<proto::function(int_...)>;
+
+void test_nary_storage()
+{
+    static_assert(proto::is_expr<sum_>::value, "");
+    static_assert(proto::is_nary<sum_ &>::value, "");
+    static_assert(!proto::is_nary<proto::expr<proto::plus(int_, int_)>>::value, "");
+    static_assert(!proto::is_terminal<sum_>::value, "");
+    static_assert(std::is_same<proto::plus(int_...), sum_::proto_expr_descriptor_type>::value, "");
+
+    sum_ s {proto::plus(), {int_{1}, int_{2}, int_{3}}};
+    BOOST_CHECK_EQUAL(proto::children_of(s).size(), 3u);
+    BOOST_CHECK_EQUAL(proto::value(proto::child(s, 2)), 3);
+    static_assert(std::is_same<int_ &, decltype(proto::child(s, 0))>::value, "");
+    static_assert(std::is_same<int_ &&, decltype(proto::child(std::move(s), 0))>::value, "");
+    static_assert(std::is_same<proto::plus const &, decltype(proto::tag_of(s))>::value, "");
+
+    // The first few children are stored inline
+    auto &children = proto::children_of(s);
+    BOOST_CHECK(static_cast<void const *>(children.begin()) >= static_cast<void const *>(&s));
+    BOOST_CHECK(static_cast<void const *>(children.begin()) < static_cast<void const *>(&s + 1));
+
+    // ... and the rest in a single allocation
+    for(int i = 4; i <= 100; ++i)
+        children.push_back(int_{i});
+    BOOST_CHECK_EQUAL(children.size(), 100u);
+
+    // Sizes whose byte counts would overflow are refused, as by std::vector
+    BOOST_CHECK_THROW(children.reserve(std::size_t(-1)), std::length_error);
+    BOOST_CHECK_THROW(children.reserve(children.max_size() + 1), std::length_error);
+    BOOST_CHECK_EQUAL(children.size(), 100u);
+    BOOST_CHECK_EQUAL(proto::value(proto::child(s, 99)), 100);
+
+    sum_ t = s;
+    BOOST_CHECK_EQUAL(proto::children_of(t).size(), 100u);
+    BOOST_CHECK_EQUAL(proto::value(proto::child(t, 41)), 42);
+
+    int_ const *p = proto::children_of(s).begin();
+    sum_ u = std::move(s);
+    BOOST_CHECK_EQUAL(proto::children_of(u).begin(), p);
+    BOOST_CHECK(proto::children_of(s).empty());
+
+    std::vector<int> v {4, 5, 6};
+    call_ c {proto::function(), v.begin(), v.end()};
+    BOOST_CHECK_EQUAL(proto::children_of(c).size(), 3u);
+    BOOST_CHECK_EQUAL(proto::value(proto::child(c, 1)), 5);
+}
+
+void test_nary_move_only()
+{
+    using ptr_ = proto::literal<std::unique_ptr<int>>;
+    using ptrs_ = proto::expr<proto::comma(ptr_...)>;
+
+    ptrs_ e {proto::comma()};
+    for(int i = 0; i < 10; ++i)
+        proto::children_of(e).push_back(ptr_{std::unique_ptr<int>(new int(i))});
+    ptrs_ f = std::move(e);
+    BOOST_CHECK_EQUAL(*proto::value(proto::child(f, 9)), 9);
+}
+
+void test_nary_matches()
+{
+    static_assert(proto::matches<sum_, proto::plus(proto::terminal(int)...)>(), "");
+    static_assert(proto::matches<sum_, _(proto::terminal(_)...)>(), "");
+    static_assert(proto::matches<sum_, _>(), "");
+    static_assert(proto::matches<call_, proto::function(_...)>(), "");
+    static_assert(!proto::matches<sum_, proto::minus(proto::terminal(int)...)>(), "");
+    static_assert(!proto::matches<sum_, proto::plus(proto::terminal(char *)...)>(), "");
+    static_assert(!proto::matches<sum_, proto::plus(proto::terminal(int), proto::terminal(int))>(), "");
+    static_assert(!proto::matches<sum_, proto::plus(proto::terminal(int), proto::terminal(int)...)>(), "");
+}
+
+void test_nary_eval()
+{
+    sum_ s {proto::plus()};
+    BOOST_CHECK_EQUAL(proto::_eval()(s), 0);
+    for(int i = 1; i <= 1000; ++i)
+        proto::children_of(s).push_back(int_{i});
+    BOOST_CHECK_EQUAL(proto::_eval()(s), 500500);
+
+    using and_ = proto::expr<proto::logical_and(proto::literal<bool>...)>;
+    and_ a {proto::logical_and(), {proto::literal<bool>{true}, proto::literal<bool>{false}, proto::literal<bool>{true}}};
+    BOOST_CHECK(!proto::_eval()(a));
+
+    using nested_ = proto::expr<proto::multiplies(sum_...)>;
+    nested_ n {proto::multiplies(), {sum_{proto::plus(), {int_{1}, int_{2}}}, sum_{proto::plus(), {int_{3}, int_{4}}}}};
+    BOOST_CHECK_EQUAL(proto::_eval()(n), 21);
+}
+
+struct add_value
+  : proto::basic_action<add_value>
+{
+    template<typename E, typename Env, typename State>
+    int operator()(E && e, Env &&, State const &state) const
+    {
+        return state * 10 + proto::value(e);
+    }
+};
+
+void test_nary_fold()
+{
+    sum_ s {proto::plus(), {int_{1}, int_{2}, int_{3}}};
+    int i = proto::def<proto::fold(_, proto::_integral_constant<int, 0>(), add_value)>()(s);
+    BOOST_CHECK_EQUAL(i, 123);
+    int j = proto::def<proto::reverse_fold(_, proto::_integral_constant<int, 0>(), add_value)>()(s);
+    BOOST_CHECK_EQUAL(j, 321);
+}
+
+struct twice
+  : proto::basic_action<twice>
+{
+    template<typename E, typename ...Rest>
+    int_ operator()(E && e, Rest &&...) const
+    {
+        return int_{proto::value(e) * 2};
+    }
+};
+
+struct Twice
+  : proto::def<
+        proto::match(
+            proto::case_(proto::terminal(int), twice)
+          , proto::case_(_(Twice...), proto::passthru)
+        )
+    >
+{};
+
+void test_nary_passthru()
+{
+    int i = 1, j = 2;
+    using ref_ = proto::literal<int &>;
+    using refs_ = proto::expr<proto::function(ref_...)>;
+    refs_ r {proto::function(), {ref_{i}, ref_{j}}};
+
+    // deep_copy rebuilds the children
+    call_ c = proto::deep_copy(r);
+    BOOST_CHECK_EQUAL(proto::children_of(c).size(), 2u);
+    i = 42;
+    BOOST_CHECK_EQUAL(proto::value(proto::child(c, 0)), 1);
+    BOOST_CHECK_EQUAL(proto::value(proto::child(c, 1)), 2);
+
+    // So does passthru
+    sum_ s {proto::plus(), {int_{1}, int_{2}, int_{3}}};
+    sum_ t = Twice()(s);
+    BOOST_CHECK_EQUAL(proto::_eval()(t), 12);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// A domain that flattens chains of associative operators
+struct flat_domain
+  : proto::domain<flat_domain>
+{
+    using make_expr = proto::make_flat_expr<proto::expr<_, flat_domain>>;
+};
+
+using flat_int_ = proto::expr<proto::terminal(int), flat_domain>;
+using flat_double_ = proto::expr<proto::terminal(double), flat_domain>;
+using flat_sum_ = proto::expr<proto::plus(flat_int_...), flat_domain>;
+
+template<typename Tag, typename A, typename B>
+auto make(A && a, B && b)
+BOOST_PROTO_AUTO_RETURN(
+    proto::make_expr<flat_domain>(Tag(), static_cast<A &&>(a), static_cast<B &&>(b))
+)
+
+void test_flat_domain()
+{
+    static_assert(proto::is_associative<proto::plus>::value, "");
+    static_assert(proto::is_associative<proto::logical_or &>::value, "");
+    static_assert(!proto::is_associative<proto::minus>::value, "");
+
+    flat_int_ a{1}, b{2}, c{3}, d{4};
+
+    // A single operator is still a binary node
+    auto ab = make<proto::plus>(a, b);
+    static_assert(!proto::is_nary<decltype(ab)>::value, "");
+
+    // ... but a chain of them is one node
+    auto abcd = make<proto::plus>(make<proto::plus>(make<proto::plus>(a, b), c), d);
+    static_assert(std::is_same<flat_sum_, decltype(abcd)>::value, "");
+    BOOST_CHECK_EQUAL(proto::children_of(abcd).size(), 4u);
+    BOOST_CHECK_EQUAL(proto::value(proto::child(abcd, 3)), 4);
+    BOOST_CHECK_EQUAL(proto::_eval()(abcd), 10);
+
+    // Either side can be the flat one
+    auto dab = make<proto::plus>(d, ab);
+    static_assert(std::is_same<flat_sum_, decltype(dab)>::value, "");
+    BOOST_CHECK_EQUAL(proto::value(proto::child(dab, 0)), 4);
+    BOOST_CHECK_EQUAL(proto::value(proto::child(dab, 2)), 2);
+    auto all = make<proto::plus>(abcd, dab);
+    BOOST_CHECK_EQUAL(proto::children_of(all).size(), 7u);
+    BOOST_CHECK_EQUAL(proto::_eval()(all), 17);
+
+    // Flattened nodes hold their children by value
+    proto::value(a) = 42;
+    BOOST_CHECK_EQUAL(proto::value(proto::child(abcd, 0)), 1);
+
+    // Non-associative operators, other operators and mixed types aren't flattened
+    auto abc = make<proto::minus>(make<proto::minus>(a, b), c);
+    static_assert(!proto::is_nary<decltype(abc)>::value, "");
+    auto ab_c = make<proto::multiplies>(ab, c);
+    static_assert(!proto::is_nary<decltype(ab_c)>::value, "");
+    flat_double_ x{1.5};
+    auto abx = make<proto::plus>(ab, x);
+    static_assert(!proto::is_nary<decltype(abx)>::value, "");
+    BOOST_CHECK_EQUAL(proto::_eval()(abx), 42 + 2 + 1.5);
+
+    // A binary node whose children differ only in being held by reference still flattens
+    auto a12 = a + 1 + 2;
+    static_assert(std::is_same<flat_sum_, decltype(a12)>::value, "");
+    BOOST_CHECK_EQUAL(proto::children_of(a12).size(), 3u);
+    BOOST_CHECK_EQUAL(proto::_eval()(a12), 45);
+
+    // flatten on a flat node is its children
+    auto const &leaves = proto::flatten(all);
+    static_assert(std::is_same<decltype(leaves), flat_sum_::proto_children_type const &>::value, "");
+    BOOST_CHECK_EQUAL(&leaves, &proto::children_of(all));
+    BOOST_CHECK_EQUAL(leaves.size(), 7u);
+    BOOST_CHECK_EQUAL(proto::value(leaves[6]), 2);
+    BOOST_CHECK_EQUAL(proto::functional::flatten()(a12).size(), 3u);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test expressions with a runtime number of children");
+
+    test->add(BOOST_TEST_CASE(&test_nary_storage));
+    test->add(BOOST_TEST_CASE(&test_nary_move_only));
+    test->add(BOOST_TEST_CASE(&test_nary_matches));
+    test->add(BOOST_TEST_CASE(&test_nary_eval));
+    test->add(BOOST_TEST_CASE(&test_nary_fold));
+    test->add(BOOST_TEST_CASE(&test_nary_passthru));
+    test->add(BOOST_TEST_CASE(&test_flat_domain));
+
+    return test;
+}
@@ -5,9 +5,11 @@
 //  Software License, Version 1.0. (See accompanying file
 //  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include <memory>
 #include <type_traits>
 #include <boost/proto/v5/proto.hpp>
 #include "./unit_test.hpp"
+#include "./counted.hpp"
 namespace proto=boost::proto;
 using proto::_;
 
@@ -45,6 +47,46 @@ void test_passthru()
     BOOST_PROTO_IGNORE_UNUSED(y);
 }
 
+void test_passthru_copies()
+{
+    using counted_ = proto::literal<counted>;
+    using plus_ = proto::expr<proto::plus(counted_, counted_)>;
+    using negate_ = proto::expr<proto::negate(plus_)>;
+
+    negate_ x {proto::negate(), plus_{proto::plus(), counted_{counted(1)}, counted_{counted(2)}}};
+
+    // Rebuilding from an lvalue copies each terminal exactly once
+    counted::copies() = 0;
+    negate_ y = MinusToPlus()(x);
+    BOOST_CHECK_EQUAL(2, counted::copies());
+    BOOST_CHECK_EQUAL(2, proto::value(proto::right(proto::child<0>(y))).value);
+
+    // Rebuilding from an rvalue moves the terminals
+    counted::copies() = 0;
+    negate_ z = MinusToPlus()(std::move(x));
+    BOOST_CHECK_EQUAL(0, counted::copies());
+    BOOST_CHECK_EQUAL(1, proto::value(proto::left(proto::child<0>(z))).value);
+}
+
+void test_passthru_move_only()
+{
+    using ptr_ = proto::literal<std::unique_ptr<int>>;
+    using int_ = proto::literal<int>;
+    using negate_ = proto::expr<proto::negate(proto::expr<proto::complement(ptr_)>)>;
+
+    negate_ x {proto::negate(), proto::expr<proto::complement(ptr_)>{proto::complement(), ptr_{std::unique_ptr<int>(new int(42))}}};
+    int *p = proto::value(proto::child<0>(proto::child<0>(x))).get();
+    negate_ y = MinusToPlus()(std::move(x));
+    BOOST_CHECK_EQUAL(p, proto::value(proto::child<0>(proto::child<0>(y))).get());
+
+    using minus_ = proto::expr<proto::minus(ptr_, int_)>;
+    minus_ m {proto::minus(), ptr_{std::unique_ptr<int>(new int(42))}, int_{24}};
+    p = proto::value(proto::left(m)).get();
+    proto::expr<proto::plus(ptr_, int_)> n = MinusToPlus()(std::move(m));
+    BOOST_CHECK_EQUAL(p, proto::value(proto::left(n)).get());
+    BOOST_CHECK_EQUAL(24, proto::value(proto::right(n)));
+}
+
 using namespace boost::unit_test;
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // init_unit_test_suite
@@ -54,6 +96,8 @@ test_suite* init_unit_test_suite( int argc, char* argv[] )
     test_suite *test = BOOST_TEST_SUITE("test proto::passthru");
 
     test->add(BOOST_TEST_CASE(&test_passthru));
+    test->add(BOOST_TEST_CASE(&test_passthru_copies));
+    test->add(BOOST_TEST_CASE(&test_passthru_move_only));
 
     return test;
 }
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// prepare.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using p0_ = proto::literal<proto::param<0>>;
+using p1_ = proto::literal<proto::param<1>>;
+using mul_ = proto::expr<proto::multiplies(int_, p1_)>;
+
+void test_prepare()
+{
+    // param0 + 42 * param1
+    proto::expr<proto::plus(p0_, mul_)> e{proto::plus(), p0_{}, mul_{proto::multiplies(), int_{42}, p1_{}}};
+    auto fun = proto::prepare(e);
+    static_assert(decltype(fun)::arity == 2, "two parameter slots");
+    static_assert(sizeof(fun) == sizeof(int), "only 42 should take up space");
+    BOOST_CHECK_EQUAL(fun(8, 2), 92);
+    BOOST_CHECK_EQUAL(fun(0.5, 1), 42.5);
+
+    // The arguments are bound by reference
+    int i = 1;
+    proto::expr<proto::plus_assign(p0_, int_)> inc{proto::plus_assign(), p0_{}, int_{5}};
+    proto::prepare(inc)(i);
+    BOOST_CHECK_EQUAL(i, 6);
+
+    // The prepared expression owns its terminals
+    std::string hello("hello ");
+    auto greet = proto::prepare(
+        proto::expr<proto::plus(proto::expr<proto::terminal(std::string &)>, p0_)>{
+            proto::plus(), proto::expr<proto::terminal(std::string &)>{hello}, p0_{}
+        }
+    );
+    hello = "goodbye ";
+    BOOST_CHECK_EQUAL(greet(std::string("world")), "hello world");
+}
+
+void test_nary()
+{
+    using sum_ = proto::expr<proto::plus(p0_...)>;
+    sum_ s{proto::plus()};
+    for(int n = 0; n < 3; ++n)
+        proto::children_of(s).push_back(p0_{});
+    auto triple = proto::prepare(s);
+    static_assert(decltype(triple)::arity == 1, "one parameter slot");
+    BOOST_CHECK_EQUAL(triple(14), 42);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test prepared expressions");
+
+    test->add(BOOST_TEST_CASE(&test_prepare));
+    test->add(BOOST_TEST_CASE(&test_nary));
+
+    return test;
+}
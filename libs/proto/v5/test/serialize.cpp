@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// serialize.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using double_ = proto::literal<double>;
+using string_ = proto::literal<std::string>;
+using ints_ = proto::literal<std::vector<int>>;
+
+using strings_ = proto::literal<std::vector<std::string>>;
+
+// colors[i] == "blue" || weight > 0.5
+using color_eq_ = proto::expr<proto::equal_to(proto::expr<proto::subscript(strings_, int_)>, string_)>;
+using heavy_ = proto::expr<proto::greater(double_, double_)>;
+using query_ = proto::expr<proto::logical_or(color_eq_, heavy_)>;
+
+query_ make_query(int i, double weight)
+{
+    return query_{
+        proto::logical_or()
+      , color_eq_{
+            proto::equal_to()
+          , proto::expr<proto::subscript(strings_, int_)>{
+                proto::subscript()
+              , strings_{std::vector<std::string>{"red", "green", "blue"}}
+              , int_{i}
+            }
+          , string_{std::string("blue")}
+        }
+      , heavy_{proto::greater(), double_{weight}, double_{0.5}}
+    };
+}
+
+void test_round_trip()
+{
+    std::vector<char> buffer;
+    proto::serialize(make_query(2, 0.25), buffer);
+    query_ e = proto::deserialize<query_>(buffer.data(), buffer.size());
+    BOOST_CHECK_EQUAL(proto::value(proto::right(proto::left(e))), "blue");
+    BOOST_CHECK_EQUAL(proto::value(proto::left(proto::left(proto::left(e))))[1], "green");
+    BOOST_CHECK_EQUAL(proto::value(proto::left(proto::right(e))), 0.25);
+    BOOST_CHECK(proto::_eval()(e));
+
+    std::vector<char> again;
+    proto::serialize(e, again);
+    BOOST_CHECK(buffer == again);
+
+    // Expressions can follow one another in the same buffer
+    std::vector<char> two;
+    proto::serialize(make_query(0, 0.25), two);
+    proto::serialize(make_query(1, 0.75), two);
+    proto::binary_reader in(two.data(), two.size());
+    BOOST_CHECK(!proto::_eval()(proto::deserialize<query_>(in)));
+    BOOST_CHECK(proto::_eval()(proto::deserialize<query_>(in)));
+    BOOST_CHECK_EQUAL(in.remaining(), 0u);
+}
+
+void test_nary()
+{
+    using sum_ = proto::expr<proto::plus(int_...)>;
+    sum_ s {proto::plus()};
+    for(int i = 1; i <= 100; ++i)
+        proto::children_of(s).push_back(int_{i});
+
+    std::vector<char> buffer;
+    proto::serialize(s, buffer);
+    sum_ t = proto::deserialize<sum_>(buffer.data(), buffer.size());
+    BOOST_CHECK_EQUAL(proto::children_of(t).size(), 100u);
+    BOOST_CHECK_EQUAL(proto::_eval()(t), 5050);
+}
+
+void test_zero_copy()
+{
+    using plus_ = proto::expr<proto::plus(double_, double_)>;
+    using view_ = proto::expr<proto::plus(proto::literal<double const &>, proto::literal<double const &>)>;
+
+    std::vector<char> buffer;
+    proto::serialize(plus_{proto::plus(), double_{1.5}, double_{2.25}}, buffer);
+
+    // Stands in for a memory-mapped file
+    std::vector<double> mapped(buffer.size() / sizeof(double) + 1);
+    std::memcpy(mapped.data(), buffer.data(), buffer.size());
+    char const *data = reinterpret_cast<char const *>(mapped.data());
+
+    view_ v = proto::deserialize<view_>(data, buffer.size());
+    BOOST_CHECK_EQUAL(proto::_eval()(v), 3.75);
+    char const *p = reinterpret_cast<char const *>(&proto::value(proto::left(v)));
+    BOOST_CHECK(p > data && p < data + buffer.size());
+
+    // Misaligned data can't be viewed in place ...
+    std::vector<double> shifted(mapped.size() + 1);
+    char *odd = reinterpret_cast<char *>(shifted.data()) + 1;
+    std::memcpy(odd, buffer.data(), buffer.size());
+    BOOST_CHECK_THROW(proto::deserialize<view_>(odd, buffer.size()), proto::deserialize_error);
+
+    // ... but can still be copied out
+    plus_ e = proto::deserialize<plus_>(odd, buffer.size());
+    BOOST_CHECK_EQUAL(proto::_eval()(e), 3.75);
+}
+
+void test_errors()
+{
+    std::vector<char> buffer;
+    proto::serialize(proto::expr<proto::minus(int_, int_)>{proto::minus(), int_{1}, int_{2}}, buffer);
+
+    using plus_ = proto::expr<proto::plus(int_, int_)>;
+    using sum_ = proto::expr<proto::minus(int_...)>;
+    using neg_ = proto::expr<proto::minus(int_)>;
+    BOOST_CHECK_THROW(proto::deserialize<plus_>(buffer.data(), buffer.size()), proto::deserialize_error);
+    BOOST_CHECK_THROW(proto::deserialize<neg_>(buffer.data(), buffer.size()), proto::deserialize_error);
+    BOOST_CHECK_THROW(proto::deserialize<int_>(buffer.data(), buffer.size()), proto::deserialize_error);
+    BOOST_CHECK_THROW(proto::deserialize<sum_>(buffer.data(), buffer.size() - 1), proto::deserialize_error);
+    BOOST_CHECK_EQUAL(proto::children_of(proto::deserialize<sum_>(buffer.data(), buffer.size())).size(), 2u);
+
+    buffer.push_back('\0');
+    BOOST_CHECK_THROW(proto::deserialize<sum_>(buffer.data(), buffer.size()), proto::deserialize_error);
+}
+
+// Overwrites the size that follows a terminal's (padded) tag byte
+void corrupt_size(std::vector<char> &buffer, std::uint64_t size)
+{
+    std::memcpy(buffer.data() + sizeof(std::uint64_t), &size, sizeof(size));
+}
+
+void test_corrupt_sizes()
+{
+    std::vector<char> buffer;
+    proto::serialize(ints_{std::vector<int>{1, 2, 3}}, buffer);
+    corrupt_size(buffer, std::uint64_t(1) << 40);
+    BOOST_CHECK_THROW(proto::deserialize<ints_>(buffer.data(), buffer.size()), proto::deserialize_error);
+
+    // A size whose byte count overflows
+    using u32string_ = proto::literal<std::u32string>;
+    buffer.clear();
+    proto::serialize(u32string_{std::u32string(U"abc")}, buffer);
+    corrupt_size(buffer, (std::uint64_t(1) << 62) + 1);
+    BOOST_CHECK_THROW(proto::deserialize<u32string_>(buffer.data(), buffer.size()), proto::deserialize_error);
+
+    // A truncated string
+    buffer.clear();
+    proto::serialize(string_{std::string("widget")}, buffer);
+    BOOST_CHECK_THROW(proto::deserialize<string_>(buffer.data(), buffer.size() - 1), proto::deserialize_error);
+
+    // Too many children for the data
+    using sum_ = proto::expr<proto::plus(int_...)>;
+    buffer.clear();
+    proto::serialize(sum_{proto::plus(), {int_{1}}}, buffer);
+    std::uint32_t const arity = 0xFFFFFFFF;
+    std::memcpy(buffer.data() + 1, &arity, sizeof(arity));
+    BOOST_CHECK_THROW(proto::deserialize<sum_>(buffer.data(), buffer.size()), proto::deserialize_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// A user-defined tag and terminal type
+struct point
+{
+    std::string name;
+    int x, y;
+};
+
+struct move_to_fn
+{
+    point operator()(point const &p) const
+    {
+        return p;
+    }
+};
+
+struct move_to
+  : proto::tags::expr_tag<move_to, proto::tags::unary, move_to_fn>
+{};
+
+namespace boost { namespace proto { inline namespace v5
+{
+    template<>
+    struct tag_id<move_to>
+      : std::integral_constant<unsigned char, 64>
+    {};
+
+    template<>
+    struct serialization<point>
+    {
+        static void save(binary_writer &out, point const &p)
+        {
+            serialization<std::string>::save(out, p.name);
+            serialization<int>::save(out, p.x);
+            serialization<int>::save(out, p.y);
+        }
+
+        static point load(binary_reader &in)
+        {
+            point p;
+            p.name = serialization<std::string>::load(in);
+            p.x = serialization<int>::load(in);
+            p.y = serialization<int>::load(in);
+            return p;
+        }
+    };
+}}}
+
+void test_user_defined()
+{
+    using point_ = proto::literal<point>;
+    using move_ = proto::expr<move_to(point_)>;
+
+    std::vector<char> buffer;
+    proto::serialize(move_{move_to(), point_{point{"origin", 3, 4}}}, buffer);
+    move_ m = proto::deserialize<move_>(buffer.data(), buffer.size());
+    BOOST_CHECK_EQUAL(proto::value(proto::child<0>(m)).name, "origin");
+    BOOST_CHECK_EQUAL(proto::value(proto::child<0>(m)).y, 4);
+    BOOST_CHECK_EQUAL(static_cast<unsigned char>(buffer[0]), 64u);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test binary serialization of expressions");
+
+    test->add(BOOST_TEST_CASE(&test_round_trip));
+    test->add(BOOST_TEST_CASE(&test_nary));
+    test->add(BOOST_TEST_CASE(&test_zero_copy));
+    test->add(BOOST_TEST_CASE(&test_errors));
+    test->add(BOOST_TEST_CASE(&test_corrupt_sizes));
+    test->add(BOOST_TEST_CASE(&test_user_defined));
+
+    return test;
+}
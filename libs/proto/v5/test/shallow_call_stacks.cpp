@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// shallow_call_stacks.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_PROTO_SHALLOW_CALL_STACKS
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+struct MinusToPlus
+  : proto::def<
+        proto::match(
+            proto::case_(
+                proto::minus(MinusToPlus, MinusToPlus)
+              , proto::plus(MinusToPlus(proto::_left), MinusToPlus(proto::_right))
+            )
+          , proto::case_(
+                _(MinusToPlus...)
+              , proto::passthru
+            )
+          , proto::case_(
+                proto::terminal(_)
+              , proto::passthru
+            )
+        )
+    >
+{};
+
+struct DoubleInts
+  : proto::def<
+        proto::match(
+            proto::case_( proto::terminal(int),
+                proto::functional::cxx::multiplies(proto::_value, proto::_int<2>)
+            )
+          , proto::case_( proto::terminal(_),
+                proto::_value
+            )
+          , proto::default_(
+                proto::eval_with(DoubleInts)
+            )
+        )
+    >
+{};
+
+struct counter
+{
+    int count;
+    bool operator()() { ++count; return true; }
+};
+
+void test_shallow_eval()
+{
+    proto::literal<int> i {1};
+    proto::literal<double> d {2.5};
+    BOOST_CHECK_EQUAL(proto::_shallow_eval()((i + d) * i - 4 / d), (1 + 2.5) * 1 - 4 / 2.5);
+    BOOST_CHECK_EQUAL(proto::_shallow_eval()(-i), -1);
+    BOOST_CHECK_EQUAL(proto::_shallow_eval()(proto::make_expr<proto::if_else_>(i < d, i, d)), 1);
+    BOOST_CHECK_EQUAL(proto::_shallow_eval()(i), 1);
+
+    // short-circuit evaluation is respected
+    counter c = {0};
+    proto::literal<counter &> f {c};
+    BOOST_CHECK(proto::_shallow_eval()(i == 2 && f()) == false);
+    BOOST_CHECK(proto::_shallow_eval()(i == 1 || f()) == true);
+    BOOST_CHECK_EQUAL(c.count, 0);
+    BOOST_CHECK(proto::_shallow_eval()(i == 1 && f()) == true);
+    BOOST_CHECK_EQUAL(c.count, 1);
+
+    // It can be used wherever an action can, alongside _eval
+    using eval_ = proto::def<proto::match(proto::case_(_, proto::_shallow_eval))>;
+    BOOST_CHECK_EQUAL(eval_()(i + d), proto::_eval()(i + d));
+}
+
+void test_shallow_eval_with()
+{
+    proto::literal<int> i {1};
+    proto::literal<double> d {2.5};
+    BOOST_CHECK_EQUAL(DoubleInts()(i + d * i), 2 + 2.5 * 2);
+}
+
+void test_shallow_passthru()
+{
+    using namespace proto::literals;
+    auto x = - (1_et - 2);
+    proto::expr<
+        proto::negate(
+            proto::plus(
+                proto::terminal(unsigned long long)
+              , proto::terminal(int)
+            )
+        )
+    > y = MinusToPlus()(x);
+    BOOST_CHECK_EQUAL(proto::_shallow_eval()(proto::child<0>(y)), 3u);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test BOOST_PROTO_SHALLOW_CALL_STACKS");
+
+    test->add(BOOST_TEST_CASE(&test_shallow_eval));
+    test->add(BOOST_TEST_CASE(&test_shallow_eval_with));
+    test->add(BOOST_TEST_CASE(&test_shallow_passthru));
+
+    return test;
+}
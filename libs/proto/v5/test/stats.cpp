@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// stats.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <sstream>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+void test_stats_terminal()
+{
+    proto::literal<int> i {42};
+    using stats = decltype(proto::stats(i));
+    static_assert(stats::node_count == 1, "");
+    static_assert(stats::max_depth == 1, "");
+    static_assert(stats::terminals_by_value == 1, "");
+    static_assert(stats::terminals_by_ref == 0, "");
+    static_assert(stats::terminal_value_bytes == sizeof(int), "");
+    static_assert(stats::size == sizeof(i), "");
+    static_assert(stats::tag_count<proto::tags::terminal>() == 1, "");
+    static_assert(stats::tag_count<proto::tags::plus>() == 0, "");
+}
+
+void test_stats_tree()
+{
+    int j = 0;
+    proto::literal<int> i {42};
+    proto::literal<int &> r {j};
+    auto e = i + r * i;
+    using stats = proto::result_of::stats<decltype(e)>;
+    static_assert(stats::node_count == 5, "");
+    static_assert(stats::max_depth == 3, "");
+    static_assert(stats::terminals_by_value == 2, "");
+    static_assert(stats::terminals_by_ref == 1, "");
+    static_assert(stats::terminal_value_bytes == 2 * sizeof(int), "");
+    static_assert(stats::tag_count<proto::tags::terminal>() == 3, "");
+    static_assert(stats::tag_count<proto::tags::plus>() == 1, "");
+    static_assert(stats::tag_count<proto::tags::multiplies>() == 1, "");
+
+    auto c = proto::deep_copy(e);
+    using copy_stats = decltype(proto::_stats()(c));
+    static_assert(copy_stats::node_count == 5, "");
+    static_assert(copy_stats::terminals_by_value == 3, "");
+    static_assert(copy_stats::terminals_by_ref == 0, "");
+    static_assert(copy_stats::terminal_value_bytes == 3 * sizeof(int), "");
+
+    std::stringstream sout;
+    sout << proto::stats(e);
+    BOOST_CHECK_EQUAL(
+        sout.str()
+      , "nodes: 5\n"
+        "max depth: 3\n"
+        "terminals by value: 2\n"
+        "terminals by reference: 1\n"
+        "terminal value bytes: " + std::to_string(2 * sizeof(int)) + "\n"
+        "sizeof: " + std::to_string(sizeof(e)) + "\n"
+        "tags:\n"
+        "  proto::tags::plus: 1\n"
+        "  proto::tags::terminal: 3\n"
+        "  proto::tags::multiplies: 1\n"
+    );
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("testing the stats action");
+
+    test->add(BOOST_TEST_CASE(&test_stats_terminal));
+    test->add(BOOST_TEST_CASE(&test_stats_tree));
+
+    return test;
+}
@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// switch_on.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+enum class opcode { add = 2, sub, mul = 6 };
+
+template<opcode Op>
+using label = std::integral_constant<opcode, Op>;
+
+using op_ = proto::literal<opcode>;
+using int_ = proto::literal<int>;
+using instr_ = proto::expr<proto::function(op_, int_, int_)>;
+
+struct _opcode
+  : proto::basic_action<_opcode>
+{
+    template<typename E>
+    opcode operator()(E const &e) const
+    {
+        return proto::value(proto::child<0>(e));
+    }
+};
+
+struct _add
+  : proto::basic_action<_add>
+{
+    template<typename E>
+    int operator()(E const &e) const
+    {
+        return proto::value(proto::child<1>(e)) + proto::value(proto::child<2>(e));
+    }
+};
+
+struct _sub
+  : proto::basic_action<_sub>
+{
+    template<typename E>
+    int operator()(E const &e) const
+    {
+        return proto::value(proto::child<1>(e)) - proto::value(proto::child<2>(e));
+    }
+};
+
+struct _mul
+  : proto::basic_action<_mul>
+{
+    template<typename E>
+    long operator()(E const &e) const
+    {
+        return proto::value(proto::child<1>(e)) * proto::value(proto::child<2>(e));
+    }
+};
+
+struct Exec
+  : proto::def<
+        proto::switch_on(
+            _opcode
+          , proto::case_(label<opcode::add>, _add)
+          , proto::case_(label<opcode::sub>, _sub)
+          , proto::case_(label<opcode::mul>, _mul)
+          , proto::default_(proto::_int<-1>)
+        )
+    >
+{};
+
+struct ExecNoDefault
+  : proto::def<
+        proto::switch_on(
+            _opcode
+          , proto::case_(label<opcode::mul>, _mul)
+          , proto::case_(label<opcode::add>, _add)
+        )
+    >
+{};
+
+// Dispatches on a plain int held by a terminal
+struct Parity
+  : proto::def<
+        proto::switch_on(
+            proto::_value
+          , proto::case_(std::integral_constant<int, 0>, proto::_int<10>)
+          , proto::case_(std::integral_constant<int, -1>, proto::_int<11>)
+          , proto::default_(proto::_value)
+        )
+    >
+{};
+
+// Labels spread over a switch statement of 64, and of 1024 values
+template<int Label>
+using int_label = std::integral_constant<int, Label>;
+
+struct Narrow
+  : proto::def<
+        proto::switch_on(
+            proto::_value
+          , proto::case_(int_label<0>, proto::_int<0>)
+          , proto::case_(int_label<17>, proto::_int<1>)
+          , proto::case_(int_label<40>, proto::_int<2>)
+        )
+    >
+{};
+
+struct Wide
+  : proto::def<
+        proto::switch_on(
+            proto::_value
+          , proto::case_(int_label<-500>, proto::_int<0>)
+          , proto::case_(int_label<3>, proto::_int<1>)
+          , proto::case_(int_label<500>, proto::_int<2>)
+          , proto::default_(proto::_int<-1>)
+        )
+    >
+{};
+
+instr_ make_instr(int op, int left, int right)
+{
+    return instr_{proto::function(), op_{static_cast<opcode>(op)}, int_{left}, int_{right}};
+}
+
+void test_switch_on()
+{
+    BOOST_CHECK_EQUAL(Exec()(make_instr(2, 7, 3)), 10);
+    BOOST_CHECK_EQUAL(Exec()(make_instr(3, 7, 3)), 4);
+    BOOST_CHECK_EQUAL(Exec()(make_instr(6, 7, 3)), 21);
+    static_assert(std::is_same<decltype(Exec()(make_instr(2, 7, 3))), long>::value, "");
+
+    // Holes in the table, and values outside of it
+    BOOST_CHECK_EQUAL(Exec()(make_instr(4, 7, 3)), -1);
+    BOOST_CHECK_EQUAL(Exec()(make_instr(5, 7, 3)), -1);
+    BOOST_CHECK_EQUAL(Exec()(make_instr(0, 7, 3)), -1);
+    BOOST_CHECK_EQUAL(Exec()(make_instr(1000, 7, 3)), -1);
+    BOOST_CHECK_EQUAL(Exec()(make_instr(-1000, 7, 3)), -1);
+}
+
+void test_no_default()
+{
+    BOOST_CHECK_EQUAL(ExecNoDefault()(make_instr(2, 7, 3)), 10);
+    BOOST_CHECK_EQUAL(ExecNoDefault()(make_instr(6, 7, 3)), 21);
+    BOOST_CHECK_EQUAL(ExecNoDefault()(make_instr(3, 7, 3)), 0);
+    BOOST_CHECK_EQUAL(ExecNoDefault()(make_instr(7, 7, 3)), 0);
+}
+
+void test_negative_labels()
+{
+    BOOST_CHECK_EQUAL(Parity()(int_{0}), 10);
+    BOOST_CHECK_EQUAL(Parity()(int_{-1}), 11);
+    BOOST_CHECK_EQUAL(Parity()(int_{1}), 1);
+    BOOST_CHECK_EQUAL(Parity()(int_{-2}), -2);
+}
+
+void test_wide_labels()
+{
+    BOOST_CHECK_EQUAL(Narrow()(int_{0}), 0);
+    BOOST_CHECK_EQUAL(Narrow()(int_{17}), 1);
+    BOOST_CHECK_EQUAL(Narrow()(int_{40}), 2);
+    BOOST_CHECK_EQUAL(Narrow()(int_{41}), 0);
+    BOOST_CHECK_EQUAL(Narrow()(int_{63}), 0);
+    BOOST_CHECK_EQUAL(Narrow()(int_{64}), 0);
+
+    BOOST_CHECK_EQUAL(Wide()(int_{-500}), 0);
+    BOOST_CHECK_EQUAL(Wide()(int_{3}), 1);
+    BOOST_CHECK_EQUAL(Wide()(int_{500}), 2);
+    BOOST_CHECK_EQUAL(Wide()(int_{4}), -1);
+    BOOST_CHECK_EQUAL(Wide()(int_{501}), -1);
+    BOOST_CHECK_EQUAL(Wide()(int_{523}), -1);
+    BOOST_CHECK_EQUAL(Wide()(int_{-501}), -1);
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test switch_on, which dispatches on runtime values");
+
+    test->add(BOOST_TEST_CASE(&test_switch_on));
+    test->add(BOOST_TEST_CASE(&test_no_default));
+    test->add(BOOST_TEST_CASE(&test_negative_labels));
+    test->add(BOOST_TEST_CASE(&test_wide_labels));
+
+    return test;
+}
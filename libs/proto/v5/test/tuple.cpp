@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// tuple.cpp
+//
+//  Copyright 2013 Eric Niebler. Distributed under the Boost
+//  Software License, Version 1.0. (See accompanying file
+//  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <boost/proto/v5/proto.hpp>
+#include "./unit_test.hpp"
+
+namespace proto = boost::proto;
+using proto::_;
+
+using int_ = proto::literal<int>;
+using double_ = proto::literal<double>;
+using plus_ = proto::expr<proto::plus(int_, double_)>;
+using if_ = proto::expr<proto::if_else_(proto::literal<bool>, plus_, int_)>;
+
+void test_tuple_traits()
+{
+    static_assert(std::tuple_size<plus_>::value == 2, "");
+    static_assert(std::tuple_size<plus_ const>::value == 2, "");
+    static_assert(std::tuple_size<if_>::value == 3, "");
+    static_assert(std::tuple_size<int_>::value == 1, "");
+    static_assert(std::is_same<double_, std::tuple_element<1, plus_>::type>::value, "");
+    static_assert(std::is_same<double_ const, std::tuple_element<1, plus_ const>::type>::value, "");
+    static_assert(std::is_same<int, std::tuple_element<0, int_>::type>::value, "");
+    static_assert(std::is_same<plus_, std::tuple_element<1, if_>::type>::value, "");
+
+    using ref_ = proto::expr<proto::minus(int_ &, int_)>;
+    static_assert(std::is_same<int_ &, std::tuple_element<0, ref_>::type>::value, "");
+
+    using children_ = proto::exprs::children<int_, double_>;
+    static_assert(std::tuple_size<children_>::value == 2, "");
+    static_assert(std::is_same<double_, std::tuple_element<1, children_>::type>::value, "");
+}
+
+void test_get()
+{
+    plus_ p {proto::plus(), int_{1}, double_{2.5}};
+    static_assert(std::is_same<int_ &, decltype(proto::get<0>(p))>::value, "");
+    static_assert(std::is_same<double_ const &, decltype(proto::get<1>(static_cast<plus_ const &>(p)))>::value, "");
+    static_assert(std::is_same<double_ &&, decltype(proto::get<1>(std::move(p)))>::value, "");
+    BOOST_CHECK_EQUAL(proto::value(proto::get<0>(p)), 1);
+
+    // get is found by ADL
+    using std::get;
+    BOOST_CHECK_EQUAL(proto::value(get<1>(p)), 2.5);
+    BOOST_CHECK_EQUAL(get<0>(proto::get<0>(p)), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// An algorithm over an index sequence, no Fusion required
+struct eval_children
+{
+    template<typename Expr, std::size_t ...I>
+    static auto call(Expr const &e, proto::utility::indices<I...>)
+    BOOST_PROTO_AUTO_RETURN(
+        std::make_tuple(proto::_eval()(proto::get<I>(e))...)
+    )
+
+    template<typename Expr>
+    static auto call(Expr const &e)
+    BOOST_PROTO_AUTO_RETURN(
+        eval_children::call(e, proto::utility::make_indices<std::tuple_size<Expr>::value>())
+    )
+};
+
+void test_index_sequence()
+{
+    if_ i {
+        proto::if_else_()
+      , proto::literal<bool>{true}
+      , plus_{proto::plus(), int_{1}, double_{2.5}}
+      , int_{4}
+    };
+    auto t = eval_children::call(i);
+    BOOST_CHECK(std::get<0>(t));
+    BOOST_CHECK_EQUAL(std::get<1>(t), 3.5);
+    BOOST_CHECK_EQUAL(std::get<2>(t), 4);
+}
+
+void test_structured_bindings()
+{
+#if __cplusplus >= 201703L
+    plus_ p {proto::plus(), int_{1}, double_{2.5}};
+    auto &[l, r] = p;
+    proto::value(l) = 42;
+    BOOST_CHECK_EQUAL(proto::value(proto::left(p)), 42);
+    BOOST_CHECK_EQUAL(proto::value(r), 2.5);
+
+    auto [v] = int_{7};
+    BOOST_CHECK_EQUAL(v, 7);
+#endif
+}
+
+using namespace boost::unit_test;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// init_unit_test_suite
+//
+test_suite* init_unit_test_suite( int argc, char* argv[] )
+{
+    test_suite *test = BOOST_TEST_SUITE("test the tuple protocol for expressions");
+
+    test->add(BOOST_TEST_CASE(&test_tuple_traits));
+    test->add(BOOST_TEST_CASE(&test_get));
+    test->add(BOOST_TEST_CASE(&test_index_sequence));
+    test->add(BOOST_TEST_CASE(&test_structured_bindings));
+
+    return test;
+}